@@ -0,0 +1,102 @@
+#include "cutils/array_list.h"
+#include "cutils/errors.h"
+#include "cutils/thread_pool.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ROUNDS 2000
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Exits on failure; the benchmarks are built without asserts in Release.
+void check(cutils_error_t err, const char *what) {
+  if (err != CUTILS_SUCCESS) {
+    fprintf(stderr, "%s: %s\n", what, cutils_error_message(err));
+    exit(EXIT_FAILURE);
+  }
+}
+
+// CPU-bound per-element work: iterate a 64-bit mixing function
+uint64_t work(uint64_t x) {
+  for (size_t i = 0; i < ROUNDS; i++) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+  }
+  return x;
+}
+
+void *map_fn(void *value, void *ctx) {
+  (void)ctx;
+  return (void *)(uintptr_t)work((uintptr_t)value);
+}
+
+void *reduce_fn(void *acc, void *value, void *ctx) {
+  (void)ctx;
+  return (void *)((uintptr_t)acc ^ (uintptr_t)work((uintptr_t)value));
+}
+
+void *combine_fn(void *lhs, void *rhs, void *ctx) {
+  (void)ctx;
+  return (void *)((uintptr_t)lhs ^ (uintptr_t)rhs);
+}
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 200000;
+  size_t max_threads = argc > 2 ? strtoull(argv[2], NULL, 10) : 8;
+
+  array_list_t *l = malloc(sizeof(array_list_t));
+  cutils_error_t err = array_list_init(l, n, NULL, NULL);
+  check(err, "array_list_init");
+  for (size_t i = 0; i < n; i++) {
+    array_list_push(l, (void *)(uintptr_t)i);
+  }
+
+  printf("%zu elements, %d rounds of mixing per element\n", n, ROUNDS);
+  printf("%8s %12s %12s %12s %12s\n", "threads", "map (s)", "speedup",
+         "reduce (s)", "speedup");
+
+  double map_base = 0;
+  double reduce_base = 0;
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+    err = thread_pool_init(pool, nthreads);
+    check(err, "thread_pool_init");
+
+    array_list_t *out = malloc(sizeof(array_list_t));
+    err = array_list_init(out, n, NULL, NULL);
+    check(err, "array_list_init");
+
+    double start = now();
+    err = array_list_parallel_map(l, out, map_fn, NULL, pool);
+    check(err, "array_list_parallel_map");
+    double map_time = now() - start;
+
+    void *result = NULL;
+    start = now();
+    err = array_list_parallel_reduce(l, NULL, reduce_fn, combine_fn, NULL, true,
+                                     pool, &result);
+    check(err, "array_list_parallel_reduce");
+    double reduce_time = now() - start;
+
+    if (nthreads == 1) {
+      map_base = map_time;
+      reduce_base = reduce_time;
+    }
+    printf("%8zu %12.3f %11.2fx %12.3f %11.2fx\n", nthreads, map_time,
+           map_base / map_time, reduce_time, reduce_base / reduce_time);
+
+    array_list_free(out);
+    thread_pool_free(pool);
+  }
+
+  array_list_free(l);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+#include "cutils/array_list.h"
+#include "cutils/btree.h"
+#include "cutils/errors.h"
+#include "cutils/hashmap.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Error checks that survive NDEBUG, so Release runs never time a failed setup.
+void check(cutils_error_t err, const char *what) {
+  if (err != CUTILS_SUCCESS) {
+    fprintf(stderr, "%s: %s\n", what, cutils_error_message(err));
+    exit(EXIT_FAILURE);
+  }
+}
+
+// Multiplying by an odd constant permutes the 64-bit keys, so none repeat.
+uint64_t key_at(size_t i) { return (i + 1) * 0x9e3779b97f4a7c15ull; }
+
+uint64_t key_of(void *value) { return (uint64_t)(uintptr_t)value; }
+
+int cmp_key(void *lhs, void *rhs) {
+  uintptr_t l = (uintptr_t)lhs;
+  uintptr_t r = (uintptr_t)rhs;
+  return (l > r) - (l < r);
+}
+
+uint64_t hash_key(void *key) {
+  uint64_t x = (uintptr_t)key;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  return x;
+}
+
+bool eq_key(void *lhs, void *rhs) { return lhs == rhs; }
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+  size_t ops = n;
+
+  // Probe order is a shuffle of the stored keys
+  uint64_t *probes = malloc(sizeof(uint64_t) * ops);
+  check(probes ? CUTILS_SUCCESS : CUTILS_ALLOCATION_ERROR, "malloc");
+  for (size_t i = 0; i < ops; i++) {
+    probes[i] = key_at((i * 7919) % n);
+  }
+
+  array_list_t *sorted = malloc(sizeof(array_list_t));
+  cutils_error_t err = array_list_init(sorted, n, NULL, NULL);
+  check(err, "array_list_init");
+  for (size_t i = 0; i < n; i++) {
+    array_list_push(sorted, (void *)(uintptr_t)key_at(i));
+  }
+  double start = now();
+  array_list_sort(sorted, cmp_key);
+  double sort_time = now() - start;
+
+  btree_t *inserted = malloc(sizeof(btree_t));
+  err = btree_init(inserted, NULL);
+  check(err, "btree_init");
+  start = now();
+  for (size_t i = 0; i < n; i++) {
+    btree_insert(inserted, key_at(i), (void *)(uintptr_t)key_at(i));
+  }
+  double insert_time = now() - start;
+
+  btree_t *loaded = malloc(sizeof(btree_t));
+  err = btree_init(loaded, NULL);
+  check(err, "btree_init");
+  start = now();
+  err = btree_bulk_load(loaded, sorted, key_of);
+  double load_time = now() - start;
+  check(err, "btree_bulk_load");
+
+  hashmap_t *map = malloc(sizeof(hashmap_t));
+  err = hashmap_init(map, n, hash_key, eq_key, NULL, NULL);
+  check(err, "hashmap_init");
+  start = now();
+  for (size_t i = 0; i < n; i++) {
+    hashmap_insert(map, (void *)(uintptr_t)key_at(i),
+                   (void *)(uintptr_t)key_at(i));
+  }
+  double hash_time = now() - start;
+
+  printf("%zu keys, %zu random point lookups\n", n, ops);
+  printf("%-24s %12s %14s\n", "structure", "build (s)", "lookup (Mop/s)");
+
+  void *value = NULL;
+  size_t idx = 0;
+  uint64_t sink = 0;
+
+  start = now();
+  for (size_t i = 0; i < ops; i++) {
+    array_list_binary_search(sorted, (void *)(uintptr_t)probes[i], cmp_key,
+                             &idx);
+    sink += idx;
+  }
+  double elapsed = now() - start;
+  printf("%-24s %12.3f %14.1f\n", "sorted array_list", sort_time,
+         ops / elapsed / 1e6);
+
+  start = now();
+  for (size_t i = 0; i < ops; i++) {
+    btree_get(inserted, probes[i], &value);
+    sink += (uintptr_t)value;
+  }
+  elapsed = now() - start;
+  printf("%-24s %12.3f %14.1f\n", "btree (inserted)", insert_time,
+         ops / elapsed / 1e6);
+
+  start = now();
+  for (size_t i = 0; i < ops; i++) {
+    btree_get(loaded, probes[i], &value);
+    sink += (uintptr_t)value;
+  }
+  elapsed = now() - start;
+  printf("%-24s %12.3f %14.1f\n", "btree (bulk loaded)", load_time,
+         ops / elapsed / 1e6);
+
+  start = now();
+  for (size_t i = 0; i < ops; i++) {
+    hashmap_get(map, (void *)(uintptr_t)probes[i], &value);
+    sink += (uintptr_t)value;
+  }
+  elapsed = now() - start;
+  printf("%-24s %12.3f %14.1f\n", "hashmap", hash_time, ops / elapsed / 1e6);
+
+  // Ordered scan along the leaf chain
+  btree_iter_t it;
+  start = now();
+  for (btree_seek(loaded, 0, &it); btree_iter_valid(&it);
+       btree_iter_next(&it)) {
+    sink += it.leaf->node.keys[it.idx];
+  }
+  elapsed = now() - start;
+  printf("%-24s %12s %14.1f\n", "btree full scan", "-", n / elapsed / 1e6);
+
+  printf("(checksum %llu)\n", (unsigned long long)sink);
+
+  hashmap_free(map);
+  btree_free(loaded);
+  btree_free(inserted);
+  array_list_free(sorted);
+  free(probes);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+#include "cutils/concurrent_queue.h"
+#include "cutils/concurrent_stack.h"
+#include "cutils/errors.h"
+#include "cutils/linked_list.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Exits on a failed call; unlike assert this still runs under NDEBUG.
+void check(cutils_error_t err, const char *what) {
+  if (err != CUTILS_SUCCESS) {
+    fprintf(stderr, "%s: %s\n", what, cutils_error_message(err));
+    exit(EXIT_FAILURE);
+  }
+}
+
+typedef enum { STACK, QUEUE, LOCKED } kind_t;
+
+typedef struct {
+  kind_t kind;
+  concurrent_stack_t *stack;
+  concurrent_queue_t *queue;
+  linked_list_t *list;
+  pthread_mutex_t *lock;
+  size_t ops;
+} shared_t;
+
+// Each thread pushes then pops `ops` times against the shared container.
+void *run(void *arg) {
+  shared_t *s = arg;
+  void *value = NULL;
+  for (size_t i = 0; i < s->ops; i++) {
+    switch (s->kind) {
+    case STACK:
+      concurrent_stack_push(s->stack, (void *)(uintptr_t)i);
+      concurrent_stack_pop(s->stack, &value);
+      break;
+    case QUEUE:
+      concurrent_queue_enqueue(s->queue, (void *)(uintptr_t)i);
+      concurrent_queue_dequeue(s->queue, &value);
+      break;
+    case LOCKED:
+      pthread_mutex_lock(s->lock);
+      linked_list_push_back(s->list, (void *)(uintptr_t)i);
+      pthread_mutex_unlock(s->lock);
+      pthread_mutex_lock(s->lock);
+      linked_list_pop_front(s->list, &value);
+      pthread_mutex_unlock(s->lock);
+      break;
+    }
+  }
+  return NULL;
+}
+
+double measure(shared_t *s, size_t nthreads) {
+  pthread_t *threads = malloc(sizeof(pthread_t) * nthreads);
+  check(threads ? CUTILS_SUCCESS : CUTILS_ALLOCATION_ERROR, "malloc");
+
+  double start = now();
+  for (size_t i = 0; i < nthreads; i++) {
+    pthread_create(&threads[i], NULL, run, s);
+  }
+  for (size_t i = 0; i < nthreads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  double elapsed = now() - start;
+
+  free(threads);
+  return elapsed;
+}
+
+int main(int argc, char **argv) {
+  size_t ops = argc > 1 ? strtoull(argv[1], NULL, 10) : 2000000;
+
+  printf("%zu push/pop pairs split across threads\n", ops);
+  printf("%8s %16s %16s %16s\n", "threads", "treiber (Mop/s)",
+         "ms queue (Mop/s)", "mutex (Mop/s)");
+
+  size_t counts[] = {1, 2, 4, 8};
+  for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+    size_t nthreads = counts[i];
+
+    concurrent_stack_t *stack = malloc(sizeof(concurrent_stack_t));
+    concurrent_queue_t *queue = malloc(sizeof(concurrent_queue_t));
+    linked_list_t *list = malloc(sizeof(linked_list_t));
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    cutils_error_t err = concurrent_stack_init(stack, NULL, NULL);
+    check(err, "concurrent_stack_init");
+    err = concurrent_queue_init(queue, NULL, NULL);
+    check(err, "concurrent_queue_init");
+    err = linked_list_init_pooled(list, NULL, NULL, NULL);
+    check(err, "linked_list_init_pooled");
+
+    shared_t s = {STACK, stack, queue, list, &lock, ops / nthreads};
+    double stack_time = measure(&s, nthreads);
+    s.kind = QUEUE;
+    double queue_time = measure(&s, nthreads);
+    s.kind = LOCKED;
+    double locked_time = measure(&s, nthreads);
+
+    size_t total = s.ops * nthreads;
+    printf("%8zu %16.1f %16.1f %16.1f\n", nthreads, total / stack_time / 1e6,
+           total / queue_time / 1e6, total / locked_time / 1e6);
+
+    concurrent_stack_free(stack);
+    concurrent_queue_free(queue);
+    linked_list_free(list);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,509 @@
+#include "cutils/errors.h"
+#include "cutils/json.h"
+#include "cutils/thread_pool.h"
+#include <assert.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Parse failures would make the timings meaningless, NDEBUG or not.
+void check(cutils_error_t err, const char *what) {
+  if (err != CUTILS_SUCCESS) {
+    fprintf(stderr, "%s: %s\n", what, cutils_error_message(err));
+    exit(EXIT_FAILURE);
+  }
+}
+
+uint64_t next_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+// An array of `n` user records, roughly 300 bytes each.
+char *generate(size_t n, size_t *length) {
+  size_t capacity = n * 512 + 16;
+  char *text = malloc(capacity);
+  assert(text != NULL);
+
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  size_t pos = 0;
+  text[pos++] = '[';
+  for (size_t i = 0; i < n; i++) {
+    double score = (double)(next_random(&state) % 1000000) / 997.0;
+    double lat = (double)(next_random(&state) % 180000000) / 1e6 - 90.0;
+    pos += snprintf(
+        &text[pos], capacity - pos,
+        "%s{\"id\":%zu,\"name\":\"user_%zu\",\"email\":\"user%zu@example.com\","
+        "\"active\":%s,\"score\":%.17g,\"tags\":[\"alpha\",\"beta\","
+        "\"gamma\"],\"address\":{\"city\":\"Springfield\",\"zip\":\"%05zu\","
+        "\"lat\":%.17g},\"bio\":\"Likes \\\"quotes\\\",\\ttabs and\\n"
+        "newlines.\",\"parent\":null}",
+        i > 0 ? "," : "", i, i, i, i % 3 ? "true" : "false", score,
+        i % 100000, lat);
+  }
+  text[pos++] = ']';
+  text[pos] = '\0';
+
+  *length = pos;
+  return text;
+}
+
+// Adds every number and string length, keys included, to `sum` node by node.
+void walk_tree(json_value_t *v, double *sum) {
+  switch (v->type) {
+  case JSON_NUMBER:
+    *sum += v->value.number;
+    break;
+  case JSON_STRING:
+    *sum += (double)strlen(v->value.string);
+    break;
+  case JSON_ARRAY:
+    for (size_t i = 0; i < v->value.array->length; i++) {
+      walk_tree(v->value.array->backing[i], sum);
+    }
+    break;
+  case JSON_OBJECT:
+    for (size_t i = 0; i < v->value.object->length; i++) {
+      json_member_t *m = &v->value.object->members[i];
+      *sum += (double)strlen(m->key);
+      walk_tree(m->value, sum);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+// The same sum over the tape in one forward pass.
+double walk_tape(json_tape_t *t) {
+  double sum = 0;
+  for (size_t i = 0; i < t->length; i++) {
+    double number;
+    size_t length;
+    const char *string;
+    switch (JSON_TAPE_TAG(t->words[i])) {
+    case 'd':
+      json_tape_get_number(t, i++, &number);
+      sum += number;
+      break;
+    case '"':
+      json_tape_get_string(t, i, &string, &length);
+      sum += (double)length;
+      break;
+    }
+  }
+  return sum;
+}
+
+typedef struct {
+  bool score; // The next number is a record's score
+  bool skip;  // Pass over the values of uninteresting keys
+  double sum;
+} extract_t;
+
+// Sums the records' scores from events.
+json_action_t extract(void *ctx, json_event_t *e) {
+  extract_t *x = ctx;
+  if (e->type == JSON_EVENT_KEY && e->depth == 2) {
+    x->score = strcmp(e->string, "score") == 0;
+    if (x->skip && !x->score && strcmp(e->string, "id") != 0) {
+      return JSON_SKIP;
+    }
+  } else if (e->type == JSON_EVENT_NUMBER && x->score) {
+    x->sum += e->number;
+    x->score = false;
+  }
+  return JSON_CONTINUE;
+}
+
+// Counts the documents of an NDJSON stream and drops them.
+json_action_t drop_line(void *ctx, json_line_t *line) {
+  check(line->err, "json_parse_lines");
+  json_value_free(line->value);
+  (*(size_t *)ctx)++;
+  return JSON_CONTINUE;
+}
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000;
+  size_t rounds = argc > 2 ? strtoull(argv[2], NULL, 10) : 5;
+
+  size_t length = 0;
+  char *text = generate(n, &length);
+
+  json_value_t *doc = NULL;
+  double start = now();
+  for (size_t r = 0; r < rounds; r++) {
+    json_value_free(doc);
+    check(json_parse(text, &doc), "json_parse");
+  }
+  double parse = now() - start;
+
+  json_buffer_t *out = malloc(sizeof(json_buffer_t));
+  json_buffer_init(out, 0);
+  double stringify[2];
+  size_t written[2];
+  for (json_format_t f = JSON_FORMAT_COMPACT; f <= JSON_FORMAT_PRETTY; f++) {
+    start = now();
+    for (size_t r = 0; r < rounds; r++) {
+      out->length = 0;
+      json_stringify(doc, f, out);
+    }
+    stringify[f] = now() - start;
+    written[f] = out->length;
+  }
+
+  printf("%zu records, %.1f MB, %zu rounds\n", n, length / 1e6, rounds);
+  printf("%20s %12s\n", "operation", "MB/s");
+  printf("%20s %12.1f\n", "json_parse", length * rounds / parse / 1e6);
+  printf("%20s %12.1f\n", "stringify compact",
+         written[0] * rounds / stringify[0] / 1e6);
+  printf("%20s %12.1f\n", "stringify pretty",
+         written[1] * rounds / stringify[1] / 1e6);
+
+  // Stage one alone, then parsing the whitespace-heavy pretty output
+  json_index_t *idx = malloc(sizeof(json_index_t));
+  json_index_init(idx, length / 4 + 64);
+  cutils_error_t (*builds[])(json_index_t *, const char *, size_t) = {
+      json_index_build, json_index_build_scalar};
+  double indexing[2];
+  for (size_t i = 0; i < 2; i++) {
+    start = now();
+    for (size_t r = 0; r < rounds; r++) {
+      builds[i](idx, text, length);
+    }
+    indexing[i] = now() - start;
+  }
+  json_index_free(idx);
+
+  start = now();
+  for (size_t r = 0; r < rounds; r++) {
+    json_value_t *pretty = NULL;
+    json_parse(out->data, &pretty);
+    json_value_free(pretty);
+  }
+  double parse_pretty = now() - start;
+
+  printf("%20s %12.1f\n", "index", length * rounds / indexing[0] / 1e6);
+  printf("%20s %12.1f\n", "index scalar", length * rounds / indexing[1] / 1e6);
+  printf("%20s %12.1f\n", "json_parse pretty",
+         written[1] * rounds / parse_pretty / 1e6);
+
+  // The same document into a reused arena
+  json_document_t *d = malloc(sizeof(json_document_t));
+  json_document_init(d, 0);
+  start = now();
+  for (size_t r = 0; r < rounds; r++) {
+    json_document_parse(d, text);
+  }
+  double parse_document = now() - start;
+  printf("%20s %12.1f\n", "document", length * rounds / parse_document / 1e6);
+
+  // Into a reused tape, then one pass over everything in each form
+  json_tape_t *t = malloc(sizeof(json_tape_t));
+  json_tape_init(t, 0);
+  start = now();
+  for (size_t r = 0; r < rounds; r++) {
+    json_tape_parse(t, text);
+  }
+  double parse_tape = now() - start;
+  printf("%20s %12.1f\n", "tape", length * rounds / parse_tape / 1e6);
+
+  double sums[2];
+  double walks[2];
+  start = now();
+  for (size_t r = 0; r < rounds; r++) {
+    sums[0] = 0;
+    walk_tree(doc, &sums[0]);
+  }
+  walks[0] = now() - start;
+  start = now();
+  for (size_t r = 0; r < rounds; r++) {
+    sums[1] = walk_tape(t);
+  }
+  walks[1] = now() - start;
+  if (sums[0] != sums[1]) {
+    fprintf(stderr, "walk sums differ: %.17g != %.17g\n", sums[0], sums[1]);
+    return EXIT_FAILURE;
+  }
+  printf("%20s %12s\n", "", "Mrecord/s");
+  printf("%20s %12.1f\n", "walk tree", n * rounds / walks[0] / 1e6);
+  printf("%20s %12.1f\n", "walk tape", n * rounds / walks[1] / 1e6);
+
+  // Pulling one field per record out with events, against a full tree
+  double extracting[3];
+  double scores[3];
+  for (size_t mode = 0; mode < 3; mode++) {
+    start = now();
+    for (size_t r = 0; r < rounds; r++) {
+      extract_t x = {.skip = mode == 2};
+      if (mode == 0) {
+        json_value_t *tree = NULL;
+        json_parse(text, &tree);
+        for (size_t i = 0; i < tree->value.array->length; i++) {
+          json_value_t *record = tree->value.array->backing[i], *score;
+          json_object_get(record->value.object, "score", &score);
+          x.sum += score->value.number;
+        }
+        json_value_free(tree);
+      } else {
+        json_parse_events(text, extract, &x);
+      }
+      scores[mode] = x.sum;
+    }
+    extracting[mode] = now() - start;
+  }
+  if (scores[0] != scores[1] || scores[1] != scores[2]) {
+    fprintf(stderr, "score sums differ: %.17g, %.17g, %.17g\n", scores[0],
+            scores[1], scores[2]);
+    return EXIT_FAILURE;
+  }
+  printf("%20s %12s\n", "", "MB/s");
+  printf("%20s %12.1f\n", "field via tree",
+         length * rounds / extracting[0] / 1e6);
+  printf("%20s %12.1f\n", "field via events",
+         length * rounds / extracting[1] / 1e6);
+  printf("%20s %12.1f\n", "events + skip",
+         length * rounds / extracting[2] / 1e6);
+  printf("%20s %12.1f\n", "(score sum)", scores[0]);
+
+  // Pushed through in network-sized chunks, as a value and as events
+  json_parser_t *pushed = malloc(sizeof(json_parser_t));
+  json_parser_init(pushed, NULL, NULL);
+  size_t chunk = 4096;
+  double pushing[2];
+  for (size_t mode = 0; mode < 2; mode++) {
+    extract_t x = {0};
+    if (mode == 1) {
+      json_parser_free(pushed);
+      pushed = malloc(sizeof(json_parser_t));
+      json_parser_init(pushed, extract, &x);
+    }
+    start = now();
+    for (size_t r = 0; r < rounds; r++) {
+      for (size_t i = 0; i < length; i += chunk) {
+        json_parser_feed(pushed, &text[i],
+                         length - i < chunk ? length - i : chunk);
+      }
+      json_parser_finish(pushed);
+      json_value_t *tree = NULL;
+      if (json_parser_take(pushed, &tree) == CUTILS_SUCCESS) {
+        json_value_free(tree);
+      }
+      json_parser_reset(pushed);
+    }
+    pushing[mode] = now() - start;
+  }
+  json_parser_free(pushed);
+  printf("%20s %12.1f\n", "push parser value",
+         length * rounds / pushing[0] / 1e6);
+  printf("%20s %12.1f\n", "push parser events",
+         length * rounds / pushing[1] / 1e6);
+
+  // Heap held per record by a parsed tree, and arena bytes per record
+  json_value_free(doc);
+  struct mallinfo2 before = mallinfo2();
+  json_parse(text, &doc);
+  struct mallinfo2 after = mallinfo2();
+  json_document_parse(d, text);
+  printf("%20s %12s\n", "", "bytes/record");
+  printf("%20s %12.1f\n", "json_parse heap",
+         (double)(after.uordblks + after.hblkhd - before.uordblks -
+                  before.hblkhd) /
+             n);
+  printf("%20s %12.1f\n", "document arena", (double)d->arena->used / n);
+  printf("%20s %12.1f\n", "tape",
+         (double)(t->length * sizeof(uint64_t) + t->strings->length) / n);
+
+  // The corpus from disk: read into the heap, then mapped in each mode
+  char path[] = "/tmp/bench_jsonXXXXXX";
+  int fd = mkstemp(path);
+  FILE *file = fd >= 0 ? fdopen(fd, "w+") : NULL;
+  check(file && fwrite(text, 1, length, file) == length && fflush(file) == 0
+            ? CUTILS_SUCCESS
+            : CUTILS_IO_ERROR,
+        path);
+  const char *loads[] = {"read + tape", "json_parse_file", "file views",
+                         "views bounded"};
+  int flags[] = {0, 0, JSON_FILE_VIEWS, JSON_FILE_VIEWS | JSON_FILE_BOUNDED};
+  double loading[4];
+  size_t strings[4];
+  for (size_t mode = 0; mode < 4; mode++) {
+    start = now();
+    for (size_t r = 0; r < rounds; r++) {
+      if (mode == 0) {
+        char *read = malloc(length);
+        check(read ? CUTILS_SUCCESS : CUTILS_ALLOCATION_ERROR, "malloc");
+        rewind(file);
+        size_t got = fread(read, 1, length, file);
+        check(got == length ? CUTILS_SUCCESS : CUTILS_IO_ERROR, path);
+        check(json_tape_parse_n(t, read, length), "json_tape_parse_n");
+        free(read);
+      } else {
+        json_file_t *f = malloc(sizeof(json_file_t));
+        check(json_parse_file(t, f, path, flags[mode]), "json_parse_file");
+        json_file_free(f);
+      }
+    }
+    loading[mode] = now() - start;
+    strings[mode] = t->strings->length;
+  }
+  fclose(file);
+  unlink(path);
+
+  printf("%20s %12s %12s\n", "", "MB/s", "strings/rec");
+  for (size_t mode = 0; mode < 4; mode++) {
+    printf("%20s %12.1f %12.1f\n", loads[mode],
+           length * rounds / loading[mode] / 1e6, (double)strings[mode] / n);
+  }
+  json_tape_free(t);
+
+  // Small messages, one at a time, cycling through a prepared set
+  size_t messages = n * 10;
+  char(*prepared)[128] = malloc(1024 * sizeof(*prepared));
+  assert(prepared != NULL);
+  size_t message_length = 0;
+  for (size_t i = 0; i < 1024; i++) {
+    message_length = (size_t)snprintf(
+        prepared[i], sizeof(prepared[i]),
+        "{\"type\":\"event\",\"id\":%zu,\"user\":{\"name\":\"u%zu\","
+        "\"roles\":[\"a\",\"b\"]},\"ok\":true,\"score\":%zu.5}",
+        i, i % 100, i % 10);
+  }
+  // The same messages back to back, as they would sit in a receive buffer
+  char *received = malloc(1024 * 128);
+  size_t offsets[1025] = {0};
+  assert(received != NULL);
+  for (size_t i = 0; i < 1024; i++) {
+    size_t len = strlen(prepared[i]);
+    memcpy(&received[offsets[i]], prepared[i], len);
+    offsets[i + 1] = offsets[i] + len;
+  }
+  char copy[128];
+  double small[4];
+  for (size_t mode = 0; mode < 4; mode++) {
+    start = now();
+    for (size_t i = 0; i < messages; i++) {
+      size_t m = i % 1024;
+      const char *at = &received[offsets[m]];
+      size_t len = offsets[m + 1] - offsets[m];
+      if (mode == 0) {
+        json_value_t *v = NULL;
+        json_parse(prepared[m], &v);
+        json_value_free(v);
+      } else if (mode == 1) {
+        json_document_parse(d, prepared[m]);
+      } else if (mode == 2) {
+        memcpy(copy, at, len);
+        copy[len] = '\0';
+        json_document_parse(d, copy);
+      } else {
+        json_document_parse_n(d, at, len);
+      }
+    }
+    small[mode] = now() - start;
+  }
+  free(received);
+  json_document_free(d);
+
+  printf("%zu messages of %zu bytes\n", messages, message_length);
+  printf("%20s %12s\n", "", "Kmsg/s");
+  printf("%20s %12.1f\n", "json_parse + free", messages / small[0] / 1e3);
+  printf("%20s %12.1f\n", "document", messages / small[1] / 1e3);
+  printf("%20s %12.1f\n", "copy + document", messages / small[2] / 1e3);
+  printf("%20s %12.1f\n", "document_parse_n", messages / small[3] / 1e3);
+
+  // The messages as an NDJSON file, parsed with ever more threads
+  char ndjson[] = "/tmp/bench_jsonXXXXXX";
+  fd = mkstemp(ndjson);
+  file = fd >= 0 ? fdopen(fd, "w") : NULL;
+  check(file ? CUTILS_SUCCESS : CUTILS_IO_ERROR, ndjson);
+  size_t ndjson_length = 0;
+  for (size_t i = 0; i < messages; i++) {
+    ndjson_length += (size_t)fprintf(file, "%s\n", prepared[i % 1024]);
+  }
+  fclose(file);
+  free(prepared);
+
+  size_t cpus = (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+  printf("%zu lines, %.1f MB, %zu cpus\n", messages, ndjson_length / 1e6,
+         cpus);
+  printf("%20s %12s\n", "threads", "MB/s");
+  for (size_t threads = 0; threads <= cpus;
+       threads = threads > 0 ? threads * 2 : 1) {
+    thread_pool_t *pool = NULL;
+    if (threads > 0) {
+      pool = malloc(sizeof(thread_pool_t));
+      check(thread_pool_init(pool, threads), "thread_pool_init");
+    }
+    size_t count = 0;
+    start = now();
+    cutils_error_t err = json_parse_lines_file(ndjson, drop_line, &count, pool);
+    double elapsed = now() - start;
+    check(err, "json_parse_lines_file");
+    if (count != messages) {
+      fprintf(stderr, "%zu of %zu lines delivered\n", count, messages);
+      return EXIT_FAILURE;
+    }
+    thread_pool_free(pool);
+
+    char label[32];
+    snprintf(label, sizeof(label), threads ? "%zu" : "serial", threads);
+    printf("%20s %12.1f\n", label, ndjson_length / elapsed / 1e6);
+  }
+  unlink(ndjson);
+
+  // Number formatting alone, against the %.17g it replaces
+  json_value_free(doc);
+  free(text);
+  text = malloc(n * 32 + 16);
+  assert(text != NULL);
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  length = 0;
+  text[length++] = '[';
+  for (size_t i = 0; i < n; i++) {
+    double d = (double)(next_random(&state) >> 11) / (double)(1ull << 40);
+    length += sprintf(&text[length], "%s%.17g", i > 0 ? "," : "", d);
+  }
+  text[length++] = ']';
+  text[length] = '\0';
+  json_parse(text, &doc);
+
+  start = now();
+  for (size_t r = 0; r < rounds; r++) {
+    out->length = 0;
+    json_stringify(doc, JSON_FORMAT_COMPACT, out);
+  }
+  double shortest = now() - start;
+
+  start = now();
+  for (size_t r = 0; r < rounds; r++) {
+    length = 0;
+    for (size_t i = 0; i < n; i++) {
+      json_value_t *v = doc->value.array->backing[i];
+      length += sprintf(&text[length], "%.17g,", v->value.number);
+    }
+  }
+  double reference = now() - start;
+
+  printf("%20s %12.1f\n", "doubles (Mnum/s)", n * rounds / shortest / 1e6);
+  printf("%20s %12.1f\n", "%.17g (Mnum/s)", n * rounds / reference / 1e6);
+
+  json_buffer_free(out);
+  json_value_free(doc);
+  free(text);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#include "cutils/errors.h"
+#include "cutils/linked_list.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Reports a failed setup call and exits, with or without NDEBUG.
+void check(cutils_error_t err, const char *what) {
+  if (err != CUTILS_SUCCESS) {
+    fprintf(stderr, "%s: %s\n", what, cutils_error_message(err));
+    exit(EXIT_FAILURE);
+  }
+}
+
+// Queue-style churn: keep `depth` values queued while pushing to the back and
+// popping from the front `ops` times.
+double churn(linked_list_t *l, size_t depth, size_t ops) {
+  for (size_t i = 0; i < depth; i++) {
+    linked_list_push_back(l, (void *)(uintptr_t)i);
+  }
+
+  double start = now();
+  void *value = NULL;
+  for (size_t i = 0; i < ops; i++) {
+    linked_list_push_back(l, (void *)(uintptr_t)i);
+    linked_list_pop_front(l, &value);
+  }
+  double elapsed = now() - start;
+
+  while (l->length > 0) {
+    linked_list_pop_front(l, &value);
+  }
+
+  return elapsed;
+}
+
+int main(int argc, char **argv) {
+  size_t ops = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+
+  printf("%zu push_back/pop_front pairs\n", ops);
+  printf("%8s %14s %14s %10s\n", "depth", "malloc (Mop/s)", "pool (Mop/s)",
+         "speedup");
+
+  size_t depths[] = {1, 64, 4096, 262144};
+  for (size_t i = 0; i < sizeof(depths) / sizeof(depths[0]); i++) {
+    linked_list_t *plain = malloc(sizeof(linked_list_t));
+    cutils_error_t err = linked_list_init(plain, NULL, NULL);
+    check(err, "linked_list_init");
+    double plain_time = churn(plain, depths[i], ops);
+    linked_list_free(plain);
+
+    linked_list_t *pooled = malloc(sizeof(linked_list_t));
+    err = linked_list_init_pooled(pooled, NULL, NULL, NULL);
+    check(err, "linked_list_init_pooled");
+    double pooled_time = churn(pooled, depths[i], ops);
+    linked_list_free(pooled);
+
+    printf("%8zu %14.1f %14.1f %9.2fx\n", depths[i], ops / plain_time / 1e6,
+           ops / pooled_time / 1e6, plain_time / pooled_time);
+  }
+
+  return EXIT_SUCCESS;
+}
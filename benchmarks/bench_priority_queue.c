@@ -0,0 +1,100 @@
+#include "cutils/errors.h"
+#include "cutils/priority_queue.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Setup failures end the run here, since asserts compile out in Release.
+void check(cutils_error_t err, const char *what) {
+  if (err != CUTILS_SUCCESS) {
+    fprintf(stderr, "%s: %s\n", what, cutils_error_message(err));
+    exit(EXIT_FAILURE);
+  }
+}
+
+int cmp_int(void *lhs, void *rhs) {
+  uintptr_t l = (uintptr_t)lhs;
+  uintptr_t r = (uintptr_t)rhs;
+  return (l > r) - (l < r);
+}
+
+uint64_t next_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+// Fills the heap with `n` random priorities, then runs the hold model: pop
+// the minimum and push a later priority, `ops` times.
+double run_generic(size_t arity, size_t n, size_t ops) {
+  priority_queue_t *q = malloc(sizeof(priority_queue_t));
+  cutils_error_t err = priority_queue_init(q, arity, cmp_int, NULL, NULL, NULL);
+  check(err, "priority_queue_init");
+
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  double start = now();
+  for (size_t i = 0; i < n; i++) {
+    priority_queue_push(q, (void *)(uintptr_t)(next_random(&state) >> 20));
+  }
+  for (size_t i = 0; i < ops; i++) {
+    void *value = NULL;
+    priority_queue_pop(q, &value);
+    uintptr_t later = (uintptr_t)value + (next_random(&state) >> 40);
+    priority_queue_push(q, (void *)later);
+  }
+  double elapsed = now() - start;
+
+  priority_queue_free(q);
+  return elapsed;
+}
+
+double run_u64(size_t arity, size_t n, size_t ops) {
+  priority_queue_u64_t *q = malloc(sizeof(priority_queue_u64_t));
+  cutils_error_t err = priority_queue_u64_init(q, arity, n);
+  check(err, "priority_queue_u64_init");
+
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  double start = now();
+  for (size_t i = 0; i < n; i++) {
+    priority_queue_u64_push(q, next_random(&state) >> 20, NULL);
+  }
+  for (size_t i = 0; i < ops; i++) {
+    uint64_t priority = 0;
+    priority_queue_u64_pop(q, &priority, NULL);
+    priority_queue_u64_push(q, priority + (next_random(&state) >> 40), NULL);
+  }
+  double elapsed = now() - start;
+
+  priority_queue_u64_free(q);
+  return elapsed;
+}
+
+int main(int argc, char **argv) {
+  size_t ops = argc > 1 ? strtoull(argv[1], NULL, 10) : 2000000;
+
+  printf("fill, then %zu pop+push pairs\n", ops);
+  printf("%10s %8s %16s %14s\n", "size", "arity", "generic (Mop/s)",
+         "u64 (Mop/s)");
+
+  size_t sizes[] = {1000, 100000, 1000000, 10000000};
+  size_t arities[] = {2, 4, 8};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    for (size_t j = 0; j < sizeof(arities) / sizeof(arities[0]); j++) {
+      size_t total = sizes[i] + ops;
+      double generic = run_generic(arities[j], sizes[i], ops);
+      double u64 = run_u64(arities[j], sizes[i], ops);
+      printf("%10zu %8zu %16.1f %14.1f\n", sizes[i], arities[j],
+             total / generic / 1e6, total / u64 / 1e6);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+#include "cutils/errors.h"
+#include "cutils/intrusive_list.h"
+#include "cutils/priority_queue.h"
+#include "cutils/timer_wheel.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define HORIZON ((uint64_t)1 << 20)
+
+typedef struct {
+  bool cancelled;
+  timer_wheel_timer_t timer;
+} conn_t;
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Stops on a failed setup call; these checks must outlive NDEBUG.
+void check(cutils_error_t err, const char *what) {
+  if (err != CUTILS_SUCCESS) {
+    fprintf(stderr, "%s: %s\n", what, cutils_error_message(err));
+    exit(EXIT_FAILURE);
+  }
+}
+
+uint64_t next_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+// Arms `n` timers over HORIZON ticks, cancels every other one, then ticks
+// through to the end draining the expired batches.
+void run_wheel(conn_t *conns, size_t n, double *times) {
+  timer_wheel_t *w = malloc(sizeof(timer_wheel_t));
+  cutils_error_t err = timer_wheel_init(w, 0);
+  check(err, "timer_wheel_init");
+
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  double start = now();
+  for (size_t i = 0; i < n; i++) {
+    timer_wheel_timer_init(&conns[i].timer);
+    timer_wheel_add(w, &conns[i].timer, 1 + next_random(&state) % HORIZON);
+  }
+  times[0] = now() - start;
+
+  start = now();
+  for (size_t i = 0; i < n; i += 2) {
+    timer_wheel_cancel(w, &conns[i].timer);
+  }
+  times[1] = now() - start;
+
+  intrusive_list_t expired;
+  intrusive_list_init(&expired);
+  size_t fired = 0;
+  start = now();
+  for (uint64_t tick = 1; tick <= HORIZON; tick++) {
+    timer_wheel_advance(w, tick, &expired);
+    fired += expired.length;
+    intrusive_list_init(&expired);
+  }
+  times[2] = now() - start;
+  if (fired != n / 2) {
+    fprintf(stderr, "wheel fired %zu timers, expected %zu\n", fired, n / 2);
+    exit(EXIT_FAILURE);
+  }
+
+  timer_wheel_free(w);
+}
+
+// Same workload on a heap; having no handles, it cancels lazily by flag.
+void run_heap(conn_t *conns, size_t n, double *times) {
+  priority_queue_u64_t *q = malloc(sizeof(priority_queue_u64_t));
+  cutils_error_t err = priority_queue_u64_init(q, 4, n);
+  check(err, "priority_queue_u64_init");
+
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  double start = now();
+  for (size_t i = 0; i < n; i++) {
+    conns[i].cancelled = false;
+    priority_queue_u64_push(q, 1 + next_random(&state) % HORIZON, &conns[i]);
+  }
+  times[0] = now() - start;
+
+  start = now();
+  for (size_t i = 0; i < n; i += 2) {
+    conns[i].cancelled = true;
+  }
+  times[1] = now() - start;
+
+  size_t fired = 0;
+  start = now();
+  for (uint64_t tick = 1; tick <= HORIZON; tick++) {
+    uint64_t deadline = 0;
+    void *payload = NULL;
+    while (priority_queue_u64_peek(q, &deadline, &payload) == CUTILS_SUCCESS &&
+           deadline <= tick) {
+      priority_queue_u64_pop(q, NULL, NULL);
+      fired += !((conn_t *)payload)->cancelled;
+    }
+  }
+  times[2] = now() - start;
+  if (fired != n / 2) {
+    fprintf(stderr, "heap fired %zu timers, expected %zu\n", fired, n / 2);
+    exit(EXIT_FAILURE);
+  }
+
+  priority_queue_u64_free(q);
+}
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+
+  conn_t *conns = malloc(sizeof(conn_t) * n);
+  check(conns ? CUTILS_SUCCESS : CUTILS_ALLOCATION_ERROR, "malloc");
+
+  double wheel[3];
+  double heap[3];
+  run_wheel(conns, n, wheel);
+  run_heap(conns, n, heap);
+
+  printf("%zu timers over %llu ticks, half cancelled\n", n,
+         (unsigned long long)HORIZON);
+  printf("%10s %14s %14s\n", "phase", "wheel (s)", "heap (s)");
+  const char *phases[] = {"add", "cancel", "expire"};
+  for (size_t i = 0; i < 3; i++) {
+    printf("%10s %14.3f %14.3f\n", phases[i], wheel[i], heap[i]);
+  }
+
+  free(conns);
+  return EXIT_SUCCESS;
+}
@@ -2,16 +2,34 @@
 #define __CUTILS_ARRAY_LIST_H__
 
 #include "cutils/errors.h"
+#include "cutils/thread_pool.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+// Lists shorter than this are sorted serially by array_list_parallel_sort.
+#define ARRAY_LIST_PARALLEL_SORT_THRESHOLD 65536
+
+// Number of consecutive elements handed to a worker at a time by the
+// array_list_parallel_* functions.
+#ifndef ARRAY_LIST_PARALLEL_CHUNK
+#define ARRAY_LIST_PARALLEL_CHUNK 256
+#endif
+
+// Backing stores of at least this many bytes live in an anonymous mapping
+// that grows with mremap instead of realloc.
+#ifndef ARRAY_LIST_MMAP_THRESHOLD
+#define ARRAY_LIST_MMAP_THRESHOLD (32 * 1024 * 1024)
+#endif
+
 typedef struct array_list {
   size_t length;
   size_t capacity;
   void **backing;
   void (*inner_free)(void *);
   void (*outer_free)(void (*)(void *), void *);
+  bool mapped;
+  bool huge_pages; // Request transparent huge pages for mapped backing stores
 } array_list_t;
 
 cutils_error_t array_list_init(array_list_t *l, size_t capacity,
@@ -20,6 +38,7 @@ cutils_error_t array_list_init(array_list_t *l, size_t capacity,
 void array_list_free(void *ptr);
 void array_list_free_value(array_list_t *l, size_t idx);
 cutils_error_t array_list_grow(array_list_t *l, size_t capacity);
+cutils_error_t array_list_shrink(array_list_t *l);
 cutils_error_t array_list_insert_at(array_list_t *l, size_t idx, void *value);
 cutils_error_t array_list_push(array_list_t *l, void *value);
 cutils_error_t array_list_remove_at(array_list_t *l, size_t idx, void **value);
@@ -29,4 +48,49 @@ cutils_error_t array_list_set(array_list_t *l, size_t idx, void *value);
 cutils_error_t array_list_find(array_list_t *l, void *value,
                                bool (*cmp)(void *, void *), size_t *idx);
 
+// Sorting and searching take a three-way comparator returning <0, 0 or >0.
+cutils_error_t array_list_sort(array_list_t *l, int (*cmp)(void *, void *));
+cutils_error_t array_list_stable_sort(array_list_t *l,
+                                      int (*cmp)(void *, void *));
+cutils_error_t array_list_parallel_sort(array_list_t *l,
+                                        int (*cmp)(void *, void *),
+                                        thread_pool_t *pool);
+cutils_error_t array_list_lower_bound(array_list_t *l, void *value,
+                                      int (*cmp)(void *, void *), size_t *idx);
+cutils_error_t array_list_upper_bound(array_list_t *l, void *value,
+                                      int (*cmp)(void *, void *), size_t *idx);
+cutils_error_t array_list_binary_search(array_list_t *l, void *value,
+                                        int (*cmp)(void *, void *),
+                                        size_t *idx);
+
+// Data-parallel helpers split the list into ARRAY_LIST_PARALLEL_CHUNK sized
+// chunks spread over the pool's workers, which steal chunks from each other
+// once their own run out. A NULL pool runs everything on the calling thread.
+cutils_error_t array_list_parallel_for(array_list_t *l,
+                                       void (*fn)(void *, size_t, void *),
+                                       void *ctx, thread_pool_t *pool);
+// Appends fn(l[i]) to `out` for every element, preserving order.
+cutils_error_t array_list_parallel_map(array_list_t *l, array_list_t *out,
+                                       void *(*fn)(void *, void *), void *ctx,
+                                       thread_pool_t *pool);
+// Folds elements into partial results starting from the identity `init`,
+// then merges them with `combine`. When `ordered` is set, partials are kept
+// per chunk and combined in index order, so the result does not depend on
+// scheduling or thread count.
+cutils_error_t array_list_parallel_reduce(array_list_t *l, void *init,
+                                          void *(*fn)(void *, void *, void *),
+                                          void *(*combine)(void *, void *,
+                                                           void *),
+                                          void *ctx, bool ordered,
+                                          thread_pool_t *pool, void **result);
+
+// Callback-free kernels over the backing store, vectorized with AVX2/SSE4.2
+// when the CPU supports it. Elements are compared by identity, or as
+// pointer-sized signed integers for min/max.
+cutils_error_t array_list_find_ptr(array_list_t *l, void *value, size_t *idx);
+cutils_error_t array_list_count_ptr(array_list_t *l, void *value,
+                                    size_t *count);
+cutils_error_t array_list_min_int(array_list_t *l, intptr_t *value);
+cutils_error_t array_list_max_int(array_list_t *l, intptr_t *value);
+
 #endif // __CUTILS_ARRAY_LIST_H__
@@ -0,0 +1,64 @@
+#ifndef __CUTILS_BTREE_H__
+#define __CUTILS_BTREE_H__
+
+#include "cutils/array_list.h"
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Keys per node; a node's key array spans eight 64-byte cache lines.
+#define BTREE_NODE_KEYS 64
+
+typedef struct btree_node {
+  uint32_t count;
+  bool leaf;
+  uint64_t keys[BTREE_NODE_KEYS];
+} btree_node_t;
+
+typedef struct btree_leaf {
+  btree_node_t node;
+  void *values[BTREE_NODE_KEYS];
+  struct btree_leaf *prev;
+  struct btree_leaf *next;
+} btree_leaf_t;
+
+typedef struct btree_inner {
+  btree_node_t node;
+  btree_node_t *children[BTREE_NODE_KEYS + 1];
+} btree_inner_t;
+
+// B+tree keyed by unsigned 64-bit integers, with values only in the leaves
+// and the leaves linked in key order for range scans.
+typedef struct btree {
+  size_t length;
+  btree_node_t *root;
+  void (*inner_free)(void *);
+} btree_t;
+
+typedef struct btree_iter {
+  btree_leaf_t *leaf;
+  uint32_t idx;
+} btree_iter_t;
+
+cutils_error_t btree_init(btree_t *t, void (*inner_free)(void *));
+void btree_free(void *ptr);
+cutils_error_t btree_insert(btree_t *t, uint64_t key, void *value);
+cutils_error_t btree_remove(btree_t *t, uint64_t key, void **value);
+cutils_error_t btree_get(btree_t *t, uint64_t key, void **value);
+cutils_error_t btree_floor(btree_t *t, uint64_t key, uint64_t *found,
+                           void **value);
+cutils_error_t btree_ceiling(btree_t *t, uint64_t key, uint64_t *found,
+                             void **value);
+// Builds an empty tree from `l`, whose values must be in strictly increasing
+// key order, in O(n). Leaves are filled evenly, their sizes differing by at
+// most one. The tree stores the list's value pointers as they are.
+cutils_error_t btree_bulk_load(btree_t *t, array_list_t *l,
+                               uint64_t (*key)(void *));
+
+cutils_error_t btree_seek(btree_t *t, uint64_t key, btree_iter_t *it);
+bool btree_iter_valid(btree_iter_t *it);
+cutils_error_t btree_iter_next(btree_iter_t *it);
+cutils_error_t btree_iter_get(btree_iter_t *it, uint64_t *key, void **value);
+
+#endif // __CUTILS_BTREE_H__
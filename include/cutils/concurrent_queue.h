@@ -0,0 +1,36 @@
+#ifndef __CUTILS_CONCURRENT_QUEUE_H__
+#define __CUTILS_CONCURRENT_QUEUE_H__
+
+#include "cutils/concurrent_stack.h"
+#include "cutils/errors.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Michael-Scott queue over concurrent_pool_t nodes; enqueue and dequeue are
+// safe from any number of threads. `head` points at a dummy node whose
+// successor holds the oldest value. Padding keeps the two ends on separate
+// cache lines so producers and consumers do not false-share.
+typedef struct concurrent_queue {
+  atomic_uint_fast64_t head;
+  char head_pad[64 - sizeof(atomic_uint_fast64_t)];
+  atomic_uint_fast64_t tail;
+  char tail_pad[64 - sizeof(atomic_uint_fast64_t)];
+  atomic_size_t length;
+  concurrent_pool_t *pool;
+  bool owns_pool;
+  void (*inner_free)(void *);
+} concurrent_queue_t;
+
+// A NULL `pool` gives the queue a private pool; a shared one must outlive
+// every container using it.
+cutils_error_t concurrent_queue_init(concurrent_queue_t *q,
+                                     concurrent_pool_t *pool,
+                                     void (*inner_free)(void *));
+void concurrent_queue_free(void *ptr);
+cutils_error_t concurrent_queue_enqueue(concurrent_queue_t *q, void *value);
+// Fails with CUTILS_INDEX_ERROR when the queue is empty.
+cutils_error_t concurrent_queue_dequeue(concurrent_queue_t *q, void **value);
+
+#endif // __CUTILS_CONCURRENT_QUEUE_H__
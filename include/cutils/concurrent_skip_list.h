@@ -0,0 +1,60 @@
+#ifndef __CUTILS_CONCURRENT_SKIP_LIST_H__
+#define __CUTILS_CONCURRENT_SKIP_LIST_H__
+
+#include "cutils/errors.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define CONCURRENT_SKIP_LIST_MAX_LEVEL 32
+
+typedef struct concurrent_skip_list_node {
+  void *key;
+  void *value;
+  size_t level;
+  _Atomic(struct concurrent_skip_list_node *) next[];
+} concurrent_skip_list_node_t;
+
+// Lock-free ordered map: any number of threads may insert and read at once,
+// and readers never wait on writers. Entries are never unlinked, so there is
+// no removal and every node stays valid until concurrent_skip_list_free.
+typedef struct concurrent_skip_list {
+  atomic_size_t length;
+  atomic_uint_fast64_t seed;
+  concurrent_skip_list_node_t *head;
+  int (*cmp)(void *, void *);
+  void (*key_free)(void *);
+  void (*inner_free)(void *);
+} concurrent_skip_list_t;
+
+typedef struct concurrent_skip_list_iter {
+  concurrent_skip_list_node_t *node;
+} concurrent_skip_list_iter_t;
+
+cutils_error_t concurrent_skip_list_init(concurrent_skip_list_t *s,
+                                         int (*cmp)(void *, void *),
+                                         void (*key_free)(void *),
+                                         void (*inner_free)(void *));
+void concurrent_skip_list_free(void *ptr);
+// Fails with CUTILS_DUPLICATE_ERROR, leaving `key` and `value` owned by the
+// caller, when the key is already present.
+cutils_error_t concurrent_skip_list_insert(concurrent_skip_list_t *s,
+                                           void *key, void *value);
+cutils_error_t concurrent_skip_list_get(concurrent_skip_list_t *s, void *key,
+                                        void **value);
+cutils_error_t concurrent_skip_list_floor(concurrent_skip_list_t *s,
+                                          void *key, void **found,
+                                          void **value);
+cutils_error_t concurrent_skip_list_ceiling(concurrent_skip_list_t *s,
+                                            void *key, void **found,
+                                            void **value);
+
+cutils_error_t concurrent_skip_list_seek(concurrent_skip_list_t *s, void *key,
+                                         concurrent_skip_list_iter_t *it);
+bool concurrent_skip_list_iter_valid(concurrent_skip_list_iter_t *it);
+cutils_error_t concurrent_skip_list_iter_next(concurrent_skip_list_iter_t *it);
+cutils_error_t concurrent_skip_list_iter_get(concurrent_skip_list_iter_t *it,
+                                             void **key, void **value);
+
+#endif // __CUTILS_CONCURRENT_SKIP_LIST_H__
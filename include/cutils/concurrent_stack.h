@@ -0,0 +1,65 @@
+#ifndef __CUTILS_CONCURRENT_STACK_H__
+#define __CUTILS_CONCURRENT_STACK_H__
+
+#include "cutils/errors.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Segment k holds 2^(k + CONCURRENT_POOL_FIRST_SHIFT) nodes, which keeps
+// every node index within 32 bits.
+#define CONCURRENT_POOL_FIRST_SHIFT 6
+#define CONCURRENT_POOL_MAX_SEGMENTS 26
+
+// Links between nodes are 64-bit words packing a 32-bit node index (0 is
+// NULL) with a 32-bit tag bumped on every update. A CAS on a stale word
+// therefore fails even when the same node is back in place (ABA).
+#define CONCURRENT_TAGGED(idx, tag) (((uint64_t)(tag) << 32) | (uint32_t)(idx))
+#define CONCURRENT_TAGGED_IDX(word) ((uint32_t)(word))
+#define CONCURRENT_TAGGED_TAG(word) ((uint32_t)((word) >> 32))
+
+typedef struct concurrent_node {
+  _Atomic(void *) value;
+  atomic_uint_fast64_t next;
+  uint32_t idx;
+} concurrent_node_t;
+
+// Node allocator for the lock-free containers. Nodes are carved from
+// segments that live until the pool is freed, and released nodes go on a
+// lock-free free list rather than back to malloc. A thread that loses a
+// race may still read a node after it was recycled, but never after its
+// memory is gone, so no hazard pointers or epochs are needed.
+typedef struct concurrent_pool {
+  atomic_uint_fast64_t free_nodes;
+  atomic_uint_fast32_t reserved;
+  _Atomic(concurrent_node_t *) segments[CONCURRENT_POOL_MAX_SEGMENTS];
+} concurrent_pool_t;
+
+// Treiber stack; push and pop are safe from any number of threads.
+typedef struct concurrent_stack {
+  atomic_uint_fast64_t top;
+  atomic_size_t length;
+  concurrent_pool_t *pool;
+  bool owns_pool;
+  void (*inner_free)(void *);
+} concurrent_stack_t;
+
+cutils_error_t concurrent_pool_init(concurrent_pool_t *p);
+void concurrent_pool_free(void *ptr);
+// Returns NULL when memory or node indices run out.
+concurrent_node_t *concurrent_pool_alloc(concurrent_pool_t *p, void *value);
+void concurrent_pool_release(concurrent_pool_t *p, concurrent_node_t *node);
+concurrent_node_t *concurrent_pool_node(concurrent_pool_t *p, uint32_t idx);
+
+// A NULL `pool` gives the stack a private pool; a shared one must outlive
+// every container using it.
+cutils_error_t concurrent_stack_init(concurrent_stack_t *s,
+                                     concurrent_pool_t *pool,
+                                     void (*inner_free)(void *));
+void concurrent_stack_free(void *ptr);
+cutils_error_t concurrent_stack_push(concurrent_stack_t *s, void *value);
+// Fails with CUTILS_INDEX_ERROR when the stack is empty.
+cutils_error_t concurrent_stack_pop(concurrent_stack_t *s, void **value);
+
+#endif // __CUTILS_CONCURRENT_STACK_H__
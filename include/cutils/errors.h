@@ -8,6 +8,10 @@ typedef enum cutils_error {
   CUTILS_INDEX_ERROR,
   CUTILS_RESIZE_ERROR,
   CUTILS_JSON_PARSE_ERROR,
+  CUTILS_THREAD_ERROR,
+  CUTILS_DUPLICATE_ERROR,
+  CUTILS_POOL_ERROR,
+  CUTILS_IO_ERROR,
 } cutils_error_t;
 
 const char *cutils_error_message(cutils_error_t err);
@@ -0,0 +1,55 @@
+#ifndef __CUTILS_INTRUSIVE_LIST_H__
+#define __CUTILS_INTRUSIVE_LIST_H__
+
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// Embedded in a user struct; the list never allocates or frees anything.
+typedef struct intrusive_list_link {
+  struct intrusive_list_link *prev;
+  struct intrusive_list_link *next;
+} intrusive_list_link_t;
+
+// Circular list around a sentinel `root`, so `&l->root` marks the end.
+typedef struct intrusive_list {
+  size_t length;
+  intrusive_list_link_t root;
+} intrusive_list_t;
+
+#define INTRUSIVE_LIST_ENTRY(link, type, member)                               \
+  ((type *)((char *)(link) - offsetof(type, member)))
+
+#define INTRUSIVE_LIST_FOR_EACH(l, link)                                       \
+  for (intrusive_list_link_t *link = (l)->root.next; link != &(l)->root;       \
+       link = link->next)
+
+cutils_error_t intrusive_list_init(intrusive_list_t *l);
+// Marks `link` as in no list. Links must start out this way, or zeroed, for
+// intrusive_list_is_linked and intrusive_list_unlink to tell; removal from a
+// list leaves them so again.
+cutils_error_t intrusive_list_link_init(intrusive_list_link_t *link);
+bool intrusive_list_is_linked(intrusive_list_link_t *link);
+cutils_error_t intrusive_list_insert_before(intrusive_list_t *l,
+                                            intrusive_list_link_t *pos,
+                                            intrusive_list_link_t *link);
+cutils_error_t intrusive_list_insert_after(intrusive_list_t *l,
+                                           intrusive_list_link_t *pos,
+                                           intrusive_list_link_t *link);
+cutils_error_t intrusive_list_push_front(intrusive_list_t *l,
+                                         intrusive_list_link_t *link);
+cutils_error_t intrusive_list_push_back(intrusive_list_t *l,
+                                        intrusive_list_link_t *link);
+cutils_error_t intrusive_list_unlink(intrusive_list_t *l,
+                                     intrusive_list_link_t *link);
+cutils_error_t intrusive_list_pop_front(intrusive_list_t *l,
+                                        intrusive_list_link_t **link);
+cutils_error_t intrusive_list_pop_back(intrusive_list_t *l,
+                                       intrusive_list_link_t **link);
+// Moves every link of `src` in front of `pos` in `dst`, leaving `src` empty.
+cutils_error_t intrusive_list_splice(intrusive_list_t *dst,
+                                     intrusive_list_link_t *pos,
+                                     intrusive_list_t *src);
+
+#endif // __CUTILS_INTRUSIVE_LIST_H__
@@ -3,9 +3,10 @@
 
 #include "cutils/array_list.h"
 #include "cutils/errors.h"
-#include "cutils/hashmap.h"
+#include "cutils/thread_pool.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef enum json_type {
   JSON_NULL,
@@ -16,6 +17,48 @@ typedef enum json_type {
   JSON_OBJECT,
 } json_type_t;
 
+#define JSON_ARENA_DEFAULT_CHUNK 65536
+
+typedef struct json_arena_chunk {
+  struct json_arena_chunk *next;
+  size_t size;
+  char data[];
+} json_arena_chunk_t;
+
+// Bump allocator handing out 8-byte aligned blocks from a chain of chunks.
+// Resetting rewinds to the first chunk and keeps the rest for reuse.
+typedef struct json_arena {
+  size_t chunk_size;
+  size_t used;     // Bytes handed out since the last reset
+  size_t reserved; // Bytes held in chunks
+  json_arena_chunk_t *first;
+  json_arena_chunk_t *current;
+  char *cursor;
+  char *end;
+} json_arena_t;
+
+// Objects with more members than this get a hash index on first lookup;
+// smaller ones are searched linearly.
+#ifndef JSON_OBJECT_INDEX_THRESHOLD
+#define JSON_OBJECT_INDEX_THRESHOLD 8
+#endif
+
+typedef struct json_member {
+  char *key;
+  struct json_value *value;
+} json_member_t;
+
+// Members in document order, repeated keys included; lookups see the last.
+// The index holds member positions plus one in open-addressed slots.
+typedef struct json_object {
+  size_t length;
+  size_t capacity;
+  json_member_t *members;
+  size_t nslots;
+  uint32_t *slots;
+  json_arena_t *arena; // Owner of members and slots, NULL when malloc'd
+} json_object_t;
+
 typedef struct json_value {
   json_type_t type;
   union {
@@ -23,11 +66,331 @@ typedef struct json_value {
     double number;
     char *string;
     array_list_t *array;
-    hashmap_t *object;
+    json_object_t *object;
   } value;
 } json_value_t;
 
+typedef enum json_format {
+  JSON_FORMAT_COMPACT,
+  JSON_FORMAT_PRETTY, // Two-space indent, one member or element per line
+} json_format_t;
+
+// Documents at least this long are parsed through a structural index; shorter
+// ones are not worth the extra pass.
+#ifndef JSON_INDEX_THRESHOLD
+#define JSON_INDEX_THRESHOLD 1024
+#endif
+
+// Sorted offsets of every structural character ({}[]:,), opening quote and
+// start of a number or literal outside strings, ending with the document
+// length as a sentinel.
+typedef struct json_index {
+  size_t length;
+  size_t capacity;
+  uint32_t *positions;
+} json_index_t;
+
+// A parsed value whose nodes, strings, arrays and objects all live in one
+// arena, so the whole tree is released at once. Arrays in it are read-only;
+// objects grow from the arena. Neither may be passed to json_value_free. The
+// arena, index and container stack are kept from one parse to the next.
+typedef struct json_document {
+  json_value_t *root;
+  json_arena_t *arena;
+  json_index_t *index;
+  array_list_t *stack;
+} json_document_t;
+
+typedef enum json_event_type {
+  JSON_EVENT_NULL,
+  JSON_EVENT_BOOLEAN,
+  JSON_EVENT_NUMBER,
+  JSON_EVENT_STRING,
+  JSON_EVENT_KEY,
+  JSON_EVENT_START_ARRAY,
+  JSON_EVENT_END_ARRAY,
+  JSON_EVENT_START_OBJECT,
+  JSON_EVENT_END_OBJECT,
+} json_event_type_t;
+
+// One step through a document. Strings and keys are decoded into a buffer
+// owned by the parser and only valid until the handler returns. The root
+// value is at depth 0, and a container's events are one level above its
+// children's.
+typedef struct json_event {
+  json_event_type_t type;
+  size_t depth;
+  bool boolean;
+  double number;
+  const char *string;
+  size_t length;
+} json_event_t;
+
+typedef enum json_action {
+  JSON_CONTINUE,
+  JSON_SKIP, // From a start or key event, passes over that container or value
+  JSON_STOP, // Ends parsing successfully, leaving the rest unchecked
+} json_action_t;
+
+typedef json_action_t (*json_handler_t)(void *ctx, json_event_t *event);
+
+// Growable output buffer, kept NUL-terminated after `length` bytes.
+typedef struct json_buffer {
+  size_t length;
+  size_t capacity;
+  char *data;
+} json_buffer_t;
+
+// A whole document as one array of 64-bit words, each a tag character in the
+// top byte over a 56-bit payload:
+//   'n' 't' 'f'  null, true, false
+//   'd'          number, its double in the following word
+//   '"'          string, at this offset in `strings`
+//   's'          string left in the source at this offset, its length in
+//                the following word
+//   '[' '{'      open, with the member or element count (saturating) in bits
+//                32-55 and the position of the matching close in bits 0-31
+//   ']' '}'      close, with the position of the matching open
+// Object members are a key string followed by the value. Strings in the
+// buffer hold a 32-bit length, the bytes and a NUL.
+typedef struct json_tape {
+  size_t length;
+  size_t capacity;
+  uint64_t *words;
+  json_buffer_t *strings;
+  json_index_t *index;
+  const char *source; // Text behind 's' words, NULL when there are none
+} json_tape_t;
+
+#define JSON_TAPE_TAG(word) ((char)((word) >> 56))
+#define JSON_TAPE_PAYLOAD(word) ((word) & 0x00ffffffffffffffull)
+#define JSON_TAPE_COUNT_MAX 0xffffff
+
+// A file mapped read-only, to be parsed where it lies.
+typedef struct json_file {
+  const char *data;
+  size_t length;
+  size_t released; // Leading bytes whose pages were handed back
+} json_file_t;
+
+// In bounded mode, parsed pages are handed back each time parsing moves this
+// far past the last release.
+#ifndef JSON_FILE_WINDOW
+#define JSON_FILE_WINDOW (8 << 20)
+#endif
+
+typedef enum json_file_flags {
+  JSON_FILE_VIEWS = 1 << 0,   // Strings without escapes stay in the mapping
+  JSON_FILE_BOUNDED = 1 << 1, // Hand back pages behind the parse
+} json_file_flags_t;
+
+// One line of newline-delimited JSON. The handler takes ownership of `value`,
+// which is NULL when `err` reports the line as malformed.
+typedef struct json_line {
+  size_t number; // Counted from 1, blank lines included
+  size_t offset; // Of the line's first byte in the input
+  cutils_error_t err;
+  json_value_t *value;
+} json_line_t;
+
+// JSON_STOP ends delivery; the other actions carry on.
+typedef json_action_t (*json_line_handler_t)(void *ctx, json_line_t *line);
+
+// Bytes of lines handed to a worker at a time by json_parse_lines, rounded
+// up to the end of the line they finish in. Kept small so that the trees of a
+// chunk are still in cache when they are delivered.
+#ifndef JSON_LINES_CHUNK
+#define JSON_LINES_CHUNK (64 << 10)
+#endif
+
+// What a push parser expects next.
+typedef enum json_parser_state {
+  JSON_PARSER_VALUE,
+  JSON_PARSER_FIRST_ELEMENT, // A value or ']'
+  JSON_PARSER_KEY,
+  JSON_PARSER_FIRST_KEY, // A key or '}'
+  JSON_PARSER_COLON,
+  JSON_PARSER_NEXT, // ',' or the close of the innermost container
+  JSON_PARSER_DONE,
+} json_parser_state_t;
+
+// The token a push parser is in the middle of, if any.
+typedef enum json_parser_token {
+  JSON_PARSER_NONE,
+  JSON_PARSER_STRING,
+  JSON_PARSER_NAME, // A string in key position
+  JSON_PARSER_NUMBER,
+  JSON_PARSER_LITERAL,
+} json_parser_token_t;
+
+// Parser for input arriving in pieces, keeping its place between them with
+// an explicit stack of open containers. Without a handler it builds a value
+// itself. A token cut by a chunk boundary is carried over in `token`.
+typedef struct json_parser {
+  json_handler_t handler;
+  void *ctx;
+  cutils_error_t err; // Once set, returned by every feed until a reset
+  json_parser_state_t state;
+  json_parser_token_t lex;
+  bool escaped; // The last string byte seen was an unescaped backslash
+  bool decode;  // The current string has escapes to decode
+  bool stopped;
+  size_t mute; // One above the depth of a value being skipped, else 0
+  size_t depth;
+  size_t capacity;
+  char *frames; // '[' or '{' per open container
+  json_buffer_t *token;
+  json_buffer_t *scratch;
+  json_value_t *value;      // Root of the value being built
+  array_list_t *containers; // Open containers in it, innermost last
+  char *key;                // Member name waiting for its value
+} json_parser_t;
+
+// Receives serialized output in chunks; a non-success return aborts.
+typedef cutils_error_t (*json_sink_t)(void *ctx, const char *data,
+                                      size_t length);
+
 cutils_error_t json_parse(const char *text, json_value_t **value);
+// Parses exactly `length` bytes, which need no NUL after them; a NUL among
+// them is rejected like any other stray byte.
+cutils_error_t json_parse_n(const char *text, size_t length,
+                            json_value_t **value);
 void json_value_free(void *ptr);
 
+// Reports `text` to `handler` as a stream of events without building any
+// values. Memory grows with nesting depth and the longest string only. A
+// skipped subtree gets no events, not even its end, and is only checked for
+// balanced brackets and closed strings.
+cutils_error_t json_parse_events(const char *text, json_handler_t handler,
+                                 void *ctx);
+
+// A NULL `handler` makes the parser build a value, handed over by
+// json_parser_take.
+cutils_error_t json_parser_init(json_parser_t *p, json_handler_t handler,
+                                void *ctx);
+void json_parser_free(void *ptr);
+// Parses the next `length` bytes of the document. Events, or the value, are
+// complete as soon as their last byte arrives, except for a number at the
+// root, which only json_parser_finish can end.
+cutils_error_t json_parser_feed(json_parser_t *p, const char *data,
+                                size_t length);
+// Marks the end of input, failing with CUTILS_JSON_PARSE_ERROR when the
+// document is incomplete.
+cutils_error_t json_parser_finish(json_parser_t *p);
+// Hands over the parsed value and readies `p` for another document. Fails
+// with CUTILS_INDEX_ERROR until a whole value has been parsed.
+cutils_error_t json_parser_take(json_parser_t *p, json_value_t **value);
+// Discards any partial document and error.
+void json_parser_reset(json_parser_t *p);
+
+cutils_error_t json_object_init(json_object_t *o, size_t capacity);
+// Frees the members' keys and values too, unless the object is in an arena.
+void json_object_free(void *ptr);
+// Finds the last member named `key`. The first lookup on a large object
+// builds its index, so even lookups must not race with each other.
+cutils_error_t json_object_get(json_object_t *o, const char *key,
+                               json_value_t **value);
+// Adds a member without looking for an existing one, taking ownership of
+// `key` and `value`.
+cutils_error_t json_object_append(json_object_t *o, char *key,
+                                  json_value_t *value);
+// Replaces the value of the last member named `key`, or appends one. The
+// object takes ownership of `key` and `value` either way.
+cutils_error_t json_object_set(json_object_t *o, char *key,
+                               json_value_t *value);
+
+cutils_error_t json_arena_init(json_arena_t *a, size_t chunk_size);
+void json_arena_free(void *ptr);
+void *json_arena_alloc(json_arena_t *a, size_t size);
+void json_arena_reset(json_arena_t *a);
+
+cutils_error_t json_document_init(json_document_t *d, size_t chunk_size);
+void json_document_free(void *ptr);
+// Parses `text` into `d`, first discarding whatever it held.
+cutils_error_t json_document_parse(json_document_t *d, const char *text);
+cutils_error_t json_document_parse_n(json_document_t *d, const char *text,
+                                     size_t length);
+void json_document_clear(json_document_t *d);
+
+cutils_error_t json_tape_init(json_tape_t *t, size_t capacity);
+void json_tape_free(void *ptr);
+// Parses `text` into `t`, reusing its buffers. Fails with CUTILS_INDEX_ERROR
+// when the tape outgrows 32-bit positions.
+cutils_error_t json_tape_parse(json_tape_t *t, const char *text);
+cutils_error_t json_tape_parse_n(json_tape_t *t, const char *text,
+                                 size_t length);
+
+// Navigation takes tape positions; the root is at 0. Children of a container
+// at `pos` run from pos + 1 up to json_tape_end(t, pos), each found from the
+// last with json_tape_next.
+json_type_t json_tape_type(json_tape_t *t, size_t pos);
+size_t json_tape_next(json_tape_t *t, size_t pos);
+size_t json_tape_end(json_tape_t *t, size_t pos);
+// These fail with CUTILS_INDEX_ERROR when `pos` holds another type.
+cutils_error_t json_tape_length(json_tape_t *t, size_t pos, size_t *length);
+// Position of the value of the last member named `key`.
+cutils_error_t json_tape_find(json_tape_t *t, size_t pos, const char *key,
+                              size_t *value);
+cutils_error_t json_tape_get_boolean(json_tape_t *t, size_t pos, bool *value);
+cutils_error_t json_tape_get_number(json_tape_t *t, size_t pos,
+                                    double *value);
+// Strings can hold NULs. Those left in a file mapping have no NUL after them,
+// so for them a NULL `length` fails with CUTILS_NULL_ERROR.
+cutils_error_t json_tape_get_string(json_tape_t *t, size_t pos,
+                                    const char **value, size_t *length);
+
+// Maps `path`, hinting sequential access and huge pages. Fails with
+// CUTILS_IO_ERROR when the file cannot be opened or mapped.
+cutils_error_t json_file_open(json_file_t *f, const char *path);
+void json_file_free(void *ptr);
+// Drops the pages wholly before `offset` from memory. They are read back from
+// the file if touched again.
+void json_file_release(json_file_t *f, size_t offset);
+// Maps `path` into `f` and parses it in place into `t`. With JSON_FILE_VIEWS
+// the tape reads strings out of `f`, which must then stay open while `t` is
+// used. Bounded mode skips the structural index, which grows with the file.
+cutils_error_t json_parse_file(json_tape_t *t, json_file_t *f,
+                               const char *path, int flags);
+// Streams the file at `path` to `handler` in bounded mode, so memory stays
+// within a window of the mapping plus what json_parse_events needs.
+cutils_error_t json_parse_file_events(const char *path, json_handler_t handler,
+                                      void *ctx);
+
+// Parses every non-blank line of `text` as its own document, spreading
+// JSON_LINES_CHUNK sized runs of lines over the pool's workers. Lines reach
+// `handler` on the calling thread in input order, while the next runs parse.
+// A malformed line is reported to the handler and does not stop the rest. A
+// NULL pool parses everything on the calling thread.
+cutils_error_t json_parse_lines(const char *text, size_t length,
+                                json_line_handler_t handler, void *ctx,
+                                thread_pool_t *pool);
+// The same over a mapping of `path`, handing pages back once their lines have
+// been delivered.
+cutils_error_t json_parse_lines_file(const char *path,
+                                     json_line_handler_t handler, void *ctx,
+                                     thread_pool_t *pool);
+
+cutils_error_t json_index_init(json_index_t *idx, size_t capacity);
+void json_index_free(void *ptr);
+// Classifies `text` 64 bytes at a time with AVX2/SSE4.2 when the CPU supports
+// it. Fails with CUTILS_JSON_PARSE_ERROR when a string is left open, and
+// CUTILS_INDEX_ERROR for documents of 4GB or more.
+cutils_error_t json_index_build(json_index_t *idx, const char *text,
+                                size_t length);
+// Portable version of json_index_build, producing the same index.
+cutils_error_t json_index_build_scalar(json_index_t *idx, const char *text,
+                                       size_t length);
+
+cutils_error_t json_buffer_init(json_buffer_t *b, size_t capacity);
+void json_buffer_free(void *ptr);
+
+// Appends `v` to `out`. Numbers are written in the shortest form that parses
+// back to the same double; NaN and infinities, which JSON cannot express, are
+// written as null.
+cutils_error_t json_stringify(json_value_t *v, json_format_t format,
+                              json_buffer_t *out);
+// Streams `v` to `sink` through a fixed-size staging buffer.
+cutils_error_t json_stringify_sink(json_value_t *v, json_format_t format,
+                                   json_sink_t sink, void *ctx);
+
 #endif // __CUTILS_JSON_H__
@@ -14,16 +14,40 @@ typedef struct linked_list_node {
 
 linked_list_node_t *linked_list_node_init(void *);
 
+#define LINKED_LIST_POOL_SLAB_NODES 256
+
+// Hands out nodes from fixed-size slabs and recycles released nodes through a
+// free list. A pool may be shared by several lists on the same thread.
+typedef struct linked_list_pool {
+  size_t slab_nodes;
+  linked_list_node_t *free_nodes;
+  void *slabs;
+} linked_list_pool_t;
+
+cutils_error_t linked_list_pool_init(linked_list_pool_t *p, size_t slab_nodes);
+void linked_list_pool_free(void *ptr);
+linked_list_node_t *linked_list_pool_alloc(linked_list_pool_t *p, void *value);
+void linked_list_pool_release(linked_list_pool_t *p, linked_list_node_t *node);
+
 typedef struct linked_list {
   size_t length;
   linked_list_node_t *head;
   linked_list_node_t *tail;
   void (*inner_free)(void *);
   void (*outer_free)(void (*)(void *), void *);
+  linked_list_pool_t *pool;
+  bool owns_pool;
 } linked_list_t;
 
 cutils_error_t linked_list_init(linked_list_t *l, void (*inner_free)(void *),
                                 void (*outer_free)(void (*)(void *), void *));
+// Allocates nodes from `pool`, or from a private pool when `pool` is NULL.
+// A private pool is released slab by slab in linked_list_free.
+cutils_error_t linked_list_init_pooled(linked_list_t *l,
+                                       linked_list_pool_t *pool,
+                                       void (*inner_free)(void *),
+                                       void (*outer_free)(void (*)(void *),
+                                                          void *));
 void linked_list_free(void *ptr);
 void linked_list_free_value(linked_list_t *l, linked_list_node_t *node);
 cutils_error_t linked_list_insert_at(linked_list_t *l, size_t idx, void *value);
@@ -38,4 +62,53 @@ cutils_error_t linked_list_set(linked_list_t *l, size_t idx, void *value);
 cutils_error_t linked_list_find(linked_list_t *l, void *value,
                                 bool (*cmp)(void *, void *), size_t *idx);
 
+// O(1) operations on a known node. A NULL `node` stands for the position past
+// the tail, so inserting before it appends and inserting after it prepends.
+cutils_error_t linked_list_insert_before(linked_list_t *l,
+                                         linked_list_node_t *node,
+                                         void *value);
+cutils_error_t linked_list_insert_after(linked_list_t *l,
+                                        linked_list_node_t *node,
+                                        void *value);
+cutils_error_t linked_list_remove_node(linked_list_t *l,
+                                       linked_list_node_t *node,
+                                       void **value);
+
+// Whole-list operations relink existing nodes and never allocate. Nodes can
+// only move between lists that release them the same way: both unpooled, or
+// both on the same shared pool. Otherwise they fail with CUTILS_POOL_ERROR.
+// Stable merge sort, O(n log n) with O(1) extra space.
+cutils_error_t linked_list_sort(linked_list_t *l, int (*cmp)(void *, void *));
+// Moves every node of `src` in front of `pos` in `dst` (NULL appends),
+// leaving `src` empty.
+cutils_error_t linked_list_splice(linked_list_t *dst, linked_list_node_t *pos,
+                                  linked_list_t *src);
+cutils_error_t linked_list_concat(linked_list_t *dst, linked_list_t *src);
+// Appends the union of `k` sorted lists to `dst` in sorted order, emptying
+// them. Ties keep the order of `srcs`. O(n log k).
+cutils_error_t linked_list_merge(linked_list_t *dst, linked_list_t **srcs,
+                                 size_t k, int (*cmp)(void *, void *));
+
+// Points at a node of `list` along with its index; a NULL `node` is the
+// position past the tail.
+typedef struct linked_list_cursor {
+  linked_list_t *list;
+  linked_list_node_t *node;
+  size_t idx;
+} linked_list_cursor_t;
+
+cutils_error_t linked_list_cursor_init(linked_list_cursor_t *c,
+                                       linked_list_t *l);
+bool linked_list_cursor_valid(linked_list_cursor_t *c);
+cutils_error_t linked_list_cursor_next(linked_list_cursor_t *c);
+cutils_error_t linked_list_cursor_prev(linked_list_cursor_t *c);
+cutils_error_t linked_list_cursor_get(linked_list_cursor_t *c, void **value);
+cutils_error_t linked_list_cursor_set(linked_list_cursor_t *c, void *value);
+// Inserts in front of the cursor, which keeps pointing at the same node.
+cutils_error_t linked_list_cursor_insert(linked_list_cursor_t *c,
+                                         void *value);
+// Removes the node under the cursor and moves the cursor to its successor.
+cutils_error_t linked_list_cursor_remove(linked_list_cursor_t *c,
+                                         void **value);
+
 #endif // __CUTILS_LINKED_LIST_H__
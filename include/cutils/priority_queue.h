@@ -0,0 +1,69 @@
+#ifndef __CUTILS_PRIORITY_QUEUE_H__
+#define __CUTILS_PRIORITY_QUEUE_H__
+
+#include "cutils/array_list.h"
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Children per node when 0 is passed as the arity. Four children of pointer
+// size share half a cache line, and the heap is half as deep as a binary one.
+#define PRIORITY_QUEUE_DEFAULT_ARITY 4
+
+// d-ary min-heap over an array_list_t, ordered by a three-way comparator.
+// When `set_index` is given it is told every value's new position as the
+// value moves, and that position is the handle for update and remove.
+typedef struct priority_queue {
+  size_t arity;
+  array_list_t *items;
+  int (*cmp)(void *, void *);
+  void (*set_index)(void *, size_t);
+} priority_queue_t;
+
+cutils_error_t priority_queue_init(priority_queue_t *q, size_t arity,
+                                   int (*cmp)(void *, void *),
+                                   void (*set_index)(void *, size_t),
+                                   void (*inner_free)(void *),
+                                   void (*outer_free)(void (*)(void *),
+                                                      void *));
+// Takes ownership of `l` as the heap's storage and heapifies it in O(n).
+cutils_error_t priority_queue_init_from(priority_queue_t *q, array_list_t *l,
+                                        size_t arity,
+                                        int (*cmp)(void *, void *),
+                                        void (*set_index)(void *, size_t));
+void priority_queue_free(void *ptr);
+cutils_error_t priority_queue_push(priority_queue_t *q, void *value);
+cutils_error_t priority_queue_pop(priority_queue_t *q, void **value);
+cutils_error_t priority_queue_peek(priority_queue_t *q, void **value);
+// Restores heap order after the priority of the value at `idx` changed, in
+// either direction.
+cutils_error_t priority_queue_update(priority_queue_t *q, size_t idx);
+cutils_error_t priority_queue_remove(priority_queue_t *q, size_t idx,
+                                     void **value);
+
+// Inline (priority, payload) pairs, smallest priority first. Entries are
+// stored by value, so sifting never dereferences a payload.
+typedef struct priority_queue_entry {
+  uint64_t priority;
+  void *payload;
+} priority_queue_entry_t;
+
+typedef struct priority_queue_u64 {
+  size_t length;
+  size_t capacity;
+  size_t arity;
+  priority_queue_entry_t *entries;
+} priority_queue_u64_t;
+
+cutils_error_t priority_queue_u64_init(priority_queue_u64_t *q, size_t arity,
+                                       size_t capacity);
+void priority_queue_u64_free(void *ptr);
+cutils_error_t priority_queue_u64_push(priority_queue_u64_t *q,
+                                       uint64_t priority, void *payload);
+cutils_error_t priority_queue_u64_pop(priority_queue_u64_t *q,
+                                      uint64_t *priority, void **payload);
+cutils_error_t priority_queue_u64_peek(priority_queue_u64_t *q,
+                                       uint64_t *priority, void **payload);
+
+#endif // __CUTILS_PRIORITY_QUEUE_H__
@@ -0,0 +1,52 @@
+#ifndef __CUTILS_SEGMENTED_LIST_H__
+#define __CUTILS_SEGMENTED_LIST_H__
+
+#include "cutils/errors.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Segment k holds 2^(k + SEGMENTED_LIST_FIRST_SHIFT) values, so segments are
+// never reallocated and element addresses stay valid for the list's lifetime.
+#define SEGMENTED_LIST_FIRST_SHIFT 4
+#define SEGMENTED_LIST_MAX_SEGMENTS (64 - SEGMENTED_LIST_FIRST_SHIFT)
+
+// A value is only read once `written` is set, so pushes can publish their
+// slots in any order.
+typedef struct segmented_list_slot {
+  void *value;
+  atomic_bool written;
+} segmented_list_slot_t;
+
+typedef struct segmented_list {
+  atomic_size_t length;   // Published values
+  atomic_size_t reserved; // Positions handed out to pushes
+  _Atomic(segmented_list_slot_t *) segments[SEGMENTED_LIST_MAX_SEGMENTS];
+  void (*inner_free)(void *);
+  void (*outer_free)(void (*)(void *), void *);
+} segmented_list_t;
+
+cutils_error_t segmented_list_init(segmented_list_t *l,
+                                   void (*inner_free)(void *),
+                                   void (*outer_free)(void (*)(void *),
+                                                      void *));
+void segmented_list_free(void *ptr);
+// Lock-free: a push claims the next position and publishes its own slot
+// without waiting on any other push. `idx` (optional) receives the position
+// of the pushed value.
+//
+// Until a push returns, its position reads as missing and the others may
+// already be visible past it. A push that fails to allocate its segment
+// leaves its position missing for good.
+cutils_error_t segmented_list_push(segmented_list_t *l, void *value,
+                                   size_t *idx);
+// These fail with CUTILS_INDEX_ERROR for positions not yet published.
+cutils_error_t segmented_list_get(segmented_list_t *l, size_t idx,
+                                  void **value);
+cutils_error_t segmented_list_set(segmented_list_t *l, size_t idx,
+                                  void *value);
+cutils_error_t segmented_list_ref(segmented_list_t *l, size_t idx,
+                                  void ***ref);
+
+#endif // __CUTILS_SEGMENTED_LIST_H__
@@ -0,0 +1,54 @@
+#ifndef __CUTILS_SKIP_LIST_H__
+#define __CUTILS_SKIP_LIST_H__
+
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define SKIP_LIST_MAX_LEVEL 32
+
+typedef struct skip_list_node {
+  void *key;
+  void *value;
+  size_t level;
+  struct skip_list_node *next[];
+} skip_list_node_t;
+
+// Ordered map keyed by a three-way comparator returning <0, 0 or >0.
+typedef struct skip_list {
+  size_t length;
+  size_t level;
+  uint64_t seed;
+  skip_list_node_t *head;
+  int (*cmp)(void *, void *);
+  void (*key_free)(void *);
+  void (*inner_free)(void *);
+} skip_list_t;
+
+typedef struct skip_list_iter {
+  skip_list_node_t *node;
+} skip_list_iter_t;
+
+cutils_error_t skip_list_init(skip_list_t *s, int (*cmp)(void *, void *),
+                              void (*key_free)(void *),
+                              void (*inner_free)(void *));
+void skip_list_free(void *ptr);
+cutils_error_t skip_list_insert(skip_list_t *s, void *key, void *value);
+cutils_error_t skip_list_remove(skip_list_t *s, void *key, void **value);
+cutils_error_t skip_list_get(skip_list_t *s, void *key, void **value);
+// Greatest entry with a key <= `key`, and least entry with a key >= `key`.
+cutils_error_t skip_list_floor(skip_list_t *s, void *key, void **found,
+                               void **value);
+cutils_error_t skip_list_ceiling(skip_list_t *s, void *key, void **found,
+                                 void **value);
+
+// Positions `it` at the first entry with a key >= `key`, or at the first
+// entry when `key` is NULL.
+cutils_error_t skip_list_seek(skip_list_t *s, void *key, skip_list_iter_t *it);
+bool skip_list_iter_valid(skip_list_iter_t *it);
+cutils_error_t skip_list_iter_next(skip_list_iter_t *it);
+cutils_error_t skip_list_iter_get(skip_list_iter_t *it, void **key,
+                                  void **value);
+
+#endif // __CUTILS_SKIP_LIST_H__
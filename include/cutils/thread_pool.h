@@ -0,0 +1,30 @@
+#ifndef __CUTILS_THREAD_POOL_H__
+#define __CUTILS_THREAD_POOL_H__
+
+#include "cutils/errors.h"
+#include "cutils/linked_list.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+typedef struct thread_pool {
+  size_t nthreads;
+  size_t pending;
+  bool stopping;
+  pthread_t *threads;
+  linked_list_t *tasks;
+  pthread_mutex_t lock;
+  pthread_cond_t task_ready;
+  pthread_cond_t task_done;
+} thread_pool_t;
+
+// A `nthreads` of 0 sizes the pool to the number of online CPUs.
+cutils_error_t thread_pool_init(thread_pool_t *p, size_t nthreads);
+void thread_pool_free(void *ptr);
+cutils_error_t thread_pool_submit(thread_pool_t *p, void (*fn)(void *),
+                                  void *arg);
+// Blocks until every submitted task has finished; must not be called from
+// inside a task.
+cutils_error_t thread_pool_wait(thread_pool_t *p);
+
+#endif // __CUTILS_THREAD_POOL_H__
@@ -0,0 +1,54 @@
+#ifndef __CUTILS_TIMER_WHEEL_H__
+#define __CUTILS_TIMER_WHEEL_H__
+
+#include "cutils/errors.h"
+#include "cutils/intrusive_list.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Each level has 2^TIMER_WHEEL_BITS slots, and a slot on level k spans
+// 2^(k * TIMER_WHEEL_BITS) ticks. Deadlines further out than the top level
+// reaches park in its last slot and are placed again as it comes round.
+#define TIMER_WHEEL_BITS 8
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+// Embedded in a user struct, which the wheel never allocates or frees; the
+// embedding struct is recovered with INTRUSIVE_LIST_ENTRY on `link`. The
+// timer itself is the handle for cancelling or re-arming it.
+typedef struct timer_wheel_timer {
+  intrusive_list_link_t link;
+  intrusive_list_t *slot;
+  uint64_t deadline;
+} timer_wheel_timer_t;
+
+// Hierarchical timing wheel counting time in caller-defined ticks.
+typedef struct timer_wheel {
+  uint64_t now;
+  size_t length;
+  size_t counts[TIMER_WHEEL_LEVELS];
+  intrusive_list_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+} timer_wheel_t;
+
+cutils_error_t timer_wheel_init(timer_wheel_t *w, uint64_t now);
+// Frees the wheel only; timers still armed are left dangling in their slots.
+void timer_wheel_free(void *ptr);
+
+cutils_error_t timer_wheel_timer_init(timer_wheel_timer_t *t);
+bool timer_wheel_timer_armed(timer_wheel_timer_t *t);
+
+// Arms `t` to expire once time reaches `deadline`, in O(1). An armed timer is
+// moved to the new deadline; a deadline already passed expires on the next
+// tick.
+cutils_error_t timer_wheel_add(timer_wheel_t *w, timer_wheel_timer_t *t,
+                               uint64_t deadline);
+// O(1); fails with CUTILS_INDEX_ERROR when `t` is not armed.
+cutils_error_t timer_wheel_cancel(timer_wheel_t *w, timer_wheel_timer_t *t);
+// Moves time forward to `now`, appending every timer that expires to
+// `expired` a whole slot at a time, in tick order. Expired timers are no
+// longer armed and must be taken off `expired` before being added again.
+cutils_error_t timer_wheel_advance(timer_wheel_t *w, uint64_t now,
+                                   intrusive_list_t *expired);
+
+#endif // __CUTILS_TIMER_WHEEL_H__
@@ -0,0 +1,48 @@
+#ifndef __CUTILS_UNROLLED_LIST_H__
+#define __CUTILS_UNROLLED_LIST_H__
+
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Sized so that a node fills eight 64-byte cache lines.
+#define UNROLLED_LIST_NODE_CAPACITY                                            \
+  ((512 - 3 * sizeof(void *)) / sizeof(void *))
+
+typedef struct unrolled_list_node {
+  struct unrolled_list_node *prev;
+  struct unrolled_list_node *next;
+  size_t count;
+  void *values[UNROLLED_LIST_NODE_CAPACITY];
+} unrolled_list_node_t;
+
+typedef struct unrolled_list {
+  size_t length;
+  size_t nnodes;
+  unrolled_list_node_t *head;
+  unrolled_list_node_t *tail;
+  void (*inner_free)(void *);
+  void (*outer_free)(void (*)(void *), void *);
+} unrolled_list_t;
+
+cutils_error_t unrolled_list_init(unrolled_list_t *l,
+                                  void (*inner_free)(void *),
+                                  void (*outer_free)(void (*)(void *),
+                                                     void *));
+void unrolled_list_free(void *ptr);
+cutils_error_t unrolled_list_insert_at(unrolled_list_t *l, size_t idx,
+                                       void *value);
+cutils_error_t unrolled_list_push_front(unrolled_list_t *l, void *value);
+cutils_error_t unrolled_list_push_back(unrolled_list_t *l, void *value);
+cutils_error_t unrolled_list_remove_at(unrolled_list_t *l, size_t idx,
+                                       void **value);
+cutils_error_t unrolled_list_pop_front(unrolled_list_t *l, void **value);
+cutils_error_t unrolled_list_pop_back(unrolled_list_t *l, void **value);
+cutils_error_t unrolled_list_get(unrolled_list_t *l, size_t idx,
+                                 void **value);
+cutils_error_t unrolled_list_set(unrolled_list_t *l, size_t idx, void *value);
+cutils_error_t unrolled_list_find(unrolled_list_t *l, void *value,
+                                  bool (*cmp)(void *, void *), size_t *idx);
+
+#endif // __CUTILS_UNROLLED_LIST_H__
@@ -1,7 +1,79 @@
+#define _GNU_SOURCE
 #include "cutils/array_list.h"
 #include "cutils/errors.h"
+#include "cutils/thread_pool.h"
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define INSERTION_SORT_THRESHOLD 16
+
+static size_t _page_size(void) {
+  long page = sysconf(_SC_PAGESIZE);
+  return page > 0 ? (size_t)page : 4096;
+}
+
+static void _advise_huge_pages(array_list_t *l) {
+#ifdef MADV_HUGEPAGE
+  if (l->huge_pages) {
+    madvise(l->backing, sizeof(void *) * l->capacity, MADV_HUGEPAGE);
+  }
+#else
+  (void)l;
+#endif
+}
+
+// Resizes the backing store to hold `capacity` values. Large stores are moved
+// into an anonymous mapping once, after which mremap can extend them by
+// remapping pages rather than copying them.
+static cutils_error_t _reserve(array_list_t *l, size_t capacity) {
+  if (capacity > SIZE_MAX / sizeof(void *)) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  size_t bytes = sizeof(void *) * capacity;
+  if (bytes < ARRAY_LIST_MMAP_THRESHOLD && !l->mapped) {
+    void **update = realloc(l->backing, bytes);
+    if (!update) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+    l->backing = update;
+    l->capacity = capacity;
+    return CUTILS_SUCCESS;
+  }
+
+  size_t page = _page_size();
+  bytes = (bytes + page - 1) / page * page;
+
+  void *update = NULL;
+  if (l->mapped) {
+    update = mremap(l->backing, sizeof(void *) * l->capacity, bytes,
+                    MREMAP_MAYMOVE);
+    if (update == MAP_FAILED) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+  } else {
+    update = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (update == MAP_FAILED) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+    if (l->backing) {
+      memcpy(update, l->backing, sizeof(void *) * l->length);
+    }
+    free(l->backing);
+  }
+
+  l->backing = update;
+  l->capacity = bytes / sizeof(void *);
+  l->mapped = true;
+  _advise_huge_pages(l);
+
+  return CUTILS_SUCCESS;
+}
 
 cutils_error_t array_list_init(array_list_t *l, size_t capacity,
                                void (*inner_free)(void *),
@@ -11,11 +83,13 @@ cutils_error_t array_list_init(array_list_t *l, size_t capacity,
   }
 
   l->length = 0;
-  l->capacity = capacity;
+  l->capacity = 0;
   l->inner_free = inner_free;
   l->outer_free = outer_free;
-  l->backing = malloc(sizeof(void *) * l->capacity);
-  if (!l->backing) {
+  l->mapped = false;
+  l->huge_pages = false;
+  l->backing = NULL;
+  if (_reserve(l, capacity) != CUTILS_SUCCESS) {
     free(l);
     return CUTILS_ALLOCATION_ERROR;
   }
@@ -29,7 +103,11 @@ void array_list_free(void *ptr) {
     for (size_t i = 0; i < l->length; i++) {
       array_list_free_value(l, i);
     }
-    free(l->backing);
+    if (l->mapped) {
+      munmap(l->backing, sizeof(void *) * l->capacity);
+    } else {
+      free(l->backing);
+    }
     free(l);
   }
 }
@@ -53,13 +131,27 @@ cutils_error_t array_list_grow(array_list_t *l, size_t capacity) {
     return CUTILS_RESIZE_ERROR;
   }
 
-  void **update = realloc(l->backing, sizeof(void *) * capacity);
-  if (!update) {
-    return CUTILS_ALLOCATION_ERROR;
+  return _reserve(l, capacity);
+}
+
+cutils_error_t array_list_shrink(array_list_t *l) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
   }
 
-  l->capacity = capacity;
-  l->backing = update;
+  if (!l->mapped) {
+    size_t capacity = l->length > 0 ? l->length : 1;
+    return capacity < l->capacity ? _reserve(l, capacity) : CUTILS_SUCCESS;
+  }
+
+  // Keep the address range reserved so regrowth is free, but hand every page
+  // past the last value back to the kernel
+  size_t page = _page_size();
+  size_t used = (sizeof(void *) * l->length + page - 1) / page * page;
+  size_t bytes = sizeof(void *) * l->capacity;
+  if (used < bytes) {
+    madvise((char *)l->backing + used, bytes - used, MADV_DONTNEED);
+  }
 
   return CUTILS_SUCCESS;
 }
@@ -167,3 +259,351 @@ cutils_error_t array_list_find(array_list_t *l, void *value,
 
   return CUTILS_SUCCESS;
 }
+
+static void _swap(void **a, size_t i, size_t j) {
+  void *tmp = a[i];
+  a[i] = a[j];
+  a[j] = tmp;
+}
+
+static void _insertion_sort(void **a, size_t n, int (*cmp)(void *, void *)) {
+  for (size_t i = 1; i < n; i++) {
+    void *value = a[i];
+    size_t j = i;
+    while (j > 0 && cmp(a[j - 1], value) > 0) {
+      a[j] = a[j - 1];
+      j--;
+    }
+    a[j] = value;
+  }
+}
+
+static void _sift_down(void **a, size_t root, size_t n,
+                       int (*cmp)(void *, void *)) {
+  for (;;) {
+    size_t child = 2 * root + 1;
+    if (child >= n) {
+      return;
+    }
+    if (child + 1 < n && cmp(a[child], a[child + 1]) < 0) {
+      child++;
+    }
+    if (cmp(a[root], a[child]) >= 0) {
+      return;
+    }
+    _swap(a, root, child);
+    root = child;
+  }
+}
+
+static void _heap_sort(void **a, size_t n, int (*cmp)(void *, void *)) {
+  for (size_t i = n / 2; i > 0; i--) {
+    _sift_down(a, i - 1, n, cmp);
+  }
+  for (size_t i = n - 1; i > 0; i--) {
+    _swap(a, 0, i);
+    _sift_down(a, 0, i, cmp);
+  }
+}
+
+static void _intro_sort(void **a, size_t n, size_t depth,
+                        int (*cmp)(void *, void *)) {
+  while (n > INSERTION_SORT_THRESHOLD) {
+    if (depth == 0) {
+      _heap_sort(a, n, cmp);
+      return;
+    }
+    depth--;
+
+    // Median-of-three leaves sentinels at both ends for the Hoare scans
+    size_t mid = (n - 1) / 2;
+    if (cmp(a[mid], a[0]) < 0) {
+      _swap(a, mid, 0);
+    }
+    if (cmp(a[n - 1], a[mid]) < 0) {
+      _swap(a, n - 1, mid);
+      if (cmp(a[mid], a[0]) < 0) {
+        _swap(a, mid, 0);
+      }
+    }
+    void *pivot = a[mid];
+
+    size_t i = 0;
+    size_t j = n - 1;
+    for (;;) {
+      while (cmp(a[i], pivot) < 0) {
+        i++;
+      }
+      while (cmp(a[j], pivot) > 0) {
+        j--;
+      }
+      if (i >= j) {
+        break;
+      }
+      _swap(a, i, j);
+      i++;
+      j--;
+    }
+
+    // Recurse into the smaller half to bound stack depth
+    size_t left = j + 1;
+    if (left < n - left) {
+      _intro_sort(a, left, depth, cmp);
+      a += left;
+      n -= left;
+    } else {
+      _intro_sort(a + left, n - left, depth, cmp);
+      n = left;
+    }
+  }
+  _insertion_sort(a, n, cmp);
+}
+
+static size_t _depth_limit(size_t n) {
+  size_t depth = 0;
+  while (n > 1) {
+    n >>= 1;
+    depth += 2;
+  }
+  return depth;
+}
+
+static void _merge(void **a, size_t mid, size_t n, void **tmp,
+                   int (*cmp)(void *, void *)) {
+  memcpy(tmp, a, sizeof(void *) * mid);
+
+  size_t i = 0;
+  size_t j = mid;
+  size_t k = 0;
+  while (i < mid && j < n) {
+    if (cmp(a[j], tmp[i]) < 0) {
+      a[k++] = a[j++];
+    } else {
+      a[k++] = tmp[i++];
+    }
+  }
+  while (i < mid) {
+    a[k++] = tmp[i++];
+  }
+}
+
+static void _merge_sort(void **a, size_t n, void **tmp,
+                        int (*cmp)(void *, void *)) {
+  if (n <= INSERTION_SORT_THRESHOLD) {
+    _insertion_sort(a, n, cmp);
+    return;
+  }
+
+  size_t mid = n / 2;
+  _merge_sort(a, mid, tmp, cmp);
+  _merge_sort(a + mid, n - mid, tmp, cmp);
+  if (cmp(a[mid - 1], a[mid]) > 0) {
+    _merge(a, mid, n, tmp, cmp);
+  }
+}
+
+cutils_error_t array_list_sort(array_list_t *l, int (*cmp)(void *, void *)) {
+  if (!l || !cmp) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  _intro_sort(l->backing, l->length, _depth_limit(l->length), cmp);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_stable_sort(array_list_t *l,
+                                      int (*cmp)(void *, void *)) {
+  if (!l || !cmp) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (l->length <= INSERTION_SORT_THRESHOLD) {
+    _insertion_sort(l->backing, l->length, cmp);
+    return CUTILS_SUCCESS;
+  }
+
+  void **tmp = malloc(sizeof(void *) * (l->length / 2));
+  if (!tmp) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  _merge_sort(l->backing, l->length, tmp, cmp);
+  free(tmp);
+
+  return CUTILS_SUCCESS;
+}
+
+typedef struct {
+  void **src;
+  void **dst;
+  size_t begin;
+  size_t mid;
+  size_t end;
+  int (*cmp)(void *, void *);
+} sort_task_t;
+
+static void _sort_chunk(void *arg) {
+  sort_task_t *t = arg;
+  size_t n = t->end - t->begin;
+  _intro_sort(t->src + t->begin, n, _depth_limit(n), t->cmp);
+}
+
+static void _merge_chunks(void *arg) {
+  sort_task_t *t = arg;
+  size_t i = t->begin;
+  size_t j = t->mid;
+  size_t k = t->begin;
+  while (i < t->mid && j < t->end) {
+    if (t->cmp(t->src[j], t->src[i]) < 0) {
+      t->dst[k++] = t->src[j++];
+    } else {
+      t->dst[k++] = t->src[i++];
+    }
+  }
+  memcpy(&t->dst[k], &t->src[i], sizeof(void *) * (t->mid - i));
+  k += t->mid - i;
+  memcpy(&t->dst[k], &t->src[j], sizeof(void *) * (t->end - j));
+}
+
+cutils_error_t array_list_parallel_sort(array_list_t *l,
+                                        int (*cmp)(void *, void *),
+                                        thread_pool_t *pool) {
+  if (!l || !cmp) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!pool || pool->nthreads < 2 ||
+      l->length < ARRAY_LIST_PARALLEL_SORT_THRESHOLD) {
+    return array_list_sort(l, cmp);
+  }
+
+  size_t nchunks = pool->nthreads;
+  size_t *bounds = malloc(sizeof(size_t) * (nchunks + 1));
+  sort_task_t *tasks = malloc(sizeof(sort_task_t) * nchunks);
+  void **tmp = malloc(sizeof(void *) * l->length);
+  if (!bounds || !tasks || !tmp) {
+    free(bounds);
+    free(tasks);
+    free(tmp);
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  for (size_t i = 0; i <= nchunks; i++) {
+    bounds[i] = l->length * i / nchunks;
+  }
+
+  cutils_error_t err = CUTILS_SUCCESS;
+  for (size_t i = 0; i < nchunks; i++) {
+    tasks[i] = (sort_task_t){l->backing, NULL, bounds[i], 0, bounds[i + 1],
+                             cmp};
+    if (err == CUTILS_SUCCESS) {
+      err = thread_pool_submit(pool, _sort_chunk, &tasks[i]);
+    }
+    if (err != CUTILS_SUCCESS) {
+      _sort_chunk(&tasks[i]);
+    }
+  }
+  thread_pool_wait(pool);
+
+  // Merge neighbouring runs pairwise, ping-ponging between the two buffers
+  void **src = l->backing;
+  void **dst = tmp;
+  while (nchunks > 1) {
+    size_t nmerged = 0;
+    for (size_t i = 0; i < nchunks; i += 2) {
+      size_t end = i + 2 <= nchunks ? bounds[i + 2] : bounds[i + 1];
+      size_t mid = i + 2 <= nchunks ? bounds[i + 1] : end;
+      tasks[nmerged] = (sort_task_t){src, dst, bounds[i], mid, end, cmp};
+      if (err == CUTILS_SUCCESS) {
+        err = thread_pool_submit(pool, _merge_chunks, &tasks[nmerged]);
+      }
+      if (err != CUTILS_SUCCESS) {
+        _merge_chunks(&tasks[nmerged]);
+      }
+      bounds[nmerged++] = bounds[i];
+    }
+    thread_pool_wait(pool);
+    bounds[nmerged] = l->length;
+    nchunks = nmerged;
+
+    void **swap = src;
+    src = dst;
+    dst = swap;
+  }
+
+  if (src != l->backing) {
+    memcpy(l->backing, src, sizeof(void *) * l->length);
+  }
+
+  free(bounds);
+  free(tasks);
+  free(tmp);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_lower_bound(array_list_t *l, void *value,
+                                      int (*cmp)(void *, void *), size_t *idx) {
+  if (!l || !cmp || !idx) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t lo = 0;
+  size_t n = l->length;
+  while (n > 0) {
+    size_t half = n / 2;
+    if (cmp(l->backing[lo + half], value) < 0) {
+      lo += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  *idx = lo;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_upper_bound(array_list_t *l, void *value,
+                                      int (*cmp)(void *, void *), size_t *idx) {
+  if (!l || !cmp || !idx) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t lo = 0;
+  size_t n = l->length;
+  while (n > 0) {
+    size_t half = n / 2;
+    if (cmp(l->backing[lo + half], value) <= 0) {
+      lo += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  *idx = lo;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_binary_search(array_list_t *l, void *value,
+                                        int (*cmp)(void *, void *),
+                                        size_t *idx) {
+  if (!idx) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t lo = 0;
+  cutils_error_t err = array_list_lower_bound(l, value, cmp, &lo);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  if (lo == l->length || cmp(l->backing[lo], value) != 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+  *idx = lo;
+
+  return CUTILS_SUCCESS;
+}
@@ -0,0 +1,232 @@
+#include "cutils/array_list.h"
+#include "cutils/errors.h"
+#include "cutils/thread_pool.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+typedef struct {
+  atomic_size_t next;
+  size_t end;
+} chunk_range_t;
+
+typedef struct job job_t;
+
+typedef struct {
+  job_t *job;
+  size_t id;
+  void *partial;
+} worker_t;
+
+struct job {
+  array_list_t *l;
+  size_t nchunks;
+  size_t nworkers;
+  chunk_range_t *ranges;
+  worker_t *workers;
+  void (*run)(worker_t *, size_t, size_t);
+
+  void (*for_fn)(void *, size_t, void *);
+  void *(*map_fn)(void *, void *);
+  void *(*reduce_fn)(void *, void *, void *);
+  void *(*combine)(void *, void *, void *);
+  void *ctx;
+  void *init;
+  void **out;
+  void **partials;
+};
+
+static bool _next_chunk(chunk_range_t *range, size_t *chunk) {
+  if (atomic_load_explicit(&range->next, memory_order_relaxed) >= range->end) {
+    return false;
+  }
+  *chunk = atomic_fetch_add_explicit(&range->next, 1, memory_order_relaxed);
+  return *chunk < range->end;
+}
+
+static void _work(void *arg) {
+  worker_t *w = arg;
+  job_t *job = w->job;
+
+  // Drain our own range first, then steal from the others in turn
+  for (size_t k = 0; k < job->nworkers; k++) {
+    chunk_range_t *range = &job->ranges[(w->id + k) % job->nworkers];
+    size_t chunk = 0;
+    while (_next_chunk(range, &chunk)) {
+      job->run(w, chunk, chunk * ARRAY_LIST_PARALLEL_CHUNK);
+    }
+  }
+}
+
+static size_t _chunk_end(job_t *job, size_t begin) {
+  size_t end = begin + ARRAY_LIST_PARALLEL_CHUNK;
+  return end < job->l->length ? end : job->l->length;
+}
+
+static void _run_for(worker_t *w, size_t chunk, size_t begin) {
+  job_t *job = w->job;
+  (void)chunk;
+  for (size_t i = begin; i < _chunk_end(job, begin); i++) {
+    job->for_fn(job->l->backing[i], i, job->ctx);
+  }
+}
+
+static void _run_map(worker_t *w, size_t chunk, size_t begin) {
+  job_t *job = w->job;
+  (void)chunk;
+  for (size_t i = begin; i < _chunk_end(job, begin); i++) {
+    job->out[i] = job->map_fn(job->l->backing[i], job->ctx);
+  }
+}
+
+static void _run_reduce(worker_t *w, size_t chunk, size_t begin) {
+  job_t *job = w->job;
+  void *acc = job->partials ? job->init : w->partial;
+  for (size_t i = begin; i < _chunk_end(job, begin); i++) {
+    acc = job->reduce_fn(acc, job->l->backing[i], job->ctx);
+  }
+
+  if (job->partials) {
+    job->partials[chunk] = acc;
+  } else {
+    w->partial = acc;
+  }
+}
+
+// Runs the job to completion. On success the caller owns job->workers, which
+// carry the per-worker partials for unordered reductions.
+static cutils_error_t _execute(job_t *job, thread_pool_t *pool) {
+  job->nchunks = (job->l->length + ARRAY_LIST_PARALLEL_CHUNK - 1) /
+                 ARRAY_LIST_PARALLEL_CHUNK;
+  job->nworkers = pool ? pool->nthreads : 1;
+  if (job->nworkers > job->nchunks) {
+    job->nworkers = job->nchunks > 0 ? job->nchunks : 1;
+  }
+
+  job->ranges = malloc(sizeof(chunk_range_t) * job->nworkers);
+  job->workers = malloc(sizeof(worker_t) * job->nworkers);
+  if (!job->ranges || !job->workers) {
+    free(job->ranges);
+    free(job->workers);
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  for (size_t i = 0; i < job->nworkers; i++) {
+    atomic_init(&job->ranges[i].next, job->nchunks * i / job->nworkers);
+    job->ranges[i].end = job->nchunks * (i + 1) / job->nworkers;
+    job->workers[i] = (worker_t){job, i, job->init};
+  }
+
+  bool submitted = false;
+  for (size_t i = 0; pool && i < job->nworkers; i++) {
+    if (thread_pool_submit(pool, _work, &job->workers[i]) == CUTILS_SUCCESS) {
+      submitted = true;
+    }
+  }
+
+  if (submitted) {
+    thread_pool_wait(pool);
+  }
+
+  // Anything left unclaimed (no pool, or failed submissions) runs here
+  _work(&job->workers[0]);
+
+  free(job->ranges);
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_parallel_for(array_list_t *l,
+                                       void (*fn)(void *, size_t, void *),
+                                       void *ctx, thread_pool_t *pool) {
+  if (!l || !fn) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  job_t job = {.l = l, .run = _run_for, .for_fn = fn, .ctx = ctx};
+  cutils_error_t err = _execute(&job, pool);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+  free(job.workers);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_parallel_map(array_list_t *l, array_list_t *out,
+                                       void *(*fn)(void *, void *), void *ctx,
+                                       thread_pool_t *pool) {
+  if (!l || !out || !fn) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (out->length + l->length > out->capacity) {
+    cutils_error_t err = array_list_grow(out, out->length + l->length);
+    if (err != CUTILS_SUCCESS) {
+      return err;
+    }
+  }
+
+  job_t job = {.l = l,
+               .run = _run_map,
+               .map_fn = fn,
+               .ctx = ctx,
+               .out = &out->backing[out->length]};
+  cutils_error_t err = _execute(&job, pool);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+  free(job.workers);
+  out->length += l->length;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_parallel_reduce(array_list_t *l, void *init,
+                                          void *(*fn)(void *, void *, void *),
+                                          void *(*combine)(void *, void *,
+                                                           void *),
+                                          void *ctx, bool ordered,
+                                          thread_pool_t *pool, void **result) {
+  if (!l || !fn || !combine || !result) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t nchunks =
+      (l->length + ARRAY_LIST_PARALLEL_CHUNK - 1) / ARRAY_LIST_PARALLEL_CHUNK;
+  job_t job = {.l = l,
+               .run = _run_reduce,
+               .reduce_fn = fn,
+               .combine = combine,
+               .ctx = ctx,
+               .init = init};
+  if (ordered && nchunks > 0) {
+    job.partials = malloc(sizeof(void *) * nchunks);
+    if (!job.partials) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+  }
+
+  cutils_error_t err = _execute(&job, pool);
+  if (err != CUTILS_SUCCESS) {
+    free(job.partials);
+    return err;
+  }
+
+  void *acc = init;
+  if (job.partials) {
+    for (size_t i = 0; i < job.nchunks; i++) {
+      acc = combine(acc, job.partials[i], ctx);
+    }
+  } else {
+    for (size_t i = 0; i < job.nworkers; i++) {
+      acc = combine(acc, job.workers[i].partial, ctx);
+    }
+  }
+  *result = acc;
+
+  free(job.partials);
+  free(job.workers);
+
+  return CUTILS_SUCCESS;
+}
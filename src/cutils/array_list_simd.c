@@ -0,0 +1,299 @@
+#include "cutils/array_list.h"
+#include "cutils/errors.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define ARRAY_LIST_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+typedef struct {
+  size_t (*find)(void **a, size_t n, void *value);
+  size_t (*count)(void **a, size_t n, void *value);
+  intptr_t (*min)(void **a, size_t n);
+  intptr_t (*max)(void **a, size_t n);
+} kernels_t;
+
+static size_t _find_scalar(void **a, size_t n, void *value) {
+  for (size_t i = 0; i < n; i++) {
+    if (a[i] == value) {
+      return i;
+    }
+  }
+  return n;
+}
+
+static size_t _count_scalar(void **a, size_t n, void *value) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    count += a[i] == value;
+  }
+  return count;
+}
+
+static intptr_t _min_scalar(void **a, size_t n) {
+  intptr_t m = (intptr_t)a[0];
+  for (size_t i = 1; i < n; i++) {
+    intptr_t x = (intptr_t)a[i];
+    m = x < m ? x : m;
+  }
+  return m;
+}
+
+static intptr_t _max_scalar(void **a, size_t n) {
+  intptr_t m = (intptr_t)a[0];
+  for (size_t i = 1; i < n; i++) {
+    intptr_t x = (intptr_t)a[i];
+    m = x > m ? x : m;
+  }
+  return m;
+}
+
+#ifdef ARRAY_LIST_X86_SIMD
+
+__attribute__((target("avx2"))) static size_t _find_avx2(void **a, size_t n,
+                                                         void *value) {
+  __m256i needle = _mm256_set1_epi64x((long long)(intptr_t)value);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i x0 = _mm256_loadu_si256((const __m256i *)&a[i]);
+    __m256i x1 = _mm256_loadu_si256((const __m256i *)&a[i + 4]);
+    int m0 = _mm256_movemask_pd(
+        _mm256_castsi256_pd(_mm256_cmpeq_epi64(x0, needle)));
+    int m1 = _mm256_movemask_pd(
+        _mm256_castsi256_pd(_mm256_cmpeq_epi64(x1, needle)));
+    int mask = m0 | (m1 << 4);
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + _find_scalar(&a[i], n - i, value);
+}
+
+__attribute__((target("avx2"))) static size_t _count_avx2(void **a, size_t n,
+                                                          void *value) {
+  __m256i needle = _mm256_set1_epi64x((long long)(intptr_t)value);
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)&a[i]);
+    // Matching lanes are all ones, i.e. -1
+    acc = _mm256_sub_epi64(acc, _mm256_cmpeq_epi64(x, needle));
+  }
+
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i *)lanes, acc);
+  size_t count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  return count + _count_scalar(&a[i], n - i, value);
+}
+
+__attribute__((target("avx2"))) static intptr_t _min_avx2(void **a,
+                                                          size_t n) {
+  if (n < 4) {
+    return _min_scalar(a, n);
+  }
+
+  __m256i m = _mm256_loadu_si256((const __m256i *)a);
+  size_t i = 4;
+  for (; i + 4 <= n; i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)&a[i]);
+    m = _mm256_blendv_epi8(m, x, _mm256_cmpgt_epi64(m, x));
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i *)lanes, m);
+  intptr_t result = lanes[0];
+  for (size_t j = 1; j < 4; j++) {
+    result = lanes[j] < result ? lanes[j] : result;
+  }
+  if (i < n) {
+    intptr_t tail = _min_scalar(&a[i], n - i);
+    result = tail < result ? tail : result;
+  }
+  return result;
+}
+
+__attribute__((target("avx2"))) static intptr_t _max_avx2(void **a,
+                                                          size_t n) {
+  if (n < 4) {
+    return _max_scalar(a, n);
+  }
+
+  __m256i m = _mm256_loadu_si256((const __m256i *)a);
+  size_t i = 4;
+  for (; i + 4 <= n; i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)&a[i]);
+    m = _mm256_blendv_epi8(m, x, _mm256_cmpgt_epi64(x, m));
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i *)lanes, m);
+  intptr_t result = lanes[0];
+  for (size_t j = 1; j < 4; j++) {
+    result = lanes[j] > result ? lanes[j] : result;
+  }
+  if (i < n) {
+    intptr_t tail = _max_scalar(&a[i], n - i);
+    result = tail > result ? tail : result;
+  }
+  return result;
+}
+
+__attribute__((target("sse4.2"))) static size_t _find_sse42(void **a, size_t n,
+                                                           void *value) {
+  __m128i needle = _mm_set1_epi64x((long long)(intptr_t)value);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x0 = _mm_loadu_si128((const __m128i *)&a[i]);
+    __m128i x1 = _mm_loadu_si128((const __m128i *)&a[i + 2]);
+    int m0 = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(x0, needle)));
+    int m1 = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(x1, needle)));
+    int mask = m0 | (m1 << 2);
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + _find_scalar(&a[i], n - i, value);
+}
+
+__attribute__((target("sse4.2"))) static size_t _count_sse42(void **a, size_t n,
+                                                            void *value) {
+  __m128i needle = _mm_set1_epi64x((long long)(intptr_t)value);
+  __m128i acc = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128i x = _mm_loadu_si128((const __m128i *)&a[i]);
+    acc = _mm_sub_epi64(acc, _mm_cmpeq_epi64(x, needle));
+  }
+
+  uint64_t lanes[2];
+  _mm_storeu_si128((__m128i *)lanes, acc);
+  return lanes[0] + lanes[1] + _count_scalar(&a[i], n - i, value);
+}
+
+__attribute__((target("sse4.2"))) static intptr_t _min_sse42(void **a,
+                                                           size_t n) {
+  if (n < 2) {
+    return _min_scalar(a, n);
+  }
+
+  __m128i m = _mm_loadu_si128((const __m128i *)a);
+  size_t i = 2;
+  for (; i + 2 <= n; i += 2) {
+    __m128i x = _mm_loadu_si128((const __m128i *)&a[i]);
+    m = _mm_blendv_epi8(m, x, _mm_cmpgt_epi64(m, x));
+  }
+
+  int64_t lanes[2];
+  _mm_storeu_si128((__m128i *)lanes, m);
+  intptr_t result = lanes[0] < lanes[1] ? lanes[0] : lanes[1];
+  if (i < n) {
+    intptr_t tail = (intptr_t)a[i];
+    result = tail < result ? tail : result;
+  }
+  return result;
+}
+
+__attribute__((target("sse4.2"))) static intptr_t _max_sse42(void **a,
+                                                           size_t n) {
+  if (n < 2) {
+    return _max_scalar(a, n);
+  }
+
+  __m128i m = _mm_loadu_si128((const __m128i *)a);
+  size_t i = 2;
+  for (; i + 2 <= n; i += 2) {
+    __m128i x = _mm_loadu_si128((const __m128i *)&a[i]);
+    m = _mm_blendv_epi8(m, x, _mm_cmpgt_epi64(x, m));
+  }
+
+  int64_t lanes[2];
+  _mm_storeu_si128((__m128i *)lanes, m);
+  intptr_t result = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+  if (i < n) {
+    intptr_t tail = (intptr_t)a[i];
+    result = tail > result ? tail : result;
+  }
+  return result;
+}
+
+#endif // ARRAY_LIST_X86_SIMD
+
+static kernels_t kernels = {_find_scalar, _count_scalar, _min_scalar,
+                            _max_scalar};
+static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+
+static void _select_kernels(void) {
+#ifdef ARRAY_LIST_X86_SIMD
+  if (sizeof(void *) != sizeof(int64_t)) {
+    return;
+  }
+
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    kernels = (kernels_t){_find_avx2, _count_avx2, _min_avx2, _max_avx2};
+  } else if (__builtin_cpu_supports("sse4.2")) {
+    kernels = (kernels_t){_find_sse42, _count_sse42, _min_sse42, _max_sse42};
+  }
+#endif
+}
+
+static const kernels_t *_kernels(void) {
+  pthread_once(&kernels_once, _select_kernels);
+  return &kernels;
+}
+
+cutils_error_t array_list_find_ptr(array_list_t *l, void *value, size_t *idx) {
+  if (!l || !idx) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t i = _kernels()->find(l->backing, l->length, value);
+  if (i == l->length) {
+    return CUTILS_INDEX_ERROR;
+  }
+  *idx = i;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_count_ptr(array_list_t *l, void *value,
+                                    size_t *count) {
+  if (!l || !count) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  *count = _kernels()->count(l->backing, l->length, value);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_min_int(array_list_t *l, intptr_t *value) {
+  if (!l || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (l->length == 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  *value = _kernels()->min(l->backing, l->length);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t array_list_max_int(array_list_t *l, intptr_t *value) {
+  if (!l || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (l->length == 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  *value = _kernels()->max(l->backing, l->length);
+
+  return CUTILS_SUCCESS;
+}
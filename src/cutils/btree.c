@@ -0,0 +1,582 @@
+#include "cutils/btree.h"
+#include "cutils/array_list.h"
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Branchless searches over a node's contiguous keys: the loop compiles to
+// conditional moves, so a 64-key node costs six loads and no mispredicts.
+static uint32_t _lower_bound(const uint64_t *keys, uint32_t n, uint64_t key) {
+  if (n == 0) {
+    return 0;
+  }
+
+  const uint64_t *base = keys;
+  while (n > 1) {
+    uint32_t half = n / 2;
+    base = base[half] < key ? base + half : base;
+    n -= half;
+  }
+  return (uint32_t)(base - keys) + (*base < key);
+}
+
+static uint32_t _upper_bound(const uint64_t *keys, uint32_t n, uint64_t key) {
+  if (n == 0) {
+    return 0;
+  }
+
+  const uint64_t *base = keys;
+  while (n > 1) {
+    uint32_t half = n / 2;
+    base = base[half] <= key ? base + half : base;
+    n -= half;
+  }
+  return (uint32_t)(base - keys) + (*base <= key);
+}
+
+static btree_leaf_t *_leaf_new(void) {
+  btree_leaf_t *leaf = malloc(sizeof(btree_leaf_t));
+  if (!leaf) {
+    return NULL;
+  }
+
+  leaf->node.count = 0;
+  leaf->node.leaf = true;
+  leaf->prev = NULL;
+  leaf->next = NULL;
+
+  return leaf;
+}
+
+static btree_inner_t *_inner_new(void) {
+  btree_inner_t *inner = malloc(sizeof(btree_inner_t));
+  if (!inner) {
+    return NULL;
+  }
+
+  inner->node.count = 0;
+  inner->node.leaf = false;
+
+  return inner;
+}
+
+static void _node_free(btree_t *t, btree_node_t *n, bool values) {
+  if (n->leaf) {
+    btree_leaf_t *leaf = (btree_leaf_t *)n;
+    for (uint32_t i = 0; values && t->inner_free && i < n->count; i++) {
+      t->inner_free(leaf->values[i]);
+    }
+  } else {
+    btree_inner_t *inner = (btree_inner_t *)n;
+    for (uint32_t i = 0; i <= n->count; i++) {
+      _node_free(t, inner->children[i], values);
+    }
+  }
+  free(n);
+}
+
+static btree_leaf_t *_find_leaf(btree_t *t, uint64_t key) {
+  btree_node_t *n = t->root;
+  while (!n->leaf) {
+    btree_inner_t *inner = (btree_inner_t *)n;
+    n = inner->children[_upper_bound(n->keys, n->count, key)];
+  }
+  return (btree_leaf_t *)n;
+}
+
+cutils_error_t btree_init(btree_t *t, void (*inner_free)(void *)) {
+  if (!t) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  t->length = 0;
+  t->inner_free = inner_free;
+  btree_leaf_t *root = _leaf_new();
+  if (!root) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  t->root = &root->node;
+
+  return CUTILS_SUCCESS;
+}
+
+void btree_free(void *ptr) {
+  if (ptr) {
+    btree_t *t = ptr;
+    _node_free(t, t->root, true);
+    free(t);
+  }
+}
+
+static void _leaf_insert_at(btree_leaf_t *leaf, uint32_t pos, uint64_t key,
+                            void *value) {
+  uint32_t tail = leaf->node.count - pos;
+  memmove(&leaf->node.keys[pos + 1], &leaf->node.keys[pos],
+          sizeof(uint64_t) * tail);
+  memmove(&leaf->values[pos + 1], &leaf->values[pos], sizeof(void *) * tail);
+  leaf->node.keys[pos] = key;
+  leaf->values[pos] = value;
+  leaf->node.count++;
+}
+
+static cutils_error_t _leaf_insert(btree_t *t, btree_leaf_t *leaf,
+                                   uint64_t key, void *value,
+                                   btree_node_t **right, uint64_t *sep) {
+  btree_node_t *n = &leaf->node;
+  uint32_t pos = _lower_bound(n->keys, n->count, key);
+  if (pos < n->count && n->keys[pos] == key) {
+    if (t->inner_free) {
+      t->inner_free(leaf->values[pos]);
+    }
+    leaf->values[pos] = value;
+    return CUTILS_SUCCESS;
+  }
+
+  if (n->count == BTREE_NODE_KEYS) {
+    btree_leaf_t *r = _leaf_new();
+    if (!r) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+
+    uint32_t half = BTREE_NODE_KEYS / 2;
+    r->node.count = BTREE_NODE_KEYS - half;
+    memcpy(r->node.keys, &n->keys[half], sizeof(uint64_t) * r->node.count);
+    memcpy(r->values, &leaf->values[half], sizeof(void *) * r->node.count);
+    n->count = half;
+
+    r->prev = leaf;
+    r->next = leaf->next;
+    if (leaf->next) {
+      leaf->next->prev = r;
+    }
+    leaf->next = r;
+
+    // Anything landing in the right half goes after its first key
+    if (pos > half) {
+      leaf = r;
+      pos -= half;
+    }
+    *right = &r->node;
+    *sep = r->node.keys[0];
+  }
+
+  _leaf_insert_at(leaf, pos, key, value);
+  t->length++;
+
+  return CUTILS_SUCCESS;
+}
+
+// Inserts into the subtree at `n`. When `n` splits, its new right sibling and
+// the least key under that sibling come back through `right` and `sep`.
+static cutils_error_t _insert(btree_t *t, btree_node_t *n, uint64_t key,
+                              void *value, btree_node_t **right,
+                              uint64_t *sep) {
+  if (n->leaf) {
+    return _leaf_insert(t, (btree_leaf_t *)n, key, value, right, sep);
+  }
+
+  // Take the sibling up front so a split below can never be orphaned
+  btree_inner_t *inner = (btree_inner_t *)n;
+  btree_inner_t *spare = NULL;
+  if (n->count == BTREE_NODE_KEYS) {
+    spare = _inner_new();
+    if (!spare) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+  }
+
+  uint32_t idx = _upper_bound(n->keys, n->count, key);
+  btree_node_t *child = NULL;
+  uint64_t child_sep = 0;
+  cutils_error_t err =
+      _insert(t, inner->children[idx], key, value, &child, &child_sep);
+  if (err != CUTILS_SUCCESS || !child) {
+    free(spare);
+    return err;
+  }
+
+  if (!spare) {
+    memmove(&n->keys[idx + 1], &n->keys[idx],
+            sizeof(uint64_t) * (n->count - idx));
+    memmove(&inner->children[idx + 2], &inner->children[idx + 1],
+            sizeof(btree_node_t *) * (n->count - idx));
+    n->keys[idx] = child_sep;
+    inner->children[idx + 1] = child;
+    n->count++;
+    return CUTILS_SUCCESS;
+  }
+
+  uint64_t keys[BTREE_NODE_KEYS + 1];
+  btree_node_t *children[BTREE_NODE_KEYS + 2];
+  memcpy(keys, n->keys, sizeof(uint64_t) * idx);
+  keys[idx] = child_sep;
+  memcpy(&keys[idx + 1], &n->keys[idx],
+         sizeof(uint64_t) * (BTREE_NODE_KEYS - idx));
+  memcpy(children, inner->children, sizeof(btree_node_t *) * (idx + 1));
+  children[idx + 1] = child;
+  memcpy(&children[idx + 2], &inner->children[idx + 1],
+         sizeof(btree_node_t *) * (BTREE_NODE_KEYS - idx));
+
+  // The middle key moves up rather than being copied as in a leaf split
+  uint32_t mid = (BTREE_NODE_KEYS + 1) / 2;
+  n->count = mid;
+  memcpy(n->keys, keys, sizeof(uint64_t) * mid);
+  memcpy(inner->children, children, sizeof(btree_node_t *) * (mid + 1));
+  spare->node.count = BTREE_NODE_KEYS - mid;
+  memcpy(spare->node.keys, &keys[mid + 1],
+         sizeof(uint64_t) * spare->node.count);
+  memcpy(spare->children, &children[mid + 1],
+         sizeof(btree_node_t *) * (spare->node.count + 1));
+
+  *right = &spare->node;
+  *sep = keys[mid];
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t btree_insert(btree_t *t, uint64_t key, void *value) {
+  if (!t) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  btree_inner_t *root = NULL;
+  if (t->root->count == BTREE_NODE_KEYS) {
+    root = _inner_new();
+    if (!root) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+  }
+
+  btree_node_t *right = NULL;
+  uint64_t sep = 0;
+  cutils_error_t err = _insert(t, t->root, key, value, &right, &sep);
+  if (err != CUTILS_SUCCESS || !right) {
+    free(root);
+    return err;
+  }
+
+  root->node.count = 1;
+  root->node.keys[0] = sep;
+  root->children[0] = t->root;
+  root->children[1] = right;
+  t->root = &root->node;
+
+  return CUTILS_SUCCESS;
+}
+
+// Removes `key` from the subtree at `n`, flagging `empty` when `n` is left
+// with nothing in it. Nodes are not merged on underflow; empty ones are
+// unlinked and freed by their parent instead.
+static cutils_error_t _remove(btree_t *t, btree_node_t *n, uint64_t key,
+                              void **value, bool *empty) {
+  if (n->leaf) {
+    btree_leaf_t *leaf = (btree_leaf_t *)n;
+    uint32_t pos = _lower_bound(n->keys, n->count, key);
+    if (pos == n->count || n->keys[pos] != key) {
+      return CUTILS_INDEX_ERROR;
+    }
+
+    if (value) {
+      *value = leaf->values[pos];
+    } else if (t->inner_free) {
+      t->inner_free(leaf->values[pos]);
+    }
+
+    uint32_t tail = n->count - pos - 1;
+    memmove(&n->keys[pos], &n->keys[pos + 1], sizeof(uint64_t) * tail);
+    memmove(&leaf->values[pos], &leaf->values[pos + 1], sizeof(void *) * tail);
+    n->count--;
+    t->length--;
+    *empty = n->count == 0;
+
+    return CUTILS_SUCCESS;
+  }
+
+  btree_inner_t *inner = (btree_inner_t *)n;
+  uint32_t idx = _upper_bound(n->keys, n->count, key);
+  btree_node_t *child = inner->children[idx];
+  bool child_empty = false;
+  cutils_error_t err = _remove(t, child, key, value, &child_empty);
+  if (err != CUTILS_SUCCESS || !child_empty) {
+    return err;
+  }
+
+  if (child->leaf) {
+    btree_leaf_t *leaf = (btree_leaf_t *)child;
+    if (leaf->prev) {
+      leaf->prev->next = leaf->next;
+    }
+    if (leaf->next) {
+      leaf->next->prev = leaf->prev;
+    }
+  }
+  free(child);
+
+  if (n->count == 0) {
+    *empty = true;
+    return CUTILS_SUCCESS;
+  }
+
+  // Drop the separator on the child's left, or its right for the first child
+  uint32_t k = idx > 0 ? idx - 1 : 0;
+  memmove(&n->keys[k], &n->keys[k + 1], sizeof(uint64_t) * (n->count - k - 1));
+  memmove(&inner->children[idx], &inner->children[idx + 1],
+          sizeof(btree_node_t *) * (n->count - idx));
+  n->count--;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t btree_remove(btree_t *t, uint64_t key, void **value) {
+  if (!t) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  bool empty = false;
+  cutils_error_t err = _remove(t, t->root, key, value, &empty);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  // An inner root always keeps two or more children, so it is never emptied
+  while (!t->root->leaf && t->root->count == 0) {
+    btree_node_t *old = t->root;
+    t->root = ((btree_inner_t *)old)->children[0];
+    free(old);
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t btree_get(btree_t *t, uint64_t key, void **value) {
+  if (!t || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  btree_leaf_t *leaf = _find_leaf(t, key);
+  uint32_t pos = _lower_bound(leaf->node.keys, leaf->node.count, key);
+  if (pos == leaf->node.count || leaf->node.keys[pos] != key) {
+    return CUTILS_INDEX_ERROR;
+  }
+  *value = leaf->values[pos];
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t btree_floor(btree_t *t, uint64_t key, uint64_t *found,
+                           void **value) {
+  if (!t) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  btree_leaf_t *leaf = _find_leaf(t, key);
+  uint32_t pos = _upper_bound(leaf->node.keys, leaf->node.count, key);
+  if (pos == 0) {
+    // Only the root leaf may be empty, and it has no neighbours
+    leaf = leaf->prev;
+    if (!leaf) {
+      return CUTILS_INDEX_ERROR;
+    }
+    pos = leaf->node.count;
+  }
+
+  if (found) {
+    *found = leaf->node.keys[pos - 1];
+  }
+  if (value) {
+    *value = leaf->values[pos - 1];
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t btree_ceiling(btree_t *t, uint64_t key, uint64_t *found,
+                             void **value) {
+  btree_iter_t it;
+  cutils_error_t err = btree_seek(t, key, &it);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  return btree_iter_get(&it, found, value);
+}
+
+cutils_error_t btree_bulk_load(btree_t *t, array_list_t *l,
+                               uint64_t (*key)(void *)) {
+  if (!t || !l || !key) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (t->length > 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  size_t n = l->length;
+  for (size_t i = 1; i < n; i++) {
+    if (key(l->backing[i]) <= key(l->backing[i - 1])) {
+      return CUTILS_INDEX_ERROR;
+    }
+  }
+
+  if (n == 0) {
+    return CUTILS_SUCCESS;
+  }
+
+  size_t count = (n + BTREE_NODE_KEYS - 1) / BTREE_NODE_KEYS;
+  btree_node_t **level = malloc(sizeof(btree_node_t *) * count);
+  uint64_t *mins = malloc(sizeof(uint64_t) * count);
+  if (!level || !mins) {
+    free(level);
+    free(mins);
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  // Use as few leaves as will hold the entries and fill them evenly, so
+  // their sizes differ by at most one
+  size_t built = 0;
+  size_t consumed = 0;
+  btree_leaf_t *prev = NULL;
+  for (; built < count; built++) {
+    btree_leaf_t *leaf = _leaf_new();
+    if (!leaf) {
+      break;
+    }
+
+    uint32_t size = n / count + (built < n % count);
+    for (uint32_t j = 0; j < size; j++) {
+      void *value = l->backing[consumed + j];
+      leaf->node.keys[j] = key(value);
+      leaf->values[j] = value;
+    }
+    leaf->node.count = size;
+    consumed += size;
+
+    leaf->prev = prev;
+    if (prev) {
+      prev->next = leaf;
+    }
+    prev = leaf;
+
+    level[built] = &leaf->node;
+    mins[built] = leaf->node.keys[0];
+  }
+
+  // Each pass writes parents over the front of `level`, never past the
+  // children still to be read
+  bool failed = built < count;
+  consumed = count;
+  while (!failed && count > 1) {
+    size_t fanout = BTREE_NODE_KEYS + 1;
+    size_t parents = (count + fanout - 1) / fanout;
+    consumed = 0;
+    for (built = 0; built < parents; built++) {
+      btree_inner_t *inner = _inner_new();
+      if (!inner) {
+        failed = true;
+        break;
+      }
+
+      uint32_t size = count / parents + (built < count % parents);
+      uint64_t min = mins[consumed];
+      for (uint32_t j = 0; j < size; j++) {
+        inner->children[j] = level[consumed + j];
+        if (j > 0) {
+          inner->node.keys[j - 1] = mins[consumed + j];
+        }
+      }
+      inner->node.count = size - 1;
+      consumed += size;
+
+      level[built] = &inner->node;
+      mins[built] = min;
+    }
+
+    if (!failed) {
+      count = parents;
+      consumed = parents;
+    }
+  }
+
+  if (failed) {
+    for (size_t i = 0; i < built; i++) {
+      _node_free(t, level[i], false);
+    }
+    for (size_t i = consumed; i < count; i++) {
+      _node_free(t, level[i], false);
+    }
+    free(level);
+    free(mins);
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  _node_free(t, t->root, false);
+  t->root = level[0];
+  t->length = n;
+
+  free(level);
+  free(mins);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t btree_seek(btree_t *t, uint64_t key, btree_iter_t *it) {
+  if (!t || !it) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  btree_leaf_t *leaf = _find_leaf(t, key);
+  uint32_t pos = _lower_bound(leaf->node.keys, leaf->node.count, key);
+  if (pos == leaf->node.count) {
+    leaf = leaf->next;
+    pos = 0;
+  }
+
+  it->leaf = leaf;
+  it->idx = pos;
+
+  return CUTILS_SUCCESS;
+}
+
+bool btree_iter_valid(btree_iter_t *it) {
+  return it && it->leaf && it->idx < it->leaf->node.count;
+}
+
+cutils_error_t btree_iter_next(btree_iter_t *it) {
+  if (!it) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!btree_iter_valid(it)) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  it->idx++;
+  if (it->idx == it->leaf->node.count) {
+    it->leaf = it->leaf->next;
+    it->idx = 0;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t btree_iter_get(btree_iter_t *it, uint64_t *key, void **value) {
+  if (!it) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!btree_iter_valid(it)) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (key) {
+    *key = it->leaf->node.keys[it->idx];
+  }
+  if (value) {
+    *value = it->leaf->values[it->idx];
+  }
+
+  return CUTILS_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#include "cutils/concurrent_queue.h"
+#include "cutils/concurrent_stack.h"
+#include "cutils/errors.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static concurrent_node_t *_node(concurrent_queue_t *q, uint64_t word) {
+  return concurrent_pool_node(q->pool, CONCURRENT_TAGGED_IDX(word));
+}
+
+// Clears `node->next` while moving its tag forward, so a CAS by a thread
+// still holding the node's previous link fails.
+static void _clear_next(concurrent_node_t *node) {
+  uint64_t next = atomic_load_explicit(&node->next, memory_order_relaxed);
+  atomic_store_explicit(&node->next,
+                        CONCURRENT_TAGGED(0, CONCURRENT_TAGGED_TAG(next) + 1),
+                        memory_order_relaxed);
+}
+
+cutils_error_t concurrent_queue_init(concurrent_queue_t *q,
+                                     concurrent_pool_t *pool,
+                                     void (*inner_free)(void *)) {
+  if (!q) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  atomic_init(&q->length, 0);
+  q->inner_free = inner_free;
+  q->owns_pool = false;
+
+  if (!pool) {
+    pool = malloc(sizeof(concurrent_pool_t));
+    if (!pool) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+    concurrent_pool_init(pool);
+    q->owns_pool = true;
+  }
+  q->pool = pool;
+
+  concurrent_node_t *dummy = concurrent_pool_alloc(pool, NULL);
+  if (!dummy) {
+    if (q->owns_pool) {
+      concurrent_pool_free(pool);
+    }
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  _clear_next(dummy);
+
+  atomic_init(&q->head, CONCURRENT_TAGGED(dummy->idx, 0));
+  atomic_init(&q->tail, CONCURRENT_TAGGED(dummy->idx, 0));
+
+  return CUTILS_SUCCESS;
+}
+
+void concurrent_queue_free(void *ptr) {
+  if (ptr) {
+    concurrent_queue_t *q = ptr;
+
+    // The dummy at the head carries no value
+    concurrent_node_t *node = _node(q, atomic_load(&q->head));
+    bool dummy = true;
+    while (node) {
+      concurrent_node_t *next = _node(q, atomic_load(&node->next));
+      if (!dummy && q->inner_free) {
+        q->inner_free(atomic_load(&node->value));
+      }
+      if (!q->owns_pool) {
+        concurrent_pool_release(q->pool, node);
+      }
+      dummy = false;
+      node = next;
+    }
+
+    if (q->owns_pool) {
+      concurrent_pool_free(q->pool);
+    }
+
+    free(q);
+  }
+}
+
+cutils_error_t concurrent_queue_enqueue(concurrent_queue_t *q, void *value) {
+  if (!q) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  concurrent_node_t *node = concurrent_pool_alloc(q->pool, value);
+  if (!node) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  _clear_next(node);
+
+  // Count before publishing so a racing dequeue never takes `length` below
+  // zero
+  atomic_fetch_add_explicit(&q->length, 1, memory_order_relaxed);
+
+  uint64_t tail = 0;
+  for (;;) {
+    tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    concurrent_node_t *last = _node(q, tail);
+    uint64_t next = atomic_load_explicit(&last->next, memory_order_acquire);
+    if (tail != atomic_load_explicit(&q->tail, memory_order_acquire)) {
+      continue;
+    }
+
+    if (CONCURRENT_TAGGED_IDX(next) == 0) {
+      uint64_t link =
+          CONCURRENT_TAGGED(node->idx, CONCURRENT_TAGGED_TAG(next) + 1);
+      if (atomic_compare_exchange_weak_explicit(&last->next, &next, link,
+                                                memory_order_release,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else {
+      // The tail is lagging; help the other enqueuer swing it forward
+      uint64_t desired = CONCURRENT_TAGGED(CONCURRENT_TAGGED_IDX(next),
+                                           CONCURRENT_TAGGED_TAG(tail) + 1);
+      atomic_compare_exchange_weak_explicit(&q->tail, &tail, desired,
+                                            memory_order_release,
+                                            memory_order_relaxed);
+    }
+  }
+
+  // Failing here is fine: someone else has already moved the tail on
+  uint64_t desired =
+      CONCURRENT_TAGGED(node->idx, CONCURRENT_TAGGED_TAG(tail) + 1);
+  atomic_compare_exchange_strong_explicit(&q->tail, &tail, desired,
+                                          memory_order_release,
+                                          memory_order_relaxed);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t concurrent_queue_dequeue(concurrent_queue_t *q, void **value) {
+  if (!q) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  uint64_t head = 0;
+  void *dequeued = NULL;
+  for (;;) {
+    head = atomic_load_explicit(&q->head, memory_order_acquire);
+    uint64_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    concurrent_node_t *first = _node(q, head);
+    uint64_t next = atomic_load_explicit(&first->next, memory_order_acquire);
+    if (head != atomic_load_explicit(&q->head, memory_order_acquire)) {
+      continue;
+    }
+
+    if (CONCURRENT_TAGGED_IDX(head) == CONCURRENT_TAGGED_IDX(tail)) {
+      if (CONCURRENT_TAGGED_IDX(next) == 0) {
+        return CUTILS_INDEX_ERROR;
+      }
+      uint64_t desired = CONCURRENT_TAGGED(CONCURRENT_TAGGED_IDX(next),
+                                           CONCURRENT_TAGGED_TAG(tail) + 1);
+      atomic_compare_exchange_weak_explicit(&q->tail, &tail, desired,
+                                            memory_order_release,
+                                            memory_order_relaxed);
+      continue;
+    }
+
+    // Read the value before the CAS: once the head moves, another dequeuer
+    // may recycle `next` as its dummy
+    dequeued =
+        atomic_load_explicit(&_node(q, next)->value, memory_order_relaxed);
+    uint64_t desired = CONCURRENT_TAGGED(CONCURRENT_TAGGED_IDX(next),
+                                         CONCURRENT_TAGGED_TAG(head) + 1);
+    if (atomic_compare_exchange_weak_explicit(&q->head, &head, desired,
+                                              memory_order_acq_rel,
+                                              memory_order_relaxed)) {
+      break;
+    }
+  }
+  atomic_fetch_sub_explicit(&q->length, 1, memory_order_relaxed);
+
+  if (value) {
+    *value = dequeued;
+  } else if (q->inner_free) {
+    q->inner_free(dequeued);
+  }
+
+  // The old dummy is ours now; its successor becomes the new dummy
+  concurrent_pool_release(q->pool, _node(q, head));
+
+  return CUTILS_SUCCESS;
+}
@@ -0,0 +1,275 @@
+#include "cutils/concurrent_skip_list.h"
+#include "cutils/errors.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MAX_LEVEL CONCURRENT_SKIP_LIST_MAX_LEVEL
+
+typedef concurrent_skip_list_node_t node_t;
+
+static node_t *_load(node_t *n, size_t level) {
+  return atomic_load_explicit(&n->next[level], memory_order_acquire);
+}
+
+static node_t *_node_new(void *key, void *value, size_t level) {
+  node_t *n = malloc(sizeof(node_t) + sizeof(_Atomic(node_t *)) * level);
+  if (!n) {
+    return NULL;
+  }
+
+  n->key = key;
+  n->value = value;
+  n->level = level;
+  for (size_t i = 0; i < level; i++) {
+    atomic_init(&n->next[i], NULL);
+  }
+
+  return n;
+}
+
+// splitmix64 over a shared counter gives each inserter an independent draw
+// without locking. Levels follow a geometric distribution with p = 1/4.
+static size_t _random_level(concurrent_skip_list_t *s) {
+  uint64_t z = atomic_fetch_add_explicit(&s->seed, 0x9e3779b97f4a7c15ull,
+                                         memory_order_relaxed);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  z ^= z >> 31;
+
+  size_t level = 1 + __builtin_ctzll(z | (1ull << 63)) / 2;
+  return level < MAX_LEVEL ? level : MAX_LEVEL;
+}
+
+static node_t *_find(concurrent_skip_list_t *s, void *key, node_t **preds,
+                     node_t **succs) {
+  node_t *curr = s->head;
+  for (size_t i = MAX_LEVEL; i > 0; i--) {
+    node_t *next = _load(curr, i - 1);
+    while (next && s->cmp(next->key, key) < 0) {
+      curr = next;
+      next = _load(curr, i - 1);
+    }
+    if (preds) {
+      preds[i - 1] = curr;
+      succs[i - 1] = next;
+    }
+  }
+  return _load(curr, 0);
+}
+
+cutils_error_t concurrent_skip_list_init(concurrent_skip_list_t *s,
+                                         int (*cmp)(void *, void *),
+                                         void (*key_free)(void *),
+                                         void (*inner_free)(void *)) {
+  if (!s || !cmp) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  atomic_init(&s->length, 0);
+  atomic_init(&s->seed, 0);
+  s->cmp = cmp;
+  s->key_free = key_free;
+  s->inner_free = inner_free;
+  s->head = _node_new(NULL, NULL, MAX_LEVEL);
+  if (!s->head) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void concurrent_skip_list_free(void *ptr) {
+  if (ptr) {
+    concurrent_skip_list_t *s = ptr;
+    node_t *curr = _load(s->head, 0);
+    while (curr) {
+      node_t *next = _load(curr, 0);
+      if (s->key_free) {
+        s->key_free(curr->key);
+      }
+      if (s->inner_free) {
+        s->inner_free(curr->value);
+      }
+      free(curr);
+      curr = next;
+    }
+    free(s->head);
+    free(s);
+  }
+}
+
+cutils_error_t concurrent_skip_list_insert(concurrent_skip_list_t *s,
+                                           void *key, void *value) {
+  if (!s || !key) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  node_t *preds[MAX_LEVEL];
+  node_t *succs[MAX_LEVEL];
+  node_t *node = NULL;
+
+  // Linking the bottom level is the linearization point; once that CAS
+  // succeeds the entry is visible to every reader
+  for (;;) {
+    _find(s, key, preds, succs);
+    if (succs[0] && s->cmp(succs[0]->key, key) == 0) {
+      free(node);
+      return CUTILS_DUPLICATE_ERROR;
+    }
+
+    if (!node) {
+      node = _node_new(key, value, _random_level(s));
+      if (!node) {
+        return CUTILS_ALLOCATION_ERROR;
+      }
+    }
+
+    for (size_t i = 0; i < node->level; i++) {
+      atomic_store_explicit(&node->next[i], succs[i], memory_order_relaxed);
+    }
+
+    node_t *expected = succs[0];
+    if (atomic_compare_exchange_strong_explicit(
+            &preds[0]->next[0], &expected, node, memory_order_acq_rel,
+            memory_order_acquire)) {
+      break;
+    }
+  }
+
+  // Upper levels are only shortcuts, so they can be linked one at a time,
+  // refreshing the neighbours whenever another inserter got in first
+  for (size_t i = 1; i < node->level; i++) {
+    for (;;) {
+      node_t *expected = succs[i];
+      if (atomic_compare_exchange_strong_explicit(
+              &preds[i]->next[i], &expected, node, memory_order_acq_rel,
+              memory_order_acquire)) {
+        break;
+      }
+      _find(s, key, preds, succs);
+      atomic_store_explicit(&node->next[i], succs[i], memory_order_relaxed);
+    }
+  }
+
+  atomic_fetch_add_explicit(&s->length, 1, memory_order_relaxed);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t concurrent_skip_list_get(concurrent_skip_list_t *s, void *key,
+                                        void **value) {
+  if (!s || !key || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  node_t *curr = _find(s, key, NULL, NULL);
+  if (!curr || s->cmp(curr->key, key) != 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+  *value = curr->value;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t concurrent_skip_list_floor(concurrent_skip_list_t *s,
+                                          void *key, void **found,
+                                          void **value) {
+  if (!s || !key) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  node_t *curr = s->head;
+  for (size_t i = MAX_LEVEL; i > 0; i--) {
+    node_t *next = _load(curr, i - 1);
+    while (next && s->cmp(next->key, key) <= 0) {
+      curr = next;
+      next = _load(curr, i - 1);
+    }
+  }
+
+  if (curr == s->head) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (found) {
+    *found = curr->key;
+  }
+  if (value) {
+    *value = curr->value;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t concurrent_skip_list_ceiling(concurrent_skip_list_t *s,
+                                            void *key, void **found,
+                                            void **value) {
+  if (!s || !key) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  node_t *curr = _find(s, key, NULL, NULL);
+  if (!curr) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (found) {
+    *found = curr->key;
+  }
+  if (value) {
+    *value = curr->value;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t concurrent_skip_list_seek(concurrent_skip_list_t *s, void *key,
+                                         concurrent_skip_list_iter_t *it) {
+  if (!s || !it) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  it->node = key ? _find(s, key, NULL, NULL) : _load(s->head, 0);
+
+  return CUTILS_SUCCESS;
+}
+
+bool concurrent_skip_list_iter_valid(concurrent_skip_list_iter_t *it) {
+  return it && it->node;
+}
+
+cutils_error_t concurrent_skip_list_iter_next(concurrent_skip_list_iter_t *it) {
+  if (!it) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!it->node) {
+    return CUTILS_INDEX_ERROR;
+  }
+  it->node = _load(it->node, 0);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t concurrent_skip_list_iter_get(concurrent_skip_list_iter_t *it,
+                                             void **key, void **value) {
+  if (!it) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!it->node) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (key) {
+    *key = it->node->key;
+  }
+  if (value) {
+    *value = it->node->value;
+  }
+
+  return CUTILS_SUCCESS;
+}
@@ -0,0 +1,268 @@
+#include "cutils/concurrent_stack.h"
+#include "cutils/errors.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static size_t _segment_of(uint32_t idx, size_t *offset) {
+  uint64_t j = (uint64_t)idx + ((uint64_t)1 << CONCURRENT_POOL_FIRST_SHIFT);
+  size_t msb = 63 - __builtin_clzll(j);
+  *offset = j - ((uint64_t)1 << msb);
+  return msb - CONCURRENT_POOL_FIRST_SHIFT;
+}
+
+static size_t _segment_size(size_t segment) {
+  return (size_t)1 << (segment + CONCURRENT_POOL_FIRST_SHIFT);
+}
+
+static cutils_error_t _ensure_segment(concurrent_pool_t *p, size_t segment) {
+  if (atomic_load_explicit(&p->segments[segment], memory_order_acquire)) {
+    return CUTILS_SUCCESS;
+  }
+
+  concurrent_node_t *nodes =
+      malloc(sizeof(concurrent_node_t) * _segment_size(segment));
+  if (!nodes) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  concurrent_node_t *expected = NULL;
+  if (!atomic_compare_exchange_strong_explicit(&p->segments[segment],
+                                               &expected, nodes,
+                                               memory_order_acq_rel,
+                                               memory_order_acquire)) {
+    // Another allocator installed the segment first
+    free(nodes);
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t concurrent_pool_init(concurrent_pool_t *p) {
+  if (!p) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  // Index 0 stands for NULL and is never handed out
+  atomic_init(&p->free_nodes, CONCURRENT_TAGGED(0, 0));
+  atomic_init(&p->reserved, 1);
+  for (size_t i = 0; i < CONCURRENT_POOL_MAX_SEGMENTS; i++) {
+    atomic_init(&p->segments[i], NULL);
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void concurrent_pool_free(void *ptr) {
+  if (ptr) {
+    concurrent_pool_t *p = ptr;
+    for (size_t i = 0; i < CONCURRENT_POOL_MAX_SEGMENTS; i++) {
+      free(atomic_load(&p->segments[i]));
+    }
+    free(p);
+  }
+}
+
+concurrent_node_t *concurrent_pool_node(concurrent_pool_t *p, uint32_t idx) {
+  if (!p || idx == 0) {
+    return NULL;
+  }
+
+  size_t offset = 0;
+  size_t segment = _segment_of(idx, &offset);
+  concurrent_node_t *nodes =
+      atomic_load_explicit(&p->segments[segment], memory_order_acquire);
+  return &nodes[offset];
+}
+
+concurrent_node_t *concurrent_pool_alloc(concurrent_pool_t *p, void *value) {
+  if (!p) {
+    return NULL;
+  }
+
+  // Recycled nodes first; their `next` may be read by racing poppers, so it
+  // is only ever touched atomically
+  uint64_t top = atomic_load_explicit(&p->free_nodes, memory_order_acquire);
+  while (CONCURRENT_TAGGED_IDX(top) != 0) {
+    concurrent_node_t *node =
+        concurrent_pool_node(p, CONCURRENT_TAGGED_IDX(top));
+    uint64_t next = atomic_load_explicit(&node->next, memory_order_relaxed);
+    uint64_t desired = CONCURRENT_TAGGED(CONCURRENT_TAGGED_IDX(next),
+                                         CONCURRENT_TAGGED_TAG(top) + 1);
+    if (atomic_compare_exchange_weak_explicit(&p->free_nodes, &top, desired,
+                                              memory_order_acquire,
+                                              memory_order_acquire)) {
+      atomic_store_explicit(&node->value, value, memory_order_relaxed);
+      return node;
+    }
+  }
+
+  // Only claim an index once its segment exists, so a failed allocation
+  // never leaves a node index that was handed out but has no memory
+  uint32_t idx = atomic_load_explicit(&p->reserved, memory_order_relaxed);
+  for (;;) {
+    size_t offset = 0;
+    size_t segment = _segment_of(idx, &offset);
+    if (segment >= CONCURRENT_POOL_MAX_SEGMENTS) {
+      return NULL;
+    }
+
+    if (_ensure_segment(p, segment) != CUTILS_SUCCESS) {
+      return NULL;
+    }
+
+    uint_fast32_t expected = idx;
+    if (atomic_compare_exchange_weak_explicit(&p->reserved, &expected,
+                                              idx + 1, memory_order_relaxed,
+                                              memory_order_relaxed)) {
+      break;
+    }
+    idx = expected;
+  }
+
+  concurrent_node_t *node = concurrent_pool_node(p, idx);
+  node->idx = idx;
+  atomic_init(&node->next, CONCURRENT_TAGGED(0, 0));
+  atomic_init(&node->value, value);
+
+  return node;
+}
+
+void concurrent_pool_release(concurrent_pool_t *p, concurrent_node_t *node) {
+  if (!p || !node) {
+    return;
+  }
+
+  uint64_t top = atomic_load_explicit(&p->free_nodes, memory_order_relaxed);
+  uint64_t desired = 0;
+  do {
+    // Keep the tag in `next` moving so stale links to this node never match
+    uint64_t next = atomic_load_explicit(&node->next, memory_order_relaxed);
+    atomic_store_explicit(&node->next,
+                          CONCURRENT_TAGGED(CONCURRENT_TAGGED_IDX(top),
+                                            CONCURRENT_TAGGED_TAG(next) + 1),
+                          memory_order_relaxed);
+    desired = CONCURRENT_TAGGED(node->idx, CONCURRENT_TAGGED_TAG(top) + 1);
+  } while (!atomic_compare_exchange_weak_explicit(&p->free_nodes, &top, desired,
+                                                  memory_order_release,
+                                                  memory_order_relaxed));
+}
+
+cutils_error_t concurrent_stack_init(concurrent_stack_t *s,
+                                     concurrent_pool_t *pool,
+                                     void (*inner_free)(void *)) {
+  if (!s) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  atomic_init(&s->top, CONCURRENT_TAGGED(0, 0));
+  atomic_init(&s->length, 0);
+  s->inner_free = inner_free;
+  s->owns_pool = false;
+
+  if (!pool) {
+    pool = malloc(sizeof(concurrent_pool_t));
+    if (!pool) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+    concurrent_pool_init(pool);
+    s->owns_pool = true;
+  }
+  s->pool = pool;
+
+  return CUTILS_SUCCESS;
+}
+
+void concurrent_stack_free(void *ptr) {
+  if (ptr) {
+    concurrent_stack_t *s = ptr;
+
+    // A private pool goes away a segment at a time, so nodes only need
+    // visiting to free their values or hand them back to a shared pool
+    bool walk = !s->owns_pool || s->inner_free;
+    uint32_t idx = CONCURRENT_TAGGED_IDX(atomic_load(&s->top));
+    while (walk && idx != 0) {
+      concurrent_node_t *node = concurrent_pool_node(s->pool, idx);
+      idx = CONCURRENT_TAGGED_IDX(atomic_load(&node->next));
+      if (s->inner_free) {
+        s->inner_free(atomic_load(&node->value));
+      }
+      if (!s->owns_pool) {
+        concurrent_pool_release(s->pool, node);
+      }
+    }
+
+    if (s->owns_pool) {
+      concurrent_pool_free(s->pool);
+    }
+
+    free(s);
+  }
+}
+
+cutils_error_t concurrent_stack_push(concurrent_stack_t *s, void *value) {
+  if (!s) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  concurrent_node_t *node = concurrent_pool_alloc(s->pool, value);
+  if (!node) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  // Count before publishing so a racing pop never takes `length` below zero
+  atomic_fetch_add_explicit(&s->length, 1, memory_order_relaxed);
+
+  uint64_t top = atomic_load_explicit(&s->top, memory_order_relaxed);
+  uint64_t desired = 0;
+  do {
+    uint64_t next = atomic_load_explicit(&node->next, memory_order_relaxed);
+    atomic_store_explicit(&node->next,
+                          CONCURRENT_TAGGED(CONCURRENT_TAGGED_IDX(top),
+                                            CONCURRENT_TAGGED_TAG(next) + 1),
+                          memory_order_relaxed);
+    desired = CONCURRENT_TAGGED(node->idx, CONCURRENT_TAGGED_TAG(top) + 1);
+  } while (!atomic_compare_exchange_weak_explicit(&s->top, &top, desired,
+                                                  memory_order_release,
+                                                  memory_order_relaxed));
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t concurrent_stack_pop(concurrent_stack_t *s, void **value) {
+  if (!s) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  uint64_t top = atomic_load_explicit(&s->top, memory_order_acquire);
+  concurrent_node_t *node = NULL;
+  for (;;) {
+    if (CONCURRENT_TAGGED_IDX(top) == 0) {
+      return CUTILS_INDEX_ERROR;
+    }
+
+    // `node` may be popped and recycled under us; the tag then fails the CAS
+    node = concurrent_pool_node(s->pool, CONCURRENT_TAGGED_IDX(top));
+    uint64_t next = atomic_load_explicit(&node->next, memory_order_relaxed);
+    uint64_t desired = CONCURRENT_TAGGED(CONCURRENT_TAGGED_IDX(next),
+                                         CONCURRENT_TAGGED_TAG(top) + 1);
+    if (atomic_compare_exchange_weak_explicit(&s->top, &top, desired,
+                                              memory_order_acquire,
+                                              memory_order_acquire)) {
+      break;
+    }
+  }
+  atomic_fetch_sub_explicit(&s->length, 1, memory_order_relaxed);
+
+  void *popped = atomic_load_explicit(&node->value, memory_order_relaxed);
+  if (value) {
+    *value = popped;
+  } else if (s->inner_free) {
+    s->inner_free(popped);
+  }
+  concurrent_pool_release(s->pool, node);
+
+  return CUTILS_SUCCESS;
+}
@@ -15,6 +15,14 @@ const char *cutils_error_message(cutils_error_t err) {
     return "Resize error";
   case CUTILS_JSON_PARSE_ERROR:
     return "JSON parsing error";
+  case CUTILS_THREAD_ERROR:
+    return "Thread creation error";
+  case CUTILS_DUPLICATE_ERROR:
+    return "Duplicate key error";
+  case CUTILS_POOL_ERROR:
+    return "Node pool mismatch error";
+  case CUTILS_IO_ERROR:
+    return "I/O error";
   default:
     return "Unknown error";
   }
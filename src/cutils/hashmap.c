@@ -222,7 +222,6 @@ cutils_error_t hashmap_remove(hashmap_t *m, void *key, void **value) {
     return err;
   }
 
-  size_t idx = 0;
   linked_list_node_t *curr = l->head;
   while (curr) {
     hashmap_entry_t *entry = curr->value;
@@ -230,7 +229,6 @@ cutils_error_t hashmap_remove(hashmap_t *m, void *key, void **value) {
       break;
     }
     curr = curr->next;
-    idx++;
   }
 
   if (!curr) {
@@ -238,7 +236,7 @@ cutils_error_t hashmap_remove(hashmap_t *m, void *key, void **value) {
   }
 
   hashmap_entry_t *entry = NULL;
-  err = linked_list_remove_at(l, idx, (void **)&entry);
+  err = linked_list_remove_node(l, curr, (void **)&entry);
   if (err != CUTILS_SUCCESS) {
     return err;
   }
@@ -0,0 +1,147 @@
+#include "cutils/intrusive_list.h"
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+cutils_error_t intrusive_list_init(intrusive_list_t *l) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  l->length = 0;
+  l->root.prev = &l->root;
+  l->root.next = &l->root;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t intrusive_list_link_init(intrusive_list_link_t *link) {
+  if (!link) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  link->prev = NULL;
+  link->next = NULL;
+
+  return CUTILS_SUCCESS;
+}
+
+bool intrusive_list_is_linked(intrusive_list_link_t *link) {
+  return link && link->next;
+}
+
+cutils_error_t intrusive_list_insert_before(intrusive_list_t *l,
+                                            intrusive_list_link_t *pos,
+                                            intrusive_list_link_t *link) {
+  if (!l || !pos || !link) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  link->prev = pos->prev;
+  link->next = pos;
+  pos->prev->next = link;
+  pos->prev = link;
+  l->length++;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t intrusive_list_insert_after(intrusive_list_t *l,
+                                           intrusive_list_link_t *pos,
+                                           intrusive_list_link_t *link) {
+  if (!pos) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  return intrusive_list_insert_before(l, pos->next, link);
+}
+
+cutils_error_t intrusive_list_push_front(intrusive_list_t *l,
+                                         intrusive_list_link_t *link) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  return intrusive_list_insert_before(l, l->root.next, link);
+}
+
+cutils_error_t intrusive_list_push_back(intrusive_list_t *l,
+                                        intrusive_list_link_t *link) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  return intrusive_list_insert_before(l, &l->root, link);
+}
+
+cutils_error_t intrusive_list_unlink(intrusive_list_t *l,
+                                     intrusive_list_link_t *link) {
+  if (!l || !link) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!link->next || link == &l->root) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+  link->prev = NULL;
+  link->next = NULL;
+  l->length--;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t intrusive_list_pop_front(intrusive_list_t *l,
+                                        intrusive_list_link_t **link) {
+  if (!l || !link) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (l->length == 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  *link = l->root.next;
+  return intrusive_list_unlink(l, *link);
+}
+
+cutils_error_t intrusive_list_pop_back(intrusive_list_t *l,
+                                       intrusive_list_link_t **link) {
+  if (!l || !link) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (l->length == 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  *link = l->root.prev;
+  return intrusive_list_unlink(l, *link);
+}
+
+cutils_error_t intrusive_list_splice(intrusive_list_t *dst,
+                                     intrusive_list_link_t *pos,
+                                     intrusive_list_t *src) {
+  if (!dst || !pos || !src) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (src->length == 0 || src == dst) {
+    return CUTILS_SUCCESS;
+  }
+
+  intrusive_list_link_t *first = src->root.next;
+  intrusive_list_link_t *last = src->root.prev;
+
+  first->prev = pos->prev;
+  last->next = pos;
+  pos->prev->next = first;
+  pos->prev = last;
+
+  dst->length += src->length;
+  intrusive_list_init(src);
+
+  return CUTILS_SUCCESS;
+}
@@ -1,7 +1,6 @@
 #include "cutils/json.h"
 #include "cutils/array_list.h"
 #include "cutils/errors.h"
-#include "cutils/hashmap.h"
 #include <ctype.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -12,13 +11,35 @@
 typedef struct {
   const char *text;
   size_t pos;
+  size_t length; // Input ends here; a NUL before it is just another byte
   cutils_error_t err;
+  const uint32_t *structurals; // NULL when scanning byte by byte
+  size_t next;
+  json_arena_t *arena;    // NULL when each node is malloc'd
+  array_list_t *stack;    // Children of the containers being parsed
+  json_tape_t *tape;      // Output of json_tape_parse instead of nodes
+  json_handler_t handler; // Receiver of json_parse_events
+  void *ctx;
+  json_buffer_t *scratch; // Decoded string handed to the handler
+  bool stopped;
+  bool views;        // Tape strings without escapes point into `text`
+  json_file_t *file; // Mapping to release pages of as parsing goes
 } parser_t;
 
 static json_value_t *_parse_value(parser_t *p);
 
-static json_value_t *json_value_new(json_type_t type) {
-  json_value_t *v = malloc(sizeof(json_value_t));
+static void *_alloc(parser_t *p, size_t size) {
+  return p->arena ? json_arena_alloc(p->arena, size) : malloc(size);
+}
+
+static void _release(parser_t *p, void *ptr) {
+  if (!p->arena) {
+    free(ptr);
+  }
+}
+
+static json_value_t *json_value_new(parser_t *p, json_type_t type) {
+  json_value_t *v = _alloc(p, sizeof(json_value_t));
   if (!v) {
     return NULL;
   }
@@ -39,7 +60,7 @@ void json_value_free(void *ptr) {
     array_list_free(v->value.array);
     break;
   case JSON_OBJECT:
-    hashmap_free(v->value.object);
+    json_object_free(v->value.object);
     break;
   case JSON_NULL:
   case JSON_BOOLEAN:
@@ -50,29 +71,45 @@ void json_value_free(void *ptr) {
   free(v);
 }
 
-static uint64_t _hash_string(void *key) {
-  char *str = key;
-  uint64_t hash = 5381;
-  int c;
-  while ((c = *str++)) {
-    hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-  }
-  return hash;
-}
-
-static bool _cmp_string(void *lhs, void *rhs) {
-  return strcmp(lhs, rhs) == 0;
+static bool _is_whitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
 static void _skip_whitespace(parser_t *p) {
-  while (isspace(p->text[p->pos])) {
+  if (p->structurals) {
+    // Whatever follows a token is either whitespace or indexed
+    while (p->structurals[p->next] < p->pos) {
+      p->next++;
+    }
+    p->pos = p->structurals[p->next];
+    return;
+  }
+
+  while (p->pos < p->length && _is_whitespace(p->text[p->pos])) {
     p->pos++;
   }
 }
 
-static char _peek(parser_t *p) { return p->text[p->pos]; }
+// Past the end reads as NUL, which nothing in the grammar accepts.
+static char _peek(parser_t *p) {
+  return p->pos < p->length ? p->text[p->pos] : '\0';
+}
+
+static char _advance(parser_t *p) {
+  char c = _peek(p);
+  p->pos++;
+  return c;
+}
 
-static char _advance(parser_t *p) { return p->text[p->pos++]; }
+// Numbers and literals must end at whitespace, punctuation or the end.
+static bool _at_delimiter(parser_t *p) {
+  if (p->pos >= p->length) {
+    return true;
+  }
+  char c = p->text[p->pos];
+  return _is_whitespace(c) || c == ',' || c == ':' || c == ']' || c == '}' ||
+         c == '[' || c == '{';
+}
 
 static bool _match(parser_t *p, char expected) {
   _skip_whitespace(p);
@@ -83,35 +120,91 @@ static bool _match(parser_t *p, char expected) {
   return false;
 }
 
+static bool _scan_literal(parser_t *p, const char *literal) {
+  size_t len = strlen(literal);
+  if (p->length - p->pos < len ||
+      memcmp(&p->text[p->pos], literal, len) != 0) {
+    p->err = CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+  p->pos += len;
+  if (!_at_delimiter(p)) {
+    p->err = CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+  return true;
+}
+
 static json_value_t *_parse_literal(parser_t *p, const char *literal,
                                      json_type_t type, bool boolean_value) {
-  size_t len = strlen(literal);
-  if (strncmp(&p->text[p->pos], literal, len) == 0) {
-    p->pos += len;
-    json_value_t *v = json_value_new(type);
-    if (!v) {
+  if (!_scan_literal(p, literal)) {
+    return NULL;
+  }
+  json_value_t *v = json_value_new(p, type);
+  if (!v) {
+    p->err = CUTILS_ALLOCATION_ERROR;
+    return NULL;
+  }
+  if (type == JSON_BOOLEAN) {
+    v->value.boolean = boolean_value;
+  }
+  return v;
+}
+
+static bool _is_number_char(char c) {
+  return isdigit(c) || c == '.' || c == 'e' || c == 'E' || c == '+' ||
+         c == '-';
+}
+
+// strtod wants a terminator. A delimiter after the number stops it in
+// place; only a number running into the end of the input is copied out.
+static bool _scan_number(parser_t *p, double *num) {
+  size_t start = p->pos;
+  while (p->pos < p->length && _is_number_char(p->text[p->pos])) {
+    p->pos++;
+  }
+  size_t end = p->pos;
+  if (!_at_delimiter(p)) {
+    p->err = CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+
+  char *stop = NULL;
+  size_t consumed = 0;
+  if (end < p->length) {
+    *num = strtod(&p->text[start], &stop);
+    consumed = (size_t)((const char *)stop - &p->text[start]);
+  } else {
+    char local[64];
+    size_t n = end - start;
+    char *copy = n < sizeof(local) ? local : malloc(n + 1);
+    if (!copy) {
       p->err = CUTILS_ALLOCATION_ERROR;
-      return NULL;
+      return false;
     }
-    if (type == JSON_BOOLEAN) {
-      v->value.boolean = boolean_value;
+    memcpy(copy, &p->text[start], n);
+    copy[n] = '\0';
+    *num = strtod(copy, &stop);
+    consumed = (size_t)(stop - copy);
+    if (copy != local) {
+      free(copy);
     }
-    return v;
   }
-  p->err = CUTILS_JSON_PARSE_ERROR;
-  return NULL;
+
+  if (consumed == 0 || start + consumed != end) {
+    p->err = CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+  return true;
 }
 
 static json_value_t *_parse_number(parser_t *p) {
-  char *end;
-  double num = strtod(&p->text[p->pos], &end);
-  if ((const char *)end == &p->text[p->pos]) {
-    p->err = CUTILS_JSON_PARSE_ERROR;
+  double num;
+  if (!_scan_number(p, &num)) {
     return NULL;
   }
-  p->pos = (const char *)end - p->text;
 
-  json_value_t *v = json_value_new(JSON_NUMBER);
+  json_value_t *v = json_value_new(p, JSON_NUMBER);
   if (!v) {
     p->err = CUTILS_ALLOCATION_ERROR;
     return NULL;
@@ -157,13 +250,17 @@ static void _encode_utf8(char **buffer, unsigned int codepoint) {
   }
 }
 
-static json_value_t *_parse_string(parser_t *p) {
-  size_t start = p->pos;
+// Finds the closing quote of the string starting at `p->pos`, returning an
+// upper bound on its decoded length and, if `escaped` is set, whether any
+// escape needs decoding.
+static bool _scan_chars(parser_t *p, size_t *bound, bool *escaped) {
   size_t len = 0;
-  while (p->text[p->pos] != '"' && p->text[p->pos] != '\0') {
-    if (p->text[p->pos] == '\\') {
+  bool backslash = false;
+  while (_peek(p) != '"' && _peek(p) != '\0') {
+    if (_peek(p) == '\\') {
+      backslash = true;
       p->pos++; // Skip escape char
-      if (p->text[p->pos] == 'u') {
+      if (_peek(p) == 'u') {
         len += 4; // Max UTF-8 length for a codepoint
       } else {
         len++;
@@ -174,18 +271,21 @@ static json_value_t *_parse_string(parser_t *p) {
     p->pos++;
   }
 
-  if (p->text[p->pos] == '\0') {
+  if (_peek(p) != '"') {
     p->err = CUTILS_JSON_PARSE_ERROR;
-    return NULL;
+    return false;
   }
-
-  char *str = malloc(len + 1);
-  if (!str) {
-    p->err = CUTILS_ALLOCATION_ERROR;
-    return NULL;
+  *bound = len;
+  if (escaped) {
+    *escaped = backslash;
   }
-  char *str_ptr = str;
+  return true;
+}
 
+// Decodes the string starting at `start` into `str`, NUL-terminated, and
+// consumes the closing quote.
+static bool _unescape(parser_t *p, size_t start, char *str, size_t *length) {
+  char *str_ptr = str;
   p->pos = start;
   while (p->text[p->pos] != '"') {
     if (p->text[p->pos] == '\\') {
@@ -218,15 +318,13 @@ static json_value_t *_parse_string(parser_t *p) {
       case 'u': {
         unsigned int codepoint = _parse_hex4(p);
         if (p->err != CUTILS_SUCCESS) {
-          free(str);
-          return NULL;
+          return false;
         }
         _encode_utf8(&str_ptr, codepoint);
       } break;
       default:
-        free(str);
         p->err = CUTILS_JSON_PARSE_ERROR;
-        return NULL;
+        return false;
       }
     } else {
       *str_ptr++ = p->text[p->pos++];
@@ -235,17 +333,94 @@ static json_value_t *_parse_string(parser_t *p) {
   *str_ptr = '\0';
   p->pos++; // Consume closing quote
 
-  json_value_t *v = json_value_new(JSON_STRING);
+  *length = str_ptr - str;
+  return true;
+}
+
+static char *_parse_chars(parser_t *p) {
+  size_t start = p->pos;
+  size_t len = 0;
+  if (!_scan_chars(p, &len, NULL)) {
+    return NULL;
+  }
+
+  char *str = _alloc(p, len + 1);
+  if (!str) {
+    p->err = CUTILS_ALLOCATION_ERROR;
+    return NULL;
+  }
+  if (!_unescape(p, start, str, &len)) {
+    _release(p, str);
+    return NULL;
+  }
+
+  return str;
+}
+
+static json_value_t *_parse_string(parser_t *p) {
+  char *str = _parse_chars(p);
+  if (!str) {
+    return NULL;
+  }
+
+  json_value_t *v = json_value_new(p, JSON_STRING);
   if (!v) {
     p->err = CUTILS_ALLOCATION_ERROR;
-    free(str);
+    _release(p, str);
     return NULL;
   }
   v->value.string = str;
   return v;
 }
 
+// Collects the children on the parser's stack, then copies them into an
+// exactly sized arena backing once the count is known.
+static json_value_t *_parse_array_arena(parser_t *p) {
+  array_list_t *stack = p->stack;
+  size_t base = stack->length;
+  if (!_match(p, ']')) {
+    do {
+      json_value_t *elem = _parse_value(p);
+      if (!elem) {
+        stack->length = base;
+        return NULL;
+      }
+      if (array_list_push(stack, elem) != CUTILS_SUCCESS) {
+        stack->length = base;
+        p->err = CUTILS_ALLOCATION_ERROR;
+        return NULL;
+      }
+    } while (_match(p, ','));
+
+    if (!_match(p, ']')) {
+      stack->length = base;
+      p->err = CUTILS_JSON_PARSE_ERROR;
+      return NULL;
+    }
+  }
+
+  size_t n = stack->length - base;
+  json_value_t *v = json_value_new(p, JSON_ARRAY);
+  array_list_t *arr = _alloc(p, sizeof(array_list_t));
+  void **backing = _alloc(p, sizeof(void *) * n);
+  if (!v || !arr || !backing) {
+    stack->length = base;
+    p->err = CUTILS_ALLOCATION_ERROR;
+    return NULL;
+  }
+  memcpy(backing, &stack->backing[base], sizeof(void *) * n);
+  stack->length = base;
+
+  *arr = (array_list_t){.length = n, .capacity = n, .backing = backing};
+  v->value.array = arr;
+  return v;
+}
+
 static json_value_t *_parse_array(parser_t *p) {
+  if (p->arena) {
+    return _parse_array_arena(p);
+  }
+
   array_list_t *arr = malloc(sizeof(array_list_t));
   if (!arr) {
     p->err = CUTILS_ALLOCATION_ERROR;
@@ -254,7 +429,7 @@ static json_value_t *_parse_array(parser_t *p) {
   array_list_init(arr, 8, json_value_free, NULL);
 
   if (_match(p, ']')) { // Empty array
-    json_value_t *v = json_value_new(JSON_ARRAY);
+    json_value_t *v = json_value_new(p, JSON_ARRAY);
     if (!v) {
       array_list_free(arr);
       p->err = CUTILS_ALLOCATION_ERROR;
@@ -279,7 +454,7 @@ static json_value_t *_parse_array(parser_t *p) {
     return NULL;
   }
 
-  json_value_t *v = json_value_new(JSON_ARRAY);
+  json_value_t *v = json_value_new(p, JSON_ARRAY);
   if (!v) {
     array_list_free(arr);
     p->err = CUTILS_ALLOCATION_ERROR;
@@ -289,69 +464,106 @@ static json_value_t *_parse_array(parser_t *p) {
   return v;
 }
 
-static json_value_t *_parse_object(parser_t *p) {
-  hashmap_t *obj = malloc(sizeof(hashmap_t));
-  if (!obj) {
-    p->err = CUTILS_ALLOCATION_ERROR;
-    return NULL;
-  }
-  hashmap_init(obj, 16, _hash_string, _cmp_string, free, json_value_free);
-
-  if (_match(p, '}')) { // Empty object
-    json_value_t *v = json_value_new(JSON_OBJECT);
-    if (!v) {
-      hashmap_free(obj);
-      p->err = CUTILS_ALLOCATION_ERROR;
-      return NULL;
+// Drops what an unfinished object left on the stack above `base`: keys and
+// values alternately, starting with a key.
+static void _unwind(parser_t *p, size_t base) {
+  array_list_t *stack = p->stack;
+  if (!p->arena) {
+    for (size_t i = base; i < stack->length; i++) {
+      if ((i - base) % 2 == 0) {
+        free(stack->backing[i]);
+      } else {
+        json_value_free(stack->backing[i]);
+      }
     }
-    v->value.object = obj;
-    return v;
   }
+  stack->length = base;
+}
 
-  do {
-    _skip_whitespace(p);
-    if (_peek(p) != '"') {
-      hashmap_free(obj);
-      p->err = CUTILS_JSON_PARSE_ERROR;
-      return NULL;
+static bool _push_member(parser_t *p, char *key, json_value_t *val) {
+  if (array_list_push(p->stack, key) != CUTILS_SUCCESS) {
+    _release(p, key);
+    if (!p->arena) {
+      json_value_free(val);
     }
-    _advance(p); // Consume opening quote
-    json_value_t *key_val = _parse_string(p);
-    if (!key_val) {
-      hashmap_free(obj);
-      return NULL;
+    return false;
+  }
+  if (array_list_push(p->stack, val) != CUTILS_SUCCESS) {
+    if (!p->arena) {
+      json_value_free(val);
     }
+    return false;
+  }
+  return true;
+}
 
-    if (!_match(p, ':')) {
-      json_value_free(key_val);
-      hashmap_free(obj);
-      p->err = CUTILS_JSON_PARSE_ERROR;
-      return NULL;
-    }
+// Members go on the stack as key, value pairs, then into an exactly sized
+// member array once the object closes.
+static json_value_t *_parse_object(parser_t *p) {
+  array_list_t *stack = p->stack;
+  size_t base = stack->length;
+  if (!_match(p, '}')) {
+    do {
+      _skip_whitespace(p);
+      if (_peek(p) != '"') {
+        _unwind(p, base);
+        p->err = CUTILS_JSON_PARSE_ERROR;
+        return NULL;
+      }
+      _advance(p); // Consume opening quote
+      char *key = _parse_chars(p);
+      if (!key) {
+        _unwind(p, base);
+        return NULL;
+      }
 
-    json_value_t *val = _parse_value(p);
-    if (!val) {
-      json_value_free(key_val);
-      hashmap_free(obj);
-      return NULL;
-    }
+      if (!_match(p, ':')) {
+        _release(p, key);
+        _unwind(p, base);
+        p->err = CUTILS_JSON_PARSE_ERROR;
+        return NULL;
+      }
 
-    hashmap_insert(obj, key_val->value.string, val);
-    free(key_val); // Free the container, not the string itself
-  } while (_match(p, ','));
+      json_value_t *val = _parse_value(p);
+      if (!val) {
+        _release(p, key);
+        _unwind(p, base);
+        return NULL;
+      }
+      if (!_push_member(p, key, val)) {
+        _unwind(p, base);
+        p->err = CUTILS_ALLOCATION_ERROR;
+        return NULL;
+      }
+    } while (_match(p, ','));
 
-  if (!_match(p, '}')) {
-    hashmap_free(obj);
-    p->err = CUTILS_JSON_PARSE_ERROR;
-    return NULL;
+    if (!_match(p, '}')) {
+      _unwind(p, base);
+      p->err = CUTILS_JSON_PARSE_ERROR;
+      return NULL;
+    }
   }
 
-  json_value_t *v = json_value_new(JSON_OBJECT);
-  if (!v) {
-    hashmap_free(obj);
+  size_t n = (stack->length - base) / 2;
+  json_value_t *v = json_value_new(p, JSON_OBJECT);
+  json_object_t *obj = _alloc(p, sizeof(json_object_t));
+  json_member_t *members = n > 0 ? _alloc(p, sizeof(json_member_t) * n) : NULL;
+  if (!v || !obj || (n > 0 && !members)) {
+    _release(p, v);
+    _release(p, obj);
+    _unwind(p, base);
     p->err = CUTILS_ALLOCATION_ERROR;
     return NULL;
   }
+
+  void **pairs = &stack->backing[base];
+  for (size_t i = 0; i < n; i++) {
+    members[i] = (json_member_t){pairs[2 * i], pairs[2 * i + 1]};
+  }
+  stack->length = base;
+
+  *obj = (json_object_t){
+      .length = n, .capacity = n, .members = members, .arena = p->arena};
   v->value.object = obj;
   return v;
 }
@@ -384,28 +596,1116 @@ static json_value_t *_parse_value(parser_t *p) {
   }
 }
 
+// Parses the whole of `p->text`, going through `idx` when given one and the
+// text is long enough. On failure nothing is left allocated outside the
+// arena.
+static cutils_error_t _run(parser_t *p, json_index_t *idx,
+                           json_value_t **value) {
+  *value = NULL;
+  size_t length = p->length;
+  if (idx && length >= JSON_INDEX_THRESHOLD && length < UINT32_MAX) {
+    cutils_error_t err = json_index_build(idx, p->text, length);
+    if (err != CUTILS_SUCCESS) {
+      return err;
+    }
+    p->structurals = idx->positions;
+  }
+
+  *value = _parse_value(p);
+  if (p->err == CUTILS_SUCCESS) {
+    _skip_whitespace(p);
+    if (p->pos < p->length) {
+      p->err = CUTILS_JSON_PARSE_ERROR;
+    }
+  }
+
+  if (p->err != CUTILS_SUCCESS) {
+    if (!p->arena) {
+      json_value_free(*value);
+    }
+    *value = NULL;
+  }
+
+  return p->err;
+}
+
 cutils_error_t json_parse(const char *text, json_value_t **value) {
   if (!text || !value) {
     return CUTILS_NULL_ERROR;
   }
+  return json_parse_n(text, strlen(text), value);
+}
+
+cutils_error_t json_parse_n(const char *text, size_t length,
+                            json_value_t **value) {
+  if (!text || !value) {
+    return CUTILS_NULL_ERROR;
+  }
 
-  parser_t p = {text, 0, CUTILS_SUCCESS};
-  *value = _parse_value(&p);
+  array_list_t *stack = malloc(sizeof(array_list_t));
+  if (!stack) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  cutils_error_t err = array_list_init(stack, 32, NULL, NULL);
+  if (err != CUTILS_SUCCESS) {
+    return err; // array_list_init has already freed `stack`
+  }
 
-  if (p.err != CUTILS_SUCCESS) {
-    if (*value) {
-      json_value_free(*value);
-      *value = NULL;
+  json_index_t *idx = NULL;
+  if (length >= JSON_INDEX_THRESHOLD && length < UINT32_MAX) {
+    idx = malloc(sizeof(json_index_t));
+    err = idx ? json_index_init(idx, length / 4 + 64) : CUTILS_ALLOCATION_ERROR;
+    if (err != CUTILS_SUCCESS) {
+      free(idx);
+      array_list_free(stack);
+      return err;
     }
-    return p.err;
   }
 
-  _skip_whitespace(&p);
-  if (_peek(&p) != '\0') {
-    json_value_free(*value);
-    *value = NULL;
-    return CUTILS_JSON_PARSE_ERROR;
+  parser_t p = {.text = text, .length = length, .stack = stack};
+  err = _run(&p, idx, value);
+  json_index_free(idx);
+  array_list_free(stack);
+
+  return err;
+}
+
+cutils_error_t json_document_init(json_document_t *d, size_t chunk_size) {
+  if (!d) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  d->root = NULL;
+  d->arena = malloc(sizeof(json_arena_t));
+  d->index = malloc(sizeof(json_index_t));
+  d->stack = malloc(sizeof(array_list_t));
+  if (!d->arena || !d->index || !d->stack) {
+    free(d->arena);
+    free(d->index);
+    free(d->stack);
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  json_arena_init(d->arena, chunk_size);
+  cutils_error_t err = json_index_init(d->index, 0);
+  if (err == CUTILS_SUCCESS) {
+    err = array_list_init(d->stack, 64, NULL, NULL);
+    if (err != CUTILS_SUCCESS) {
+      d->stack = NULL; // Already freed by array_list_init
+      free(d->index->positions);
+    }
   }
+  if (err != CUTILS_SUCCESS) {
+    free(d->arena);
+    free(d->index);
+    free(d->stack);
+    return err;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void json_document_free(void *ptr) {
+  if (ptr) {
+    json_document_t *d = ptr;
+    json_arena_free(d->arena);
+    json_index_free(d->index);
+    array_list_free(d->stack);
+    free(d);
+  }
+}
+
+cutils_error_t json_document_parse(json_document_t *d, const char *text) {
+  if (!d || !text) {
+    return CUTILS_NULL_ERROR;
+  }
+  return json_document_parse_n(d, text, strlen(text));
+}
+
+cutils_error_t json_document_parse_n(json_document_t *d, const char *text,
+                                     size_t length) {
+  if (!d || !text) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  json_document_clear(d);
+  parser_t p = {
+      .text = text, .length = length, .arena = d->arena, .stack = d->stack};
+  return _run(&p, d->index, &d->root);
+}
+
+void json_document_clear(json_document_t *d) {
+  if (d) {
+    d->root = NULL;
+    d->stack->length = 0;
+    json_arena_reset(d->arena);
+  }
+}
+
+// In bounded mode, hands back the pages parsing has moved past.
+static void _release_behind(parser_t *p) {
+  if (p->file && p->pos - p->file->released >= JSON_FILE_WINDOW) {
+    json_file_release(p->file, p->pos);
+  }
+}
+
+static bool _tape_push(parser_t *p, uint64_t word) {
+  json_tape_t *t = p->tape;
+  if (t->length == t->capacity) {
+    size_t capacity = t->capacity > 0 ? t->capacity * 2 : 64;
+    uint64_t *words = realloc(t->words, sizeof(uint64_t) * capacity);
+    if (!words) {
+      p->err = CUTILS_ALLOCATION_ERROR;
+      return false;
+    }
+    t->words = words;
+    t->capacity = capacity;
+  }
+  t->words[t->length++] = word;
+  return true;
+}
+
+static uint64_t _tape_word(char tag, uint64_t payload) {
+  return (uint64_t)(unsigned char)tag << 56 | payload;
+}
+
+// Decodes the string starting at `p->pos` onto the end of the side buffer.
+static bool _tape_string(parser_t *p) {
+  json_buffer_t *b = p->tape->strings;
+  size_t start = p->pos;
+  size_t len = 0;
+  bool escaped = false;
+  if (!_scan_chars(p, &len, &escaped)) {
+    return false;
+  }
+  if (len > UINT32_MAX) {
+    p->err = CUTILS_INDEX_ERROR;
+    return false;
+  }
+  if (p->views && !escaped) {
+    p->pos++; // Nothing was escaped, so leave it where it is
+    return _tape_push(p, _tape_word('s', start)) && _tape_push(p, len);
+  }
+
+  // Room for the terminator json_buffer_t keeps after the last string too
+  size_t needed = b->length + sizeof(uint32_t) + len + 2;
+  if (needed > b->capacity) {
+    size_t capacity = b->capacity * 2 > needed ? b->capacity * 2 : needed;
+    char *data = realloc(b->data, capacity);
+    if (!data) {
+      p->err = CUTILS_ALLOCATION_ERROR;
+      return false;
+    }
+    b->data = data;
+    b->capacity = capacity;
+  }
+
+  size_t offset = b->length;
+  if (!_unescape(p, start, &b->data[offset + sizeof(uint32_t)], &len)) {
+    return false;
+  }
+  uint32_t prefix = (uint32_t)len;
+  memcpy(&b->data[offset], &prefix, sizeof(uint32_t));
+  b->length += sizeof(uint32_t) + len + 1;
+  b->data[b->length] = '\0';
+
+  return _tape_push(p, _tape_word('"', offset));
+}
+
+static bool _tape_value(parser_t *p);
+
+// Elements or members up to `close`, then the open word is patched with the
+// count and the position of the close.
+static bool _tape_container(parser_t *p, char open, char close) {
+  json_tape_t *t = p->tape;
+  size_t start = t->length;
+  if (!_tape_push(p, 0)) {
+    return false;
+  }
+
+  size_t count = 0;
+  if (!_match(p, close)) {
+    do {
+      if (open == '{') {
+        _skip_whitespace(p);
+        if (_peek(p) != '"') {
+          p->err = CUTILS_JSON_PARSE_ERROR;
+          return false;
+        }
+        _advance(p); // Consume opening quote
+        if (!_tape_string(p)) {
+          return false;
+        }
+        if (!_match(p, ':')) {
+          p->err = CUTILS_JSON_PARSE_ERROR;
+          return false;
+        }
+      }
+      if (!_tape_value(p)) {
+        return false;
+      }
+      count++;
+      _release_behind(p);
+    } while (_match(p, ','));
+
+    if (!_match(p, close)) {
+      p->err = CUTILS_JSON_PARSE_ERROR;
+      return false;
+    }
+  }
+
+  if (t->length >= UINT32_MAX) {
+    p->err = CUTILS_INDEX_ERROR; // Too far for the open word to point
+    return false;
+  }
+  if (count > JSON_TAPE_COUNT_MAX) {
+    count = JSON_TAPE_COUNT_MAX;
+  }
+  t->words[start] = _tape_word(open, (uint64_t)count << 32 | t->length);
+  return _tape_push(p, _tape_word(close, start));
+}
+
+static bool _tape_value(parser_t *p) {
+  _skip_whitespace(p);
+  char c = _peek(p);
+  switch (c) {
+  case 'n':
+    return _scan_literal(p, "null") && _tape_push(p, _tape_word('n', 0));
+  case 't':
+    return _scan_literal(p, "true") && _tape_push(p, _tape_word('t', 0));
+  case 'f':
+    return _scan_literal(p, "false") && _tape_push(p, _tape_word('f', 0));
+  case '"':
+    _advance(p);
+    return _tape_string(p);
+  case '[':
+    _advance(p);
+    return _tape_container(p, '[', ']');
+  case '{':
+    _advance(p);
+    return _tape_container(p, '{', '}');
+  default:
+    if (c == '-' || isdigit(c)) {
+      double num;
+      uint64_t bits;
+      if (!_scan_number(p, &num)) {
+        return false;
+      }
+      memcpy(&bits, &num, sizeof(bits));
+      return _tape_push(p, _tape_word('d', 0)) && _tape_push(p, bits);
+    }
+    p->err = CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+}
+
+static cutils_error_t _tape_run(parser_t *p, bool indexed) {
+  json_tape_t *t = p->tape;
+  t->length = 0;
+  t->strings->length = 0;
+  t->strings->data[0] = '\0';
+  t->source = p->views ? p->text : NULL;
+
+  size_t length = p->length;
+  if (indexed && length >= JSON_INDEX_THRESHOLD && length < UINT32_MAX) {
+    cutils_error_t err = json_index_build(t->index, p->text, length);
+    if (err != CUTILS_SUCCESS) {
+      return err;
+    }
+    p->structurals = t->index->positions;
+  }
+
+  if (_tape_value(p)) {
+    _skip_whitespace(p);
+    if (p->pos < p->length) {
+      p->err = CUTILS_JSON_PARSE_ERROR;
+    }
+  }
+
+  if (p->err != CUTILS_SUCCESS) {
+    t->length = 0;
+    t->strings->length = 0;
+    t->strings->data[0] = '\0';
+  }
+  return p->err;
+}
+
+cutils_error_t json_tape_parse(json_tape_t *t, const char *text) {
+  if (!t || !text) {
+    return CUTILS_NULL_ERROR;
+  }
+  return json_tape_parse_n(t, text, strlen(text));
+}
+
+cutils_error_t json_tape_parse_n(json_tape_t *t, const char *text,
+                                 size_t length) {
+  if (!t || !text) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  parser_t p = {.text = text, .length = length, .tape = t};
+  return _tape_run(&p, true);
+}
+
+cutils_error_t json_parse_file(json_tape_t *t, json_file_t *f,
+                               const char *path, int flags) {
+  if (!t || !f || !path) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  cutils_error_t err = json_file_open(f, path);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  bool bounded = flags & JSON_FILE_BOUNDED;
+  parser_t p = {.text = f->data ? f->data : "",
+                .length = f->length,
+                .tape = t,
+                .views = flags & JSON_FILE_VIEWS,
+                .file = bounded ? f : NULL};
+  return _tape_run(&p, !bounded);
+}
+
+// Hands `e` to the handler, returning whether to carry on and through
+// `action` what it asked for.
+static bool _emit(parser_t *p, json_event_t e, json_action_t *action) {
+  json_action_t a = p->handler(p->ctx, &e);
+  if (a == JSON_STOP) {
+    p->stopped = true;
+    return false;
+  }
+  if (action) {
+    *action = a;
+  }
+  return true;
+}
+
+// Decodes the string starting at `p->pos` into the scratch buffer.
+static bool _scratch_string(parser_t *p, json_event_t *e) {
+  json_buffer_t *b = p->scratch;
+  size_t start = p->pos;
+  size_t len = 0;
+  if (!_scan_chars(p, &len, NULL)) {
+    return false;
+  }
+  if (len + 1 > b->capacity) {
+    char *data = realloc(b->data, len + 1);
+    if (!data) {
+      p->err = CUTILS_ALLOCATION_ERROR;
+      return false;
+    }
+    b->data = data;
+    b->capacity = len + 1;
+  }
+  if (!_unescape(p, start, b->data, &b->length)) {
+    return false;
+  }
+
+  e->string = b->data;
+  e->length = b->length;
+  return true;
+}
+
+// Passes over the rest of a string, opening quote already consumed.
+static bool _skip_string(parser_t *p) {
+  while (_peek(p) != '"') {
+    if (_peek(p) == '\0') {
+      p->err = CUTILS_JSON_PARSE_ERROR;
+      return false;
+    }
+    if (_advance(p) == '\\' && _peek(p) != '\0') {
+      p->pos++;
+    }
+  }
+  p->pos++; // Consume closing quote
+  return true;
+}
+
+// Passes over a value by bracket counting alone.
+static bool _skip_value(parser_t *p) {
+  _skip_whitespace(p);
+  double num;
+  switch (_peek(p)) {
+  case '"':
+    _advance(p);
+    return _skip_string(p);
+  case '[':
+  case '{':
+    break;
+  case 'n':
+    return _scan_literal(p, "null");
+  case 't':
+    return _scan_literal(p, "true");
+  case 'f':
+    return _scan_literal(p, "false");
+  default:
+    if (_peek(p) == '-' || isdigit(_peek(p))) {
+      return _scan_number(p, &num);
+    }
+    p->err = CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+
+  size_t depth = 0;
+  do {
+    switch (_advance(p)) {
+    case '\0':
+      p->pos--;
+      p->err = CUTILS_JSON_PARSE_ERROR;
+      return false;
+    case '"':
+      if (!_skip_string(p)) {
+        return false;
+      }
+      break;
+    case '[':
+    case '{':
+      depth++;
+      break;
+    case ']':
+    case '}':
+      depth--;
+      break;
+    }
+  } while (depth > 0);
+
+  return true;
+}
+
+static bool _event_value(parser_t *p, size_t depth);
+
+static bool _event_container(parser_t *p, size_t depth, bool object) {
+  json_event_t e = {.depth = depth};
+  e.type = object ? JSON_EVENT_START_OBJECT : JSON_EVENT_START_ARRAY;
+  json_action_t action = JSON_CONTINUE;
+  size_t start = p->pos;
+  if (!_emit(p, e, &action)) {
+    return false;
+  }
+  if (action == JSON_SKIP) {
+    p->pos = start - 1; // Back onto the bracket
+    return _skip_value(p);
+  }
+
+  char close = object ? '}' : ']';
+  if (!_match(p, close)) {
+    do {
+      action = JSON_CONTINUE;
+      if (object) {
+        _skip_whitespace(p);
+        if (_peek(p) != '"') {
+          p->err = CUTILS_JSON_PARSE_ERROR;
+          return false;
+        }
+        _advance(p); // Consume opening quote
+        json_event_t key = {.type = JSON_EVENT_KEY, .depth = depth + 1};
+        if (!_scratch_string(p, &key) || !_emit(p, key, &action)) {
+          return false;
+        }
+        if (!_match(p, ':')) {
+          p->err = CUTILS_JSON_PARSE_ERROR;
+          return false;
+        }
+      }
+      bool ok = action == JSON_SKIP ? _skip_value(p)
+                                    : _event_value(p, depth + 1);
+      if (!ok) {
+        return false;
+      }
+      _release_behind(p);
+    } while (_match(p, ','));
+
+    if (!_match(p, close)) {
+      p->err = CUTILS_JSON_PARSE_ERROR;
+      return false;
+    }
+  }
+
+  e.type = object ? JSON_EVENT_END_OBJECT : JSON_EVENT_END_ARRAY;
+  return _emit(p, e, NULL);
+}
+
+static bool _event_value(parser_t *p, size_t depth) {
+  _skip_whitespace(p);
+  json_event_t e = {.depth = depth};
+  char c = _peek(p);
+  switch (c) {
+  case 'n':
+    e.type = JSON_EVENT_NULL;
+    return _scan_literal(p, "null") && _emit(p, e, NULL);
+  case 't':
+  case 'f':
+    e.type = JSON_EVENT_BOOLEAN;
+    e.boolean = c == 't';
+    return _scan_literal(p, e.boolean ? "true" : "false") &&
+           _emit(p, e, NULL);
+  case '"':
+    _advance(p);
+    e.type = JSON_EVENT_STRING;
+    return _scratch_string(p, &e) && _emit(p, e, NULL);
+  case '[':
+  case '{':
+    _advance(p);
+    return _event_container(p, depth, c == '{');
+  default:
+    if (c == '-' || isdigit(c)) {
+      e.type = JSON_EVENT_NUMBER;
+      return _scan_number(p, &e.number) && _emit(p, e, NULL);
+    }
+    p->err = CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+}
+
+// No structural index: it would grow with the document.
+static cutils_error_t _events_run(parser_t *p) {
+  json_buffer_t scratch;
+  cutils_error_t err = json_buffer_init(&scratch, 0);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  p->scratch = &scratch;
+  if (_event_value(p, 0)) {
+    _skip_whitespace(p);
+    if (p->pos < p->length) {
+      p->err = CUTILS_JSON_PARSE_ERROR;
+    }
+  }
+  free(scratch.data);
+
+  return p->err;
+}
+
+cutils_error_t json_parse_events(const char *text, json_handler_t handler,
+                                 void *ctx) {
+  if (!text || !handler) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  parser_t p = {
+      .text = text, .length = strlen(text), .handler = handler, .ctx = ctx};
+  return _events_run(&p);
+}
+
+cutils_error_t json_parse_file_events(const char *path, json_handler_t handler,
+                                      void *ctx) {
+  if (!path || !handler) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  json_file_t *f = malloc(sizeof(json_file_t));
+  if (!f) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  cutils_error_t err = json_file_open(f, path);
+  if (err != CUTILS_SUCCESS) {
+    free(f);
+    return err;
+  }
+
+  parser_t p = {.text = f->data ? f->data : "",
+                .length = f->length,
+                .handler = handler,
+                .ctx = ctx,
+                .file = f};
+  err = _events_run(&p);
+  json_file_free(f);
+
+  return err;
+}
+
+cutils_error_t json_parser_init(json_parser_t *p, json_handler_t handler,
+                                void *ctx) {
+  if (!p) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  *p = (json_parser_t){.handler = handler, .ctx = ctx, .capacity = 16};
+  p->frames = malloc(p->capacity);
+  p->token = malloc(sizeof(json_buffer_t));
+  p->scratch = malloc(sizeof(json_buffer_t));
+  p->containers = malloc(sizeof(array_list_t));
+  if (!p->frames || !p->token || !p->scratch || !p->containers) {
+    free(p->frames);
+    free(p->token);
+    free(p->scratch);
+    free(p->containers);
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  cutils_error_t err = json_buffer_init(p->token, 0);
+  if (err == CUTILS_SUCCESS) {
+    err = json_buffer_init(p->scratch, 0);
+    if (err == CUTILS_SUCCESS) {
+      err = array_list_init(p->containers, 16, NULL, NULL);
+      if (err != CUTILS_SUCCESS) {
+        p->containers = NULL; // Already freed by array_list_init
+        free(p->scratch->data);
+      }
+    }
+    if (err != CUTILS_SUCCESS) {
+      free(p->token->data);
+    }
+  }
+  if (err != CUTILS_SUCCESS) {
+    free(p->frames);
+    free(p->token);
+    free(p->scratch);
+    free(p->containers);
+    return err;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void json_parser_free(void *ptr) {
+  if (ptr) {
+    json_parser_t *p = ptr;
+    json_parser_reset(p);
+    free(p->frames);
+    json_buffer_free(p->token);
+    json_buffer_free(p->scratch);
+    array_list_free(p->containers);
+    free(p);
+  }
+}
+
+void json_parser_reset(json_parser_t *p) {
+  if (!p) {
+    return;
+  }
+
+  json_value_free(p->value);
+  free(p->key);
+  p->value = NULL;
+  p->key = NULL;
+  p->containers->length = 0;
+  p->token->length = 0;
+  p->err = CUTILS_SUCCESS;
+  p->state = JSON_PARSER_VALUE;
+  p->lex = JSON_PARSER_NONE;
+  p->escaped = false;
+  p->decode = false;
+  p->stopped = false;
+  p->mute = 0;
+  p->depth = 0;
+}
+
+// Handler used when building a value. Containers are attached to their
+// parent as they open, so the partial tree always hangs off `p->value`.
+static json_action_t _build(void *ctx, json_event_t *e) {
+  json_parser_t *p = ctx;
+  array_list_t *open = p->containers;
+  if (e->type == JSON_EVENT_END_ARRAY || e->type == JSON_EVENT_END_OBJECT) {
+    open->length--;
+    return JSON_CONTINUE;
+  }
+
+  if (e->type == JSON_EVENT_KEY) {
+    p->key = malloc(e->length + 1);
+    if (!p->key) {
+      p->err = CUTILS_ALLOCATION_ERROR;
+      return JSON_STOP;
+    }
+    memcpy(p->key, e->string, e->length + 1);
+    return JSON_CONTINUE;
+  }
+
+  json_value_t *v = malloc(sizeof(json_value_t));
+  if (!v) {
+    p->err = CUTILS_ALLOCATION_ERROR;
+    return JSON_STOP;
+  }
+  *v = (json_value_t){.type = JSON_NULL};
+  cutils_error_t err = CUTILS_SUCCESS;
+  switch (e->type) {
+  case JSON_EVENT_BOOLEAN:
+    *v = (json_value_t){.type = JSON_BOOLEAN, .value.boolean = e->boolean};
+    break;
+  case JSON_EVENT_NUMBER:
+    *v = (json_value_t){.type = JSON_NUMBER, .value.number = e->number};
+    break;
+  case JSON_EVENT_STRING:
+    v->type = JSON_STRING;
+    v->value.string = malloc(e->length + 1);
+    if (v->value.string) {
+      memcpy(v->value.string, e->string, e->length + 1);
+    } else {
+      err = CUTILS_ALLOCATION_ERROR;
+    }
+    break;
+  case JSON_EVENT_START_ARRAY:
+    v->type = JSON_ARRAY;
+    v->value.array = malloc(sizeof(array_list_t));
+    err = CUTILS_ALLOCATION_ERROR;
+    if (v->value.array) {
+      err = array_list_init(v->value.array, 8, json_value_free, NULL);
+      if (err != CUTILS_SUCCESS) {
+        v->value.array = NULL; // Already freed by array_list_init
+      }
+    }
+    break;
+  case JSON_EVENT_START_OBJECT:
+    v->type = JSON_OBJECT;
+    v->value.object = malloc(sizeof(json_object_t));
+    err = v->value.object ? json_object_init(v->value.object, 0)
+                          : CUTILS_ALLOCATION_ERROR;
+    break;
+  default:
+    break;
+  }
+  if (err != CUTILS_SUCCESS) {
+    // Leave nothing half made for json_value_free to trip over
+    if (v->type == JSON_ARRAY || v->type == JSON_OBJECT) {
+      free(v->value.array);
+    }
+    free(v);
+    p->err = err;
+    return JSON_STOP;
+  }
+
+  if (open->length == 0) {
+    p->value = v;
+  } else {
+    json_value_t *parent = open->backing[open->length - 1];
+    if (parent->type == JSON_ARRAY) {
+      err = array_list_push(parent->value.array, v);
+    } else {
+      err = json_object_append(parent->value.object, p->key, v);
+      p->key = err == CUTILS_SUCCESS ? NULL : p->key;
+    }
+    if (err != CUTILS_SUCCESS) {
+      json_value_free(v);
+      p->err = err;
+      return JSON_STOP;
+    }
+  }
+
+  // Already in the tree, so freed with it on failure
+  bool container = v->type == JSON_ARRAY || v->type == JSON_OBJECT;
+  if (container && array_list_push(open, v) != CUTILS_SUCCESS) {
+    p->err = CUTILS_ALLOCATION_ERROR;
+    return JSON_STOP;
+  }
+
+  return JSON_CONTINUE;
+}
+
+// Hands `e` on unless a skipped value is being passed over.
+static bool _push_emit(json_parser_t *p, json_event_t e,
+                       json_action_t *action) {
+  json_action_t a = JSON_CONTINUE;
+  if (!p->mute) {
+    a = p->handler ? p->handler(p->ctx, &e) : _build(p, &e);
+  }
+  if (p->err != CUTILS_SUCCESS) {
+    return false;
+  }
+  if (a == JSON_STOP) {
+    p->stopped = true;
+    return false;
+  }
+  if (action) {
+    *action = a;
+  }
+  return true;
+}
+
+static void _value_done(json_parser_t *p) {
+  if (p->mute == p->depth + 1) {
+    p->mute = 0;
+  }
+  p->state = p->depth == 0 ? JSON_PARSER_DONE : JSON_PARSER_NEXT;
+}
+
+static bool _open(json_parser_t *p, char bracket) {
+  json_event_t e = {.depth = p->depth};
+  e.type = bracket == '[' ? JSON_EVENT_START_ARRAY : JSON_EVENT_START_OBJECT;
+  json_action_t action = JSON_CONTINUE;
+  if (!_push_emit(p, e, &action)) {
+    return false;
+  }
+  if (action == JSON_SKIP && !p->mute) {
+    p->mute = p->depth + 1;
+  }
+
+  if (p->depth == p->capacity) {
+    char *frames = realloc(p->frames, p->capacity * 2);
+    if (!frames) {
+      p->err = CUTILS_ALLOCATION_ERROR;
+      return false;
+    }
+    p->frames = frames;
+    p->capacity *= 2;
+  }
+  p->frames[p->depth++] = bracket;
+  p->state = bracket == '[' ? JSON_PARSER_FIRST_ELEMENT : JSON_PARSER_FIRST_KEY;
+  return true;
+}
+
+static bool _close(json_parser_t *p, char bracket) {
+  char open = p->frames[p->depth - 1];
+  if ((bracket == ']') != (open == '[')) {
+    p->err = CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+  p->depth--;
+
+  json_event_t e = {.depth = p->depth};
+  e.type = open == '[' ? JSON_EVENT_END_ARRAY : JSON_EVENT_END_OBJECT;
+  if (!_push_emit(p, e, NULL)) {
+    return false;
+  }
+  _value_done(p);
+  return true;
+}
+
+// Keeps room for the quote and NUL that _end_token adds.
+static bool _token_append(json_parser_t *p, const char *data, size_t n) {
+  json_buffer_t *b = p->token;
+  size_t needed = b->length + n + 2;
+  if (needed > b->capacity) {
+    size_t capacity = b->capacity * 2 > needed ? b->capacity * 2 : needed;
+    char *grown = realloc(b->data, capacity);
+    if (!grown) {
+      p->err = CUTILS_ALLOCATION_ERROR;
+      return false;
+    }
+    b->data = grown;
+    b->capacity = capacity;
+  }
+  memcpy(&b->data[b->length], data, n);
+  b->length += n;
+  return true;
+}
+
+// Decodes the finished token with the same helpers json_parse uses.
+static bool _end_token(json_parser_t *p) {
+  json_buffer_t *b = p->token;
+  json_parser_token_t lex = p->lex;
+  if (lex == JSON_PARSER_STRING || lex == JSON_PARSER_NAME) {
+    b->data[b->length++] = '"';
+  }
+  b->data[b->length] = '\0';
+  p->lex = JSON_PARSER_NONE;
+
+  parser_t t = {.text = b->data, .length = b->length, .scratch = p->scratch};
+  json_event_t e = {.depth = p->depth};
+  bool ok = true;
+  switch (lex) {
+  case JSON_PARSER_STRING:
+  case JSON_PARSER_NAME:
+    e.type = lex == JSON_PARSER_NAME ? JSON_EVENT_KEY : JSON_EVENT_STRING;
+    if (p->decode) {
+      ok = _scratch_string(&t, &e);
+    } else {
+      // Nothing to decode, so the token is the string
+      b->data[--b->length] = '\0';
+      e.string = b->data;
+      e.length = b->length;
+    }
+    p->decode = false;
+    break;
+  case JSON_PARSER_NUMBER:
+    e.type = JSON_EVENT_NUMBER;
+    ok = _scan_number(&t, &e.number);
+    break;
+  default:
+    e.type = b->data[0] == 'n' ? JSON_EVENT_NULL : JSON_EVENT_BOOLEAN;
+    e.boolean = b->data[0] == 't';
+    ok = strcmp(b->data, "null") == 0 || strcmp(b->data, "true") == 0 ||
+         strcmp(b->data, "false") == 0;
+    break;
+  }
+  b->length = 0;
+  if (!ok) {
+    p->err = t.err != CUTILS_SUCCESS ? t.err : CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+
+  json_action_t action = JSON_CONTINUE;
+  if (!_push_emit(p, e, &action)) {
+    return false;
+  }
+  if (lex == JSON_PARSER_NAME) {
+    if (action == JSON_SKIP && !p->mute) {
+      p->mute = p->depth + 1;
+    }
+    p->state = JSON_PARSER_COLON;
+  } else {
+    _value_done(p);
+  }
+  return true;
+}
+
+static bool _begin_value(json_parser_t *p, char c) {
+  if (c == '"') {
+    p->lex = JSON_PARSER_STRING;
+  } else if (c == '[' || c == '{') {
+    return _open(p, c);
+  } else if (c == '-' || isdigit(c)) {
+    p->lex = JSON_PARSER_NUMBER;
+    return _token_append(p, &c, 1);
+  } else if (c == 't' || c == 'f' || c == 'n') {
+    p->lex = JSON_PARSER_LITERAL;
+    return _token_append(p, &c, 1);
+  } else {
+    p->err = CUTILS_JSON_PARSE_ERROR;
+    return false;
+  }
+  return true;
+}
+
+// Handles one byte outside any token.
+static bool _step(json_parser_t *p, char c) {
+  json_parser_state_t state = p->state;
+  if ((state == JSON_PARSER_FIRST_ELEMENT && c == ']') ||
+      (state == JSON_PARSER_FIRST_KEY && c == '}') ||
+      (state == JSON_PARSER_NEXT && (c == ']' || c == '}'))) {
+    return _close(p, c);
+  }
+
+  switch (state) {
+  case JSON_PARSER_VALUE:
+  case JSON_PARSER_FIRST_ELEMENT:
+    return _begin_value(p, c);
+  case JSON_PARSER_KEY:
+  case JSON_PARSER_FIRST_KEY:
+    if (c == '"') {
+      p->lex = JSON_PARSER_NAME;
+      return true;
+    }
+    break;
+  case JSON_PARSER_COLON:
+    if (c == ':') {
+      p->state = JSON_PARSER_VALUE;
+      return true;
+    }
+    break;
+  case JSON_PARSER_NEXT:
+    if (c == ',') {
+      bool array = p->frames[p->depth - 1] == '[';
+      p->state = array ? JSON_PARSER_VALUE : JSON_PARSER_KEY;
+      return true;
+    }
+    break;
+  case JSON_PARSER_DONE:
+    break;
+  }
+
+  p->err = CUTILS_JSON_PARSE_ERROR;
+  return false;
+}
+
+static bool _literal_complete(json_buffer_t *b) {
+  return (b->length == 4 && (memcmp(b->data, "true", 4) == 0 ||
+                             memcmp(b->data, "null", 4) == 0)) ||
+         (b->length == 5 && memcmp(b->data, "false", 5) == 0);
+}
+
+static bool _in_token(json_parser_token_t lex, char c) {
+  if (lex == JSON_PARSER_NUMBER) {
+    return _is_number_char(c);
+  }
+  return c >= 'a' && c <= 'z';
+}
+
+cutils_error_t json_parser_feed(json_parser_t *p, const char *data,
+                                size_t length) {
+  if (!p || (!data && length > 0)) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t i = 0;
+  while (i < length && p->err == CUTILS_SUCCESS && !p->stopped) {
+    size_t start = i;
+    switch (p->lex) {
+    case JSON_PARSER_STRING:
+    case JSON_PARSER_NAME:
+      while (i < length) {
+        if (p->escaped) {
+          p->escaped = false;
+          i++;
+        }
+        while (i < length && data[i] != '"' && data[i] != '\\') {
+          i++;
+        }
+        if (i == length || data[i] == '"') {
+          break;
+        }
+        p->escaped = p->decode = true;
+        i++;
+      }
+      if (_token_append(p, &data[start], i - start) && i < length) {
+        i++; // Consume closing quote
+        _end_token(p);
+      }
+      break;
+    case JSON_PARSER_NUMBER:
+      while (i < length && _in_token(p->lex, data[i])) {
+        i++;
+      }
+      if (_token_append(p, &data[start], i - start) && i < length) {
+        _end_token(p);
+      }
+      break;
+    case JSON_PARSER_LITERAL:
+      // No literal is a prefix of another, so each ends on its last letter
+      while (i < length && _in_token(p->lex, data[i]) &&
+             !_literal_complete(p->token)) {
+        i++;
+        if (!_token_append(p, &data[i - 1], 1)) {
+          break;
+        }
+      }
+      if (p->err == CUTILS_SUCCESS &&
+          (i < length || _literal_complete(p->token))) {
+        _end_token(p);
+      }
+      break;
+    case JSON_PARSER_NONE:
+      if (!_is_whitespace(data[i])) {
+        _step(p, data[i]);
+      }
+      i++;
+      break;
+    }
+  }
+
+  return p->err;
+}
+
+cutils_error_t json_parser_finish(json_parser_t *p) {
+  if (!p) {
+    return CUTILS_NULL_ERROR;
+  }
+  if (p->err != CUTILS_SUCCESS || p->stopped) {
+    return p->err;
+  }
+
+  if (p->lex == JSON_PARSER_NUMBER || p->lex == JSON_PARSER_LITERAL) {
+    _end_token(p);
+  }
+  if (p->err == CUTILS_SUCCESS && p->state != JSON_PARSER_DONE) {
+    p->err = CUTILS_JSON_PARSE_ERROR;
+  }
+
+  return p->err;
+}
+
+cutils_error_t json_parser_take(json_parser_t *p, json_value_t **value) {
+  if (!p || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+  if (p->err != CUTILS_SUCCESS || p->state != JSON_PARSER_DONE || !p->value) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  *value = p->value;
+  p->value = NULL;
+  json_parser_reset(p);
 
   return CUTILS_SUCCESS;
 }
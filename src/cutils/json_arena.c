@@ -0,0 +1,96 @@
+#include "cutils/json.h"
+#include "cutils/errors.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define ARENA_ALIGN 8
+
+static void _enter(json_arena_t *a, json_arena_chunk_t *chunk) {
+  a->current = chunk;
+  a->cursor = chunk->data;
+  a->end = chunk->data + chunk->size;
+}
+
+cutils_error_t json_arena_init(json_arena_t *a, size_t chunk_size) {
+  if (!a) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  a->chunk_size = chunk_size > 0 ? chunk_size : JSON_ARENA_DEFAULT_CHUNK;
+  a->used = 0;
+  a->reserved = 0;
+  a->first = NULL;
+  a->current = NULL;
+  a->cursor = NULL;
+  a->end = NULL;
+
+  return CUTILS_SUCCESS;
+}
+
+void json_arena_free(void *ptr) {
+  if (ptr) {
+    json_arena_t *a = ptr;
+    json_arena_chunk_t *chunk = a->first;
+    while (chunk) {
+      json_arena_chunk_t *next = chunk->next;
+      free(chunk);
+      chunk = next;
+    }
+    free(a);
+  }
+}
+
+// Moves on to the next kept chunk with room, or adds one after the current.
+static void *_alloc_slow(json_arena_t *a, size_t size) {
+  while (a->current && a->current->next) {
+    _enter(a, a->current->next);
+    if (size <= (size_t)(a->end - a->cursor)) {
+      void *ptr = a->cursor;
+      a->cursor += size;
+      return ptr;
+    }
+  }
+
+  size_t chunk_size = size > a->chunk_size ? size : a->chunk_size;
+  json_arena_chunk_t *chunk =
+      malloc(sizeof(json_arena_chunk_t) + chunk_size);
+  if (!chunk) {
+    return NULL;
+  }
+  chunk->next = NULL;
+  chunk->size = chunk_size;
+  a->reserved += chunk_size;
+  if (a->current) {
+    a->current->next = chunk;
+  } else {
+    a->first = chunk;
+  }
+
+  _enter(a, chunk);
+  a->cursor += size;
+  return chunk->data;
+}
+
+void *json_arena_alloc(json_arena_t *a, size_t size) {
+  if (!a) {
+    return NULL;
+  }
+
+  size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+  a->used += size;
+  if (size <= (size_t)(a->end - a->cursor)) {
+    void *ptr = a->cursor;
+    a->cursor += size;
+    return ptr;
+  }
+
+  return _alloc_slow(a, size);
+}
+
+void json_arena_reset(json_arena_t *a) {
+  if (a && a->first) {
+    a->used = 0;
+    _enter(a, a->first);
+  }
+}
@@ -0,0 +1,70 @@
+#include "cutils/json.h"
+#include "cutils/errors.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+cutils_error_t json_file_open(json_file_t *f, const char *path) {
+  if (!f || !path) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  f->data = NULL;
+  f->length = 0;
+  f->released = 0;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return CUTILS_IO_ERROR;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return CUTILS_IO_ERROR;
+  }
+  if (st.st_size == 0) {
+    close(fd); // Nothing to map; parsing reports the empty document
+    return CUTILS_SUCCESS;
+  }
+
+  void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping keeps the file open
+  if (data == MAP_FAILED) {
+    return CUTILS_IO_ERROR;
+  }
+  // Hints only, so failures are ignored
+  madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+  madvise(data, (size_t)st.st_size, MADV_HUGEPAGE);
+#endif
+
+  f->data = data;
+  f->length = (size_t)st.st_size;
+
+  return CUTILS_SUCCESS;
+}
+
+void json_file_free(void *ptr) {
+  if (ptr) {
+    json_file_t *f = ptr;
+    if (f->data) {
+      munmap((void *)f->data, f->length);
+    }
+    free(f);
+  }
+}
+
+void json_file_release(json_file_t *f, size_t offset) {
+  if (!f || !f->data) {
+    return;
+  }
+
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t end = (offset < f->length ? offset : f->length) / page * page;
+  if (end > f->released) {
+    madvise((char *)f->data + f->released, end - f->released, MADV_DONTNEED);
+    f->released = end;
+  }
+}
@@ -0,0 +1,256 @@
+#include "cutils/json.h"
+#include "cutils/errors.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define JSON_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// One bit per byte of a 64-byte block.
+typedef struct {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t whitespace;
+  uint64_t op;
+} masks_t;
+
+// Carried from one block to the next.
+typedef struct {
+  uint64_t escaped;   // First byte of the block is escaped
+  uint64_t in_string; // All ones while inside a string
+  uint64_t scalar;    // Last byte of the block was part of a scalar
+} scanner_t;
+
+enum { CLASS_QUOTE = 1, CLASS_BACKSLASH = 2, CLASS_SPACE = 4, CLASS_OP = 8 };
+
+static const uint8_t _classes[256] = {
+    ['"'] = CLASS_QUOTE, ['\\'] = CLASS_BACKSLASH, [' '] = CLASS_SPACE,
+    ['\t'] = CLASS_SPACE, ['\n'] = CLASS_SPACE,    ['\r'] = CLASS_SPACE,
+    ['{'] = CLASS_OP,     ['}'] = CLASS_OP,        ['['] = CLASS_OP,
+    [']'] = CLASS_OP,     [':'] = CLASS_OP,        [','] = CLASS_OP};
+
+static void _classify_scalar(const char *block, masks_t *m) {
+  *m = (masks_t){0, 0, 0, 0};
+  for (size_t i = 0; i < 64; i++) {
+    uint8_t c = _classes[(unsigned char)block[i]];
+    uint64_t bit = (uint64_t)1 << i;
+    m->quote |= c & CLASS_QUOTE ? bit : 0;
+    m->backslash |= c & CLASS_BACKSLASH ? bit : 0;
+    m->whitespace |= c & CLASS_SPACE ? bit : 0;
+    m->op |= c & CLASS_OP ? bit : 0;
+  }
+}
+
+#ifdef JSON_X86_SIMD
+
+// OR-ing in 0x20 folds '[' onto '{' and ']' onto '}', saving two compares.
+__attribute__((target("avx2"))) static void _classify_avx2(const char *block,
+                                                          masks_t *m) {
+  *m = (masks_t){0, 0, 0, 0};
+  for (size_t i = 0; i < 64; i += 32) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)&block[i]);
+    __m256i folded = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+    __m256i quote = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('"'));
+    __m256i backslash = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\'));
+    __m256i space = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')),
+                        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r'))));
+    __m256i op = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                        _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(':')),
+                        _mm256_cmpeq_epi8(x, _mm256_set1_epi8(','))));
+    m->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(quote) << i;
+    m->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(backslash) << i;
+    m->whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(space) << i;
+    m->op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(op) << i;
+  }
+}
+
+__attribute__((target("sse4.2"))) static void _classify_sse42(const char *block,
+                                                             masks_t *m) {
+  *m = (masks_t){0, 0, 0, 0};
+  for (size_t i = 0; i < 64; i += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i *)&block[i]);
+    __m128i folded = _mm_or_si128(x, _mm_set1_epi8(0x20));
+    __m128i quote = _mm_cmpeq_epi8(x, _mm_set1_epi8('"'));
+    __m128i backslash = _mm_cmpeq_epi8(x, _mm_set1_epi8('\\'));
+    __m128i space =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+                                  _mm_cmpeq_epi8(x, _mm_set1_epi8('\t'))),
+                     _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')),
+                                  _mm_cmpeq_epi8(x, _mm_set1_epi8('\r'))));
+    __m128i op =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                  _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+                     _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(':')),
+                                  _mm_cmpeq_epi8(x, _mm_set1_epi8(','))));
+    m->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(quote) << i;
+    m->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(backslash) << i;
+    m->whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(space) << i;
+    m->op |= (uint64_t)(uint16_t)_mm_movemask_epi8(op) << i;
+  }
+}
+
+#endif // JSON_X86_SIMD
+
+static void (*classify)(const char *, masks_t *) = _classify_scalar;
+static pthread_once_t classify_once = PTHREAD_ONCE_INIT;
+
+static void _select_classify(void) {
+#ifdef JSON_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    classify = _classify_avx2;
+  } else if (__builtin_cpu_supports("sse4.2")) {
+    classify = _classify_sse42;
+  }
+#endif
+}
+
+// Bytes escaped by a backslash: the byte after each odd-length run.
+static uint64_t _escaped(scanner_t *s, uint64_t backslash) {
+  const uint64_t even = 0x5555555555555555ull;
+  backslash &= ~s->escaped;
+  uint64_t follows = backslash << 1 | s->escaped;
+
+  // Adding run starts to the runs carries out of each run; runs starting on
+  // an odd bit are cleared out first so only the even ones carry
+  uint64_t odd_starts = backslash & ~even & ~follows;
+  uint64_t even_runs;
+  s->escaped = __builtin_add_overflow(odd_starts, backslash, &even_runs);
+  return (even ^ (even_runs << 1)) & follows;
+}
+
+// Bit i set when an odd number of bits at or below i are set.
+static uint64_t _prefix_xor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+static uint64_t _structurals(scanner_t *s, const masks_t *m) {
+  uint64_t quote = m->quote & ~_escaped(s, m->backslash);
+  uint64_t in_string = _prefix_xor(quote) ^ s->in_string;
+  s->in_string = (uint64_t)0 - (in_string >> 63);
+
+  // Inside strings, plus the closing quote
+  uint64_t tail = in_string ^ quote;
+
+  uint64_t scalar = ~(m->op | m->whitespace);
+  uint64_t nonquote = scalar & ~quote;
+  uint64_t follows = nonquote << 1 | s->scalar;
+  s->scalar = nonquote >> 63;
+
+  return (m->op | (scalar & ~follows)) & ~tail;
+}
+
+static bool _reserve(json_index_t *idx, size_t n) {
+  if (idx->length + n <= idx->capacity) {
+    return true;
+  }
+
+  size_t capacity = idx->capacity;
+  while (idx->length + n > capacity) {
+    capacity *= 2;
+  }
+  uint32_t *positions = realloc(idx->positions, sizeof(uint32_t) * capacity);
+  if (!positions) {
+    return false;
+  }
+  idx->positions = positions;
+  idx->capacity = capacity;
+
+  return true;
+}
+
+static cutils_error_t _build(json_index_t *idx, const char *text,
+                             size_t length,
+                             void (*kernel)(const char *, masks_t *)) {
+  if (!idx || !text) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (length >= UINT32_MAX) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  idx->length = 0;
+  scanner_t s = {0, 0, 0};
+  for (size_t base = 0; base < length; base += 64) {
+    masks_t m;
+    if (length - base >= 64) {
+      kernel(&text[base], &m);
+    } else {
+      // Pad the last block with whitespace
+      char block[64];
+      memset(block, ' ', sizeof(block));
+      memcpy(block, &text[base], length - base);
+      kernel(block, &m);
+    }
+
+    uint64_t bits = _structurals(&s, &m);
+    if (!_reserve(idx, 64)) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+    uint32_t *out = &idx->positions[idx->length];
+    while (bits) {
+      *out++ = (uint32_t)(base + __builtin_ctzll(bits));
+      bits &= bits - 1;
+    }
+    idx->length = (size_t)(out - idx->positions);
+  }
+
+  if (!_reserve(idx, 1)) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  idx->positions[idx->length++] = (uint32_t)length;
+
+  return s.in_string ? CUTILS_JSON_PARSE_ERROR : CUTILS_SUCCESS;
+}
+
+cutils_error_t json_index_init(json_index_t *idx, size_t capacity) {
+  if (!idx) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  idx->length = 0;
+  idx->capacity = capacity > 0 ? capacity : 64;
+  idx->positions = malloc(sizeof(uint32_t) * idx->capacity);
+  if (!idx->positions) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void json_index_free(void *ptr) {
+  if (ptr) {
+    json_index_t *idx = ptr;
+    free(idx->positions);
+    free(idx);
+  }
+}
+
+cutils_error_t json_index_build(json_index_t *idx, const char *text,
+                                size_t length) {
+  pthread_once(&classify_once, _select_classify);
+  return _build(idx, text, length, classify);
+}
+
+cutils_error_t json_index_build_scalar(json_index_t *idx, const char *text,
+                                       size_t length) {
+  return _build(idx, text, length, _classify_scalar);
+}
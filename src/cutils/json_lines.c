@@ -0,0 +1,198 @@
+#include "cutils/json.h"
+#include "cutils/errors.h"
+#include "cutils/thread_pool.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  const char *text;
+  size_t begin;
+  size_t end;
+  size_t seen; // Lines started in [begin, end), blank ones included
+  size_t length;
+  size_t capacity;
+  json_line_t *lines;
+  cutils_error_t err;
+} chunk_t;
+
+typedef struct {
+  const char *text;
+  size_t length;
+  size_t pos; // Where the next chunk begins
+  size_t nchunks;
+  json_line_handler_t handler;
+  void *ctx;
+  thread_pool_t *pool;
+  json_file_t *file;
+} lines_t;
+
+static bool _blank(const char *line, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r') {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void _parse_chunk(void *arg) {
+  chunk_t *c = arg;
+  size_t pos = c->begin;
+  while (pos < c->end) {
+    const char *newline = memchr(&c->text[pos], '\n', c->end - pos);
+    size_t stop = newline ? (size_t)(newline - c->text) : c->end;
+    c->seen++;
+
+    if (!_blank(&c->text[pos], stop - pos)) {
+      if (c->length == c->capacity) {
+        size_t capacity = c->capacity > 0 ? c->capacity * 2 : 64;
+        json_line_t *lines = realloc(c->lines, sizeof(json_line_t) * capacity);
+        if (!lines) {
+          c->err = CUTILS_ALLOCATION_ERROR;
+          return;
+        }
+        c->lines = lines;
+        c->capacity = capacity;
+      }
+      json_line_t *line = &c->lines[c->length++];
+      line->number = c->seen;
+      line->offset = pos;
+      line->value = NULL;
+      line->err = json_parse_n(&c->text[pos], stop - pos, &line->value);
+    }
+    pos = stop + 1;
+  }
+}
+
+// Where a chunk starting at `begin` ends: just past the first line break at
+// least JSON_LINES_CHUNK bytes in, or at the end of the input.
+static size_t _chunk_end(lines_t *r, size_t begin) {
+  if (r->length - begin <= JSON_LINES_CHUNK) {
+    return r->length;
+  }
+  size_t from = begin + JSON_LINES_CHUNK - 1;
+  const char *newline = memchr(&r->text[from], '\n', r->length - from);
+  return newline ? (size_t)(newline - r->text) + 1 : r->length;
+}
+
+// Cuts the next batch of chunks and starts parsing them, returning how many
+// there are. Chunks the pool turns down are parsed here.
+static size_t _submit(lines_t *r, chunk_t *batch) {
+  size_t count = 0;
+  while (count < r->nchunks && r->pos < r->length) {
+    chunk_t *c = &batch[count++];
+    c->text = r->text;
+    c->begin = r->pos;
+    c->end = _chunk_end(r, r->pos);
+    c->seen = 0;
+    c->length = 0;
+    c->err = CUTILS_SUCCESS;
+    r->pos = c->end;
+
+    if (!r->pool ||
+        thread_pool_submit(r->pool, _parse_chunk, c) != CUTILS_SUCCESS) {
+      _parse_chunk(c);
+    }
+  }
+  return count;
+}
+
+// Alternates between two batches: while one is handed to the handler in
+// order, the pool parses the next.
+static cutils_error_t _lines_run(lines_t *r) {
+  r->nchunks = r->pool ? r->pool->nthreads * 2 : 1;
+  chunk_t *batches = calloc(r->nchunks * 2, sizeof(chunk_t));
+  if (!batches) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  cutils_error_t err = CUTILS_SUCCESS;
+  bool stopped = false;
+  size_t base = 0;
+  size_t current = 0;
+  size_t count = _submit(r, batches);
+  while (count > 0) {
+    if (r->pool) {
+      thread_pool_wait(r->pool);
+    }
+    chunk_t *done = &batches[current * r->nchunks];
+    size_t ndone = count;
+    current ^= 1;
+    count = stopped || err != CUTILS_SUCCESS
+                ? 0
+                : _submit(r, &batches[current * r->nchunks]);
+
+    for (size_t i = 0; i < ndone; i++) {
+      chunk_t *c = &done[i];
+      for (size_t j = 0; j < c->length; j++) {
+        json_line_t *line = &c->lines[j];
+        if (stopped || err != CUTILS_SUCCESS) {
+          json_value_free(line->value);
+          continue;
+        }
+        line->number += base;
+        stopped = r->handler(r->ctx, line) == JSON_STOP;
+      }
+      if (c->err != CUTILS_SUCCESS && err == CUTILS_SUCCESS) {
+        err = c->err;
+      }
+      base += c->seen;
+    }
+    if (r->file) {
+      json_file_release(r->file, done[ndone - 1].end);
+    }
+  }
+
+  for (size_t i = 0; i < r->nchunks * 2; i++) {
+    free(batches[i].lines);
+  }
+  free(batches);
+
+  return err;
+}
+
+cutils_error_t json_parse_lines(const char *text, size_t length,
+                                json_line_handler_t handler, void *ctx,
+                                thread_pool_t *pool) {
+  if (!text || !handler) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  lines_t r = {.text = text,
+               .length = length,
+               .handler = handler,
+               .ctx = ctx,
+               .pool = pool};
+  return _lines_run(&r);
+}
+
+cutils_error_t json_parse_lines_file(const char *path,
+                                     json_line_handler_t handler, void *ctx,
+                                     thread_pool_t *pool) {
+  if (!path || !handler) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  json_file_t *f = malloc(sizeof(json_file_t));
+  if (!f) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  cutils_error_t err = json_file_open(f, path);
+  if (err != CUTILS_SUCCESS) {
+    free(f);
+    return err;
+  }
+
+  lines_t r = {.text = f->data,
+               .length = f->length,
+               .handler = handler,
+               .ctx = ctx,
+               .pool = pool,
+               .file = f};
+  err = _lines_run(&r);
+  json_file_free(f);
+
+  return err;
+}
@@ -0,0 +1,192 @@
+#include "cutils/json.h"
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// FNV-1a.
+static uint64_t _hash(const char *key) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  while (*key) {
+    hash = (hash ^ (unsigned char)*key++) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+static void *_alloc(json_object_t *o, size_t size) {
+  return o->arena ? json_arena_alloc(o->arena, size) : malloc(size);
+}
+
+static void _release(json_object_t *o, void *ptr) {
+  if (!o->arena) {
+    free(ptr);
+  }
+}
+
+cutils_error_t json_object_init(json_object_t *o, size_t capacity) {
+  if (!o) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  o->length = 0;
+  o->capacity = capacity;
+  o->members = NULL;
+  o->nslots = 0;
+  o->slots = NULL;
+  o->arena = NULL;
+  if (capacity > 0) {
+    o->members = malloc(sizeof(json_member_t) * capacity);
+    if (!o->members) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void json_object_free(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+
+  json_object_t *o = ptr;
+  if (o->arena) {
+    return; // Released with the arena
+  }
+  for (size_t i = 0; i < o->length; i++) {
+    free(o->members[i].key);
+    json_value_free(o->members[i].value);
+  }
+  free(o->members);
+  free(o->slots);
+  free(o);
+}
+
+// Slot holding `key`, or the empty one where it would go.
+static size_t _probe(json_object_t *o, const char *key) {
+  size_t mask = o->nslots - 1;
+  size_t i = _hash(key) & mask;
+  while (o->slots[i] && strcmp(o->members[o->slots[i] - 1].key, key) != 0) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+// Sized to stay at most half full. Later members take over the slot of an
+// earlier one with the same key.
+static bool _build_index(json_object_t *o) {
+  size_t nslots = 16;
+  while (nslots < 2 * o->length) {
+    nslots *= 2;
+  }
+  uint32_t *slots = _alloc(o, sizeof(uint32_t) * nslots);
+  if (!slots) {
+    return false;
+  }
+  memset(slots, 0, sizeof(uint32_t) * nslots);
+
+  _release(o, o->slots);
+  o->slots = slots;
+  o->nslots = nslots;
+  for (size_t i = 0; i < o->length; i++) {
+    o->slots[_probe(o, o->members[i].key)] = (uint32_t)(i + 1);
+  }
+
+  return true;
+}
+
+// Position of the last member named `key`, or the length when there is none.
+static size_t _find(json_object_t *o, const char *key) {
+  if (!o->slots && o->length > JSON_OBJECT_INDEX_THRESHOLD) {
+    _build_index(o); // Without memory for it, scanning still works
+  }
+
+  if (o->slots) {
+    uint32_t slot = o->slots[_probe(o, key)];
+    return slot ? slot - 1 : o->length;
+  }
+
+  for (size_t i = o->length; i > 0; i--) {
+    if (strcmp(o->members[i - 1].key, key) == 0) {
+      return i - 1;
+    }
+  }
+  return o->length;
+}
+
+cutils_error_t json_object_get(json_object_t *o, const char *key,
+                               json_value_t **value) {
+  if (!o || !key || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t i = _find(o, key);
+  if (i == o->length) {
+    return CUTILS_INDEX_ERROR;
+  }
+  *value = o->members[i].value;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t json_object_append(json_object_t *o, char *key,
+                                  json_value_t *value) {
+  if (!o || !key || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (o->length == o->capacity) {
+    size_t capacity = o->capacity > 0 ? o->capacity * 2 : 4;
+    json_member_t *members = NULL;
+    if (o->arena) {
+      members = json_arena_alloc(o->arena, sizeof(json_member_t) * capacity);
+      if (members && o->length > 0) {
+        memcpy(members, o->members, sizeof(json_member_t) * o->length);
+      }
+    } else {
+      members = realloc(o->members, sizeof(json_member_t) * capacity);
+    }
+    if (!members) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+    o->members = members;
+    o->capacity = capacity;
+  }
+  o->members[o->length++] = (json_member_t){key, value};
+
+  if (o->slots) {
+    if (2 * o->length > o->nslots) {
+      if (!_build_index(o)) {
+        _release(o, o->slots);
+        o->slots = NULL;
+        o->nslots = 0;
+      }
+    } else {
+      o->slots[_probe(o, key)] = (uint32_t)o->length;
+    }
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t json_object_set(json_object_t *o, char *key,
+                               json_value_t *value) {
+  if (!o || !key || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t i = _find(o, key);
+  if (i == o->length) {
+    return json_object_append(o, key, value);
+  }
+
+  if (!o->arena) {
+    free(o->members[i].key);
+    json_value_free(o->members[i].value);
+  }
+  o->members[i] = (json_member_t){key, value};
+
+  return CUTILS_SUCCESS;
+}
@@ -0,0 +1,558 @@
+#include "cutils/json.h"
+#include "cutils/array_list.h"
+#include "cutils/errors.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SINK_CAPACITY 4096
+
+typedef struct {
+  json_buffer_t *out;
+  json_sink_t sink; // NULL when writing straight into `out`
+  void *ctx;
+  json_format_t format;
+  size_t depth;
+  cutils_error_t err;
+} writer_t;
+
+cutils_error_t json_buffer_init(json_buffer_t *b, size_t capacity) {
+  if (!b) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  b->length = 0;
+  b->capacity = capacity > 0 ? capacity : 64;
+  b->data = malloc(b->capacity);
+  if (!b->data) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  b->data[0] = '\0';
+
+  return CUTILS_SUCCESS;
+}
+
+void json_buffer_free(void *ptr) {
+  if (ptr) {
+    json_buffer_t *b = ptr;
+    free(b->data);
+    free(b);
+  }
+}
+
+// Makes room for `n` more bytes plus the terminator, flushing to the sink
+// first when there is one.
+static bool _reserve(writer_t *w, size_t n) {
+  if (w->err != CUTILS_SUCCESS) {
+    return false;
+  }
+
+  json_buffer_t *b = w->out;
+  if (b->length + n < b->capacity) {
+    return true;
+  }
+
+  if (w->sink && b->length > 0) {
+    cutils_error_t err = w->sink(w->ctx, b->data, b->length);
+    b->length = 0;
+    if (err != CUTILS_SUCCESS) {
+      w->err = err;
+      return false;
+    }
+    if (n < b->capacity) {
+      return true;
+    }
+  }
+
+  size_t capacity = b->capacity;
+  while (b->length + n >= capacity) {
+    capacity *= 2;
+  }
+  char *data = realloc(b->data, capacity);
+  if (!data) {
+    w->err = CUTILS_ALLOCATION_ERROR;
+    return false;
+  }
+  b->data = data;
+  b->capacity = capacity;
+
+  return true;
+}
+
+static void _write(writer_t *w, const char *data, size_t n) {
+  if (_reserve(w, n)) {
+    memcpy(&w->out->data[w->out->length], data, n);
+    w->out->length += n;
+  }
+}
+
+static void _write_char(writer_t *w, char c) {
+  if (_reserve(w, 1)) {
+    w->out->data[w->out->length++] = c;
+  }
+}
+
+static void _newline(writer_t *w) {
+  if (w->format != JSON_FORMAT_PRETTY) {
+    return;
+  }
+
+  size_t n = 1 + 2 * w->depth;
+  if (_reserve(w, n)) {
+    char *p = &w->out->data[w->out->length];
+    p[0] = '\n';
+    memset(&p[1], ' ', n - 1);
+    w->out->length += n;
+  }
+}
+
+// Diy-fp and Grisu2 after Loitsch, "Printing Floating-Point Numbers Quickly
+// and Accurately with Integers" (PLDI 2010). The output always parses back to
+// the same double and is the shortest such form in all but rare cases.
+typedef struct {
+  uint64_t f;
+  int e;
+} diy_fp_t;
+
+// 10^k for k = -348, -340, ..., 340, normalized to a 64-bit significand.
+static const uint64_t _powers_f[] = {
+    0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull,
+    0xcf42894a5dce35eaull, 0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull,
+    0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full, 0xbe5691ef416bd60cull,
+    0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+    0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull,
+    0xc21094364dfb5637ull, 0x9096ea6f3848984full, 0xd77485cb25823ac7ull,
+    0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull, 0xb23867fb2a35b28eull,
+    0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+    0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull,
+    0xb5b5ada8aaff80b8ull, 0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull,
+    0x964e858c91ba2655ull, 0xdff9772470297ebdull, 0xa6dfbd9fb8e5b88full,
+    0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+    0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull,
+    0xaa242499697392d3ull, 0xfd87b5f28300ca0eull, 0xbce5086492111aebull,
+    0x8cbccc096f5088ccull, 0xd1b71758e219652cull, 0x9c40000000000000ull,
+    0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+    0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull,
+    0x9f4f2726179a2245ull, 0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull,
+    0x83c7088e1aab65dbull, 0xc45d1df942711d9aull, 0x924d692ca61be758ull,
+    0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+    0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull,
+    0x952ab45cfa97a0b3ull, 0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull,
+    0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull, 0x88fcf317f22241e2ull,
+    0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+    0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull,
+    0x8bab8eefb6409c1aull, 0xd01fef10a657842cull, 0x9b10a4e5e9913129ull,
+    0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull, 0x80444b5e7aa7cf85ull,
+    0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+    0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull,
+};
+
+static const int16_t _powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954,
+    -927, -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635,
+    -608, -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316,
+    -289, -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30, 56,
+    83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348, 375, 402, 428, 455,
+    481, 508, 534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800, 827, 853,
+    880, 907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t _pow10[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+    100000000ull, 1000000000ull, 10000000000ull, 100000000000ull,
+    1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+    1000000000000000000ull, 10000000000000000000ull};
+
+static diy_fp_t _diy_from_double(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  int biased = (int)((bits >> 52) & 0x7FF);
+  uint64_t significand = bits & (((uint64_t)1 << 52) - 1);
+  if (biased != 0) {
+    return (diy_fp_t){significand + ((uint64_t)1 << 52), biased - 1075};
+  }
+  return (diy_fp_t){significand, -1074};
+}
+
+static diy_fp_t _diy_normalize(diy_fp_t x) {
+  int shift = __builtin_clzll(x.f);
+  return (diy_fp_t){x.f << shift, x.e - shift};
+}
+
+// Upper 64 bits of the 128-bit product, rounded.
+static diy_fp_t _diy_mul(diy_fp_t x, diy_fp_t y) {
+  const uint64_t mask = 0xFFFFFFFFull;
+  uint64_t a = x.f >> 32, b = x.f & mask;
+  uint64_t c = y.f >> 32, d = y.f & mask;
+  uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t mid = (bd >> 32) + (ad & mask) + (bc & mask) + ((uint64_t)1 << 31);
+  return (diy_fp_t){ac + (ad >> 32) + (bc >> 32) + (mid >> 32),
+                    x.e + y.e + 64};
+}
+
+// Halfway points to the neighbouring doubles, sharing the upper's exponent.
+static void _boundaries(diy_fp_t v, diy_fp_t *minus, diy_fp_t *plus) {
+  *plus = _diy_normalize((diy_fp_t){(v.f << 1) + 1, v.e - 1});
+  if (v.f == ((uint64_t)1 << 52)) {
+    // The gap below a power of two is half as wide
+    *minus = (diy_fp_t){(v.f << 2) - 1, v.e - 2};
+  } else {
+    *minus = (diy_fp_t){(v.f << 1) - 1, v.e - 1};
+  }
+  minus->f <<= minus->e - plus->e;
+  minus->e = plus->e;
+}
+
+// Picks 10^-k so that scaling by it leaves a binary exponent in [-60, -32].
+static diy_fp_t _cached_power(int e, int *k) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int ik = (int)dk;
+  if (dk - ik > 0.0) {
+    ik++;
+  }
+  size_t index = (size_t)((ik >> 3) + 1);
+  *k = -(-348 + (int)index * 8);
+  return (diy_fp_t){_powers_f[index], _powers_e[index]};
+}
+
+static int _count_digits(uint32_t n) {
+  int digits = 1;
+  while (digits < 10 && n >= _pow10[digits]) {
+    digits++;
+  }
+  return digits;
+}
+
+// Nudges the last digit down while that brings it closer to the exact value
+// and stays inside the rounding interval.
+static void _grisu_round(char *buffer, int length, uint64_t delta,
+                         uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+    buffer[length - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+static void _digit_gen(diy_fp_t w, diy_fp_t mp, uint64_t delta, char *buffer,
+                       int *length, int *k) {
+  int shift = -mp.e;
+  uint64_t one = (uint64_t)1 << shift;
+  uint64_t wp_w = mp.f - w.f;
+  uint32_t p1 = (uint32_t)(mp.f >> shift);
+  uint64_t p2 = mp.f & (one - 1);
+  int kappa = _count_digits(p1);
+  *length = 0;
+
+  // Integral part
+  while (kappa > 0) {
+    uint32_t div = (uint32_t)_pow10[kappa - 1];
+    uint32_t d = p1 / div;
+    p1 %= div;
+    if (d || *length) {
+      buffer[(*length)++] = (char)('0' + d);
+    }
+    kappa--;
+    uint64_t rest = ((uint64_t)p1 << shift) + p2;
+    if (rest <= delta) {
+      *k += kappa;
+      _grisu_round(buffer, *length, delta, rest, _pow10[kappa] << shift,
+                   wp_w);
+      return;
+    }
+  }
+
+  // Fractional part
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    char d = (char)(p2 >> shift);
+    if (d || *length) {
+      buffer[(*length)++] = (char)('0' + d);
+    }
+    p2 &= one - 1;
+    kappa--;
+    if (p2 < delta) {
+      *k += kappa;
+      int index = -kappa;
+      _grisu_round(buffer, *length, delta, p2, one,
+                   index < 20 ? wp_w * _pow10[index] : 0);
+      return;
+    }
+  }
+}
+
+// Writes the digits of positive, finite `value` as buffer[0..length) * 10^k.
+static void _grisu2(double value, char *buffer, int *length, int *k) {
+  diy_fp_t v = _diy_from_double(value);
+  diy_fp_t minus, plus;
+  _boundaries(v, &minus, &plus);
+
+  diy_fp_t c = _cached_power(plus.e, k);
+  diy_fp_t w = _diy_mul(_diy_normalize(v), c);
+  diy_fp_t wp = _diy_mul(plus, c);
+  diy_fp_t wm = _diy_mul(minus, c);
+  wm.f++;
+  wp.f--;
+  _digit_gen(w, wp, wp.f - wm.f, buffer, length, k);
+}
+
+static size_t _format_u64(uint64_t n, char *buffer) {
+  char digits[20];
+  size_t length = 0;
+  do {
+    digits[length++] = (char)('0' + n % 10);
+    n /= 10;
+  } while (n > 0);
+  for (size_t i = 0; i < length; i++) {
+    buffer[i] = digits[length - 1 - i];
+  }
+  return length;
+}
+
+static size_t _format_exponent(int e, char *buffer) {
+  size_t length = 0;
+  if (e < 0) {
+    buffer[length++] = '-';
+    e = -e;
+  }
+  return length + _format_u64((uint64_t)e, &buffer[length]);
+}
+
+// Lays out digits * 10^k as plain or exponent notation, as JavaScript does.
+static size_t _prettify(char *buffer, int length, int k) {
+  int kk = length + k; // 10^(kk - 1) <= value < 10^kk
+
+  if (k >= 0 && kk <= 21) {
+    // 1234e7 -> 12340000000
+    memset(&buffer[length], '0', (size_t)k);
+    return (size_t)kk;
+  }
+  if (kk > 0 && kk <= 21) {
+    // 1234e-2 -> 12.34
+    memmove(&buffer[kk + 1], &buffer[kk], (size_t)(length - kk));
+    buffer[kk] = '.';
+    return (size_t)length + 1;
+  }
+  if (kk > -6 && kk <= 0) {
+    // 1234e-6 -> 0.001234
+    int offset = 2 - kk;
+    memmove(&buffer[offset], buffer, (size_t)length);
+    buffer[0] = '0';
+    buffer[1] = '.';
+    memset(&buffer[2], '0', (size_t)(offset - 2));
+    return (size_t)(length + offset);
+  }
+  if (length == 1) {
+    // 1e30
+    buffer[1] = 'e';
+    return 2 + _format_exponent(kk - 1, &buffer[2]);
+  }
+  // 1234e30 -> 1.234e33
+  memmove(&buffer[2], &buffer[1], (size_t)(length - 1));
+  buffer[1] = '.';
+  buffer[length + 1] = 'e';
+  return (size_t)length + 2 + _format_exponent(kk - 1, &buffer[length + 2]);
+}
+
+// `buffer` needs room for 32 bytes.
+static size_t _format_number(double value, char *buffer) {
+  if (isnan(value) || isinf(value)) {
+    memcpy(buffer, "null", 4);
+    return 4;
+  }
+
+  size_t sign = 0;
+  if (signbit(value)) {
+    buffer[sign++] = '-';
+    value = -value;
+  }
+  if (value == 0) {
+    buffer[sign] = '0';
+    return sign + 1;
+  }
+
+  // Integers are the common case and need no digit search
+  if (value < 9007199254740992.0 && value == (double)(uint64_t)value) {
+    return sign + _format_u64((uint64_t)value, &buffer[sign]);
+  }
+
+  int length, k;
+  _grisu2(value, &buffer[sign], &length, &k);
+  return sign + _prettify(&buffer[sign], length, k);
+}
+
+// Second character of the escape for each byte that needs one, else 0.
+static const char _escapes[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', ['"'] = '"', ['\\'] = '\\'};
+
+// True when none of the eight bytes is a control character, quote or
+// backslash.
+static bool _is_clean(uint64_t x) {
+  const uint64_t ones = 0x0101010101010101ull;
+  uint64_t quote = x ^ (ones * '"');
+  uint64_t slash = x ^ (ones * '\\');
+  uint64_t hits = ((x - ones * 0x20) & ~x) | ((quote - ones) & ~quote) |
+                  ((slash - ones) & ~slash);
+  return (hits & (ones * 0x80)) == 0;
+}
+
+static void _write_string(writer_t *w, const char *s) {
+  static const char hex[] = "0123456789abcdef";
+  size_t length = strlen(s);
+  if (!_reserve(w, length + 2)) {
+    return;
+  }
+  _write_char(w, '"');
+
+  // Runs needing no escapes are found a word at a time and copied whole
+  const char *run = s;
+  const char *p = s;
+  const char *end = s + length;
+  while (p < end) {
+    while (end - p >= 8) {
+      uint64_t x;
+      memcpy(&x, p, sizeof(x));
+      if (!_is_clean(x)) {
+        break;
+      }
+      p += 8;
+    }
+    while (p < end && !_escapes[(unsigned char)*p]) {
+      p++;
+    }
+    if (p == end) {
+      break;
+    }
+
+    _write(w, run, (size_t)(p - run));
+    unsigned char c = (unsigned char)*p++;
+    if (_escapes[c] == 'u') {
+      char seq[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+      _write(w, seq, sizeof(seq));
+    } else {
+      char seq[2] = {'\\', _escapes[c]};
+      _write(w, seq, sizeof(seq));
+    }
+    run = p;
+  }
+  _write(w, run, (size_t)(end - run));
+  _write_char(w, '"');
+}
+
+static void _write_value(writer_t *w, json_value_t *v);
+
+static void _write_array(writer_t *w, array_list_t *l) {
+  _write_char(w, '[');
+  if (l->length > 0) {
+    w->depth++;
+    for (size_t i = 0; i < l->length; i++) {
+      if (i > 0) {
+        _write_char(w, ',');
+      }
+      _newline(w);
+      _write_value(w, l->backing[i]);
+    }
+    w->depth--;
+    _newline(w);
+  }
+  _write_char(w, ']');
+}
+
+static void _write_object(writer_t *w, json_object_t *o) {
+  _write_char(w, '{');
+  if (o->length > 0) {
+    w->depth++;
+    for (size_t i = 0; i < o->length; i++) {
+      if (i > 0) {
+        _write_char(w, ',');
+      }
+      _newline(w);
+      _write_string(w, o->members[i].key);
+      if (w->format == JSON_FORMAT_PRETTY) {
+        _write(w, ": ", 2);
+      } else {
+        _write_char(w, ':');
+      }
+      _write_value(w, o->members[i].value);
+    }
+    w->depth--;
+    _newline(w);
+  }
+  _write_char(w, '}');
+}
+
+static void _write_value(writer_t *w, json_value_t *v) {
+  if (w->err != CUTILS_SUCCESS) {
+    return;
+  }
+
+  switch (v->type) {
+  case JSON_NULL:
+    _write(w, "null", 4);
+    break;
+  case JSON_BOOLEAN:
+    if (v->value.boolean) {
+      _write(w, "true", 4);
+    } else {
+      _write(w, "false", 5);
+    }
+    break;
+  case JSON_NUMBER: {
+    char buffer[32];
+    _write(w, buffer, _format_number(v->value.number, buffer));
+  } break;
+  case JSON_STRING:
+    _write_string(w, v->value.string);
+    break;
+  case JSON_ARRAY:
+    _write_array(w, v->value.array);
+    break;
+  case JSON_OBJECT:
+    _write_object(w, v->value.object);
+    break;
+  }
+}
+
+cutils_error_t json_stringify(json_value_t *v, json_format_t format,
+                              json_buffer_t *out) {
+  if (!v || !out) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  writer_t w = {out, NULL, NULL, format, 0, CUTILS_SUCCESS};
+  _write_value(&w, v);
+  if (w.err == CUTILS_SUCCESS) {
+    out->data[out->length] = '\0';
+  }
+
+  return w.err;
+}
+
+cutils_error_t json_stringify_sink(json_value_t *v, json_format_t format,
+                                   json_sink_t sink, void *ctx) {
+  if (!v || !sink) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  json_buffer_t staging;
+  cutils_error_t err = json_buffer_init(&staging, SINK_CAPACITY);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  writer_t w = {&staging, sink, ctx, format, 0, CUTILS_SUCCESS};
+  _write_value(&w, v);
+  if (w.err == CUTILS_SUCCESS && staging.length > 0) {
+    w.err = sink(ctx, staging.data, staging.length);
+  }
+  free(staging.data);
+
+  return w.err;
+}
@@ -0,0 +1,213 @@
+#include "cutils/json.h"
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+cutils_error_t json_tape_init(json_tape_t *t, size_t capacity) {
+  if (!t) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  t->length = 0;
+  t->capacity = capacity;
+  t->words = NULL;
+  t->strings = malloc(sizeof(json_buffer_t));
+  t->index = malloc(sizeof(json_index_t));
+  if (capacity > 0) {
+    t->words = malloc(sizeof(uint64_t) * capacity);
+  }
+  if (!t->strings || !t->index || (capacity > 0 && !t->words)) {
+    free(t->strings);
+    free(t->index);
+    free(t->words);
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  cutils_error_t err = json_buffer_init(t->strings, 0);
+  if (err == CUTILS_SUCCESS) {
+    err = json_index_init(t->index, 0);
+    if (err != CUTILS_SUCCESS) {
+      free(t->strings->data);
+    }
+  }
+  if (err != CUTILS_SUCCESS) {
+    free(t->strings);
+    free(t->index);
+    free(t->words);
+    return err;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void json_tape_free(void *ptr) {
+  if (ptr) {
+    json_tape_t *t = ptr;
+    free(t->words);
+    json_buffer_free(t->strings);
+    json_index_free(t->index);
+    free(t);
+  }
+}
+
+// Tag at `pos`, or NUL past the end so that lookups there fail.
+static char _tag(json_tape_t *t, size_t pos) {
+  return pos < t->length ? JSON_TAPE_TAG(t->words[pos]) : '\0';
+}
+
+json_type_t json_tape_type(json_tape_t *t, size_t pos) {
+  switch (JSON_TAPE_TAG(t->words[pos])) {
+  case 't':
+  case 'f':
+    return JSON_BOOLEAN;
+  case 'd':
+    return JSON_NUMBER;
+  case '"':
+  case 's':
+    return JSON_STRING;
+  case '[':
+    return JSON_ARRAY;
+  case '{':
+    return JSON_OBJECT;
+  default:
+    return JSON_NULL;
+  }
+}
+
+size_t json_tape_next(json_tape_t *t, size_t pos) {
+  uint64_t word = t->words[pos];
+  switch (JSON_TAPE_TAG(word)) {
+  case '[':
+  case '{':
+    return (size_t)(word & 0xffffffffu) + 1;
+  case 'd':
+  case 's':
+    return pos + 2;
+  default:
+    return pos + 1;
+  }
+}
+
+size_t json_tape_end(json_tape_t *t, size_t pos) {
+  uint64_t word = t->words[pos];
+  char tag = JSON_TAPE_TAG(word);
+  return tag == '[' || tag == '{' ? (size_t)(word & 0xffffffffu) : pos + 1;
+}
+
+cutils_error_t json_tape_length(json_tape_t *t, size_t pos, size_t *length) {
+  if (!t || !length) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  char tag = _tag(t, pos);
+  if (tag != '[' && tag != '{') {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  size_t count = (size_t)(JSON_TAPE_PAYLOAD(t->words[pos]) >> 32);
+  if (count == JSON_TAPE_COUNT_MAX) {
+    // Too many to store, so count them
+    count = 0;
+    size_t end = json_tape_end(t, pos);
+    for (size_t i = pos + 1; i < end; i = json_tape_next(t, i)) {
+      count++;
+    }
+    count = tag == '{' ? count / 2 : count;
+  }
+  *length = count;
+
+  return CUTILS_SUCCESS;
+}
+
+// The string word at `pos` as a pointer to its bytes and their count.
+static const char *_string(json_tape_t *t, size_t pos, size_t *length) {
+  uint64_t offset = JSON_TAPE_PAYLOAD(t->words[pos]);
+  if (JSON_TAPE_TAG(t->words[pos]) == 's') {
+    *length = (size_t)t->words[pos + 1];
+    return &t->source[offset];
+  }
+
+  const char *data = &t->strings->data[offset];
+  uint32_t prefix;
+  memcpy(&prefix, data, sizeof(uint32_t));
+  *length = prefix;
+  return data + sizeof(uint32_t);
+}
+
+cutils_error_t json_tape_find(json_tape_t *t, size_t pos, const char *key,
+                              size_t *value) {
+  if (!t || !key || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+  if (_tag(t, pos) != '{') {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  // Every member is read so that a repeated key resolves to the last one
+  size_t key_length = strlen(key);
+  size_t end = json_tape_end(t, pos);
+  bool found = false;
+  for (size_t i = pos + 1; i < end; i = json_tape_next(t, i)) {
+    size_t length;
+    const char *name = _string(t, i, &length);
+    i = json_tape_next(t, i);
+    if (length == key_length && memcmp(name, key, length) == 0) {
+      *value = i;
+      found = true;
+    }
+  }
+
+  return found ? CUTILS_SUCCESS : CUTILS_INDEX_ERROR;
+}
+
+cutils_error_t json_tape_get_boolean(json_tape_t *t, size_t pos, bool *value) {
+  if (!t || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  char tag = _tag(t, pos);
+  if (tag != 't' && tag != 'f') {
+    return CUTILS_INDEX_ERROR;
+  }
+  *value = tag == 't';
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t json_tape_get_number(json_tape_t *t, size_t pos,
+                                    double *value) {
+  if (!t || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+  if (_tag(t, pos) != 'd') {
+    return CUTILS_INDEX_ERROR;
+  }
+  memcpy(value, &t->words[pos + 1], sizeof(double));
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t json_tape_get_string(json_tape_t *t, size_t pos,
+                                    const char **value, size_t *length) {
+  if (!t || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+  char tag = _tag(t, pos);
+  if (tag != '"' && tag != 's') {
+    return CUTILS_INDEX_ERROR;
+  }
+  if (tag == 's' && !length) {
+    return CUTILS_NULL_ERROR; // No NUL to find the end by
+  }
+
+  size_t n;
+  *value = _string(t, pos, &n);
+  if (length) {
+    *length = n;
+  }
+
+  return CUTILS_SUCCESS;
+}
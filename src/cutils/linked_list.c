@@ -14,6 +14,88 @@ linked_list_node_t *linked_list_node_init(void *value) {
   return n;
 }
 
+typedef struct slab {
+  struct slab *next;
+  linked_list_node_t nodes[];
+} slab_t;
+
+cutils_error_t linked_list_pool_init(linked_list_pool_t *p, size_t slab_nodes) {
+  if (!p) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  p->slab_nodes = slab_nodes > 0 ? slab_nodes : LINKED_LIST_POOL_SLAB_NODES;
+  p->free_nodes = NULL;
+  p->slabs = NULL;
+
+  return CUTILS_SUCCESS;
+}
+
+void linked_list_pool_free(void *ptr) {
+  if (ptr) {
+    linked_list_pool_t *p = ptr;
+    slab_t *curr = p->slabs;
+    while (curr) {
+      slab_t *next = curr->next;
+      free(curr);
+      curr = next;
+    }
+    free(p);
+  }
+}
+
+linked_list_node_t *linked_list_pool_alloc(linked_list_pool_t *p, void *value) {
+  if (!p) {
+    return NULL;
+  }
+
+  if (!p->free_nodes) {
+    slab_t *slab =
+        malloc(sizeof(slab_t) + sizeof(linked_list_node_t) * p->slab_nodes);
+    if (!slab) {
+      return NULL;
+    }
+    slab->next = p->slabs;
+    p->slabs = slab;
+
+    for (size_t i = p->slab_nodes; i > 0; i--) {
+      slab->nodes[i - 1].next = p->free_nodes;
+      p->free_nodes = &slab->nodes[i - 1];
+    }
+  }
+
+  linked_list_node_t *n = p->free_nodes;
+  p->free_nodes = n->next;
+
+  n->prev = NULL;
+  n->next = NULL;
+  n->value = value;
+
+  return n;
+}
+
+void linked_list_pool_release(linked_list_pool_t *p, linked_list_node_t *node) {
+  if (p && node) {
+    node->next = p->free_nodes;
+    p->free_nodes = node;
+  }
+}
+
+static linked_list_node_t *_node_alloc(linked_list_t *l, void *value) {
+  if (l->pool) {
+    return linked_list_pool_alloc(l->pool, value);
+  }
+  return linked_list_node_init(value);
+}
+
+static void _node_release(linked_list_t *l, linked_list_node_t *node) {
+  if (l->pool) {
+    linked_list_pool_release(l->pool, node);
+  } else {
+    free(node);
+  }
+}
+
 cutils_error_t linked_list_init(linked_list_t *l, void (*inner_free)(void *),
                                 void (*outer_free)(void (*)(void *), void *)) {
   if (!l) {
@@ -25,6 +107,31 @@ cutils_error_t linked_list_init(linked_list_t *l, void (*inner_free)(void *),
   l->tail = NULL;
   l->inner_free = inner_free;
   l->outer_free = outer_free;
+  l->pool = NULL;
+  l->owns_pool = false;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t linked_list_init_pooled(linked_list_t *l,
+                                       linked_list_pool_t *pool,
+                                       void (*inner_free)(void *),
+                                       void (*outer_free)(void (*)(void *),
+                                                          void *)) {
+  cutils_error_t err = linked_list_init(l, inner_free, outer_free);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  if (!pool) {
+    pool = malloc(sizeof(linked_list_pool_t));
+    if (!pool) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+    linked_list_pool_init(pool, LINKED_LIST_POOL_SLAB_NODES);
+    l->owns_pool = true;
+  }
+  l->pool = pool;
 
   return CUTILS_SUCCESS;
 }
@@ -33,14 +140,23 @@ void linked_list_free(void *ptr) {
   if (ptr) {
     linked_list_t *l = ptr;
 
-    linked_list_node_t *curr = l->head;
+    // A private pool goes away a slab at a time, so its nodes only need
+    // visiting when their values have to be freed
+    bool walk = !l->owns_pool || l->inner_free || l->outer_free;
+    linked_list_node_t *curr = walk ? l->head : NULL;
     while (curr) {
       linked_list_node_t *next = curr->next;
       linked_list_free_value(l, curr);
-      free(curr);
+      if (!l->owns_pool) {
+        _node_release(l, curr);
+      }
       curr = next;
     }
 
+    if (l->owns_pool) {
+      linked_list_pool_free(l->pool);
+    }
+
     free(l);
   }
 }
@@ -58,6 +174,44 @@ void linked_list_free_value(linked_list_t *l, linked_list_node_t *node) {
   }
 }
 
+// Walks from whichever end of the list is closer to `idx`.
+static linked_list_node_t *_node_at(linked_list_t *l, size_t idx) {
+  linked_list_node_t *curr = NULL;
+  if (idx < l->length / 2) {
+    curr = l->head;
+    for (size_t i = 0; i < idx; i++) {
+      curr = curr->next;
+    }
+  } else {
+    curr = l->tail;
+    for (size_t i = l->length - 1; i > idx; i--) {
+      curr = curr->prev;
+    }
+  }
+  return curr;
+}
+
+// Links `node` in front of `pos`, or at the tail when `pos` is NULL.
+static void _link_before(linked_list_t *l, linked_list_node_t *pos,
+                         linked_list_node_t *node) {
+  node->next = pos;
+  node->prev = pos ? pos->prev : l->tail;
+
+  if (node->prev) {
+    node->prev->next = node;
+  } else {
+    l->head = node;
+  }
+
+  if (pos) {
+    pos->prev = node;
+  } else {
+    l->tail = node;
+  }
+
+  l->length++;
+}
+
 cutils_error_t linked_list_insert_at(linked_list_t *l, size_t idx,
                                      void *value) {
   if (!l) {
@@ -68,43 +222,34 @@ cutils_error_t linked_list_insert_at(linked_list_t *l, size_t idx,
     return CUTILS_INDEX_ERROR;
   }
 
-  linked_list_node_t *node = linked_list_node_init(value);
-  if (!node) {
+  linked_list_node_t *pos = idx < l->length ? _node_at(l, idx) : NULL;
+  return linked_list_insert_before(l, pos, value);
+}
+
+cutils_error_t linked_list_insert_before(linked_list_t *l,
+                                         linked_list_node_t *node,
+                                         void *value) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  linked_list_node_t *n = _node_alloc(l, value);
+  if (!n) {
     return CUTILS_ALLOCATION_ERROR;
   }
+  _link_before(l, node, n);
 
-  if (idx == 0) {
-    node->next = l->head;
-    if (l->head) {
-      l->head->prev = node;
-    }
-    l->head = node;
-    if (!l->tail) {
-      l->tail = node;
-    }
-  } else if (idx == l->length) {
-    node->prev = l->tail;
-    if (l->tail) {
-      l->tail->next = node;
-    }
-    l->tail = node;
-  } else {
-    linked_list_node_t *curr = l->head;
-    for (size_t i = 0; i < idx; i++) {
-      curr = curr->next;
-    }
+  return CUTILS_SUCCESS;
+}
 
-    node->next = curr;
-    node->prev = curr->prev;
-    if (curr->prev) {
-      curr->prev->next = node;
-    }
-    curr->prev = node;
+cutils_error_t linked_list_insert_after(linked_list_t *l,
+                                        linked_list_node_t *node,
+                                        void *value) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
   }
 
-  l->length++;
-
-  return CUTILS_SUCCESS;
+  return linked_list_insert_before(l, node ? node->next : l->head, value);
 }
 
 cutils_error_t linked_list_push_front(linked_list_t *l, void *value) {
@@ -125,32 +270,33 @@ cutils_error_t linked_list_remove_at(linked_list_t *l, size_t idx,
     return CUTILS_INDEX_ERROR;
   }
 
-  linked_list_node_t *curr = l->head;
-  for (size_t i = 0; i < idx; i++) {
-    curr = curr->next;
-  }
-
-  if (value) {
-    *value = curr->value;
-  }
+  return linked_list_remove_node(l, _node_at(l, idx), value);
+}
 
-  if (curr->prev) {
-    curr->prev->next = curr->next;
+cutils_error_t linked_list_remove_node(linked_list_t *l,
+                                       linked_list_node_t *node,
+                                       void **value) {
+  if (!l || !node) {
+    return CUTILS_NULL_ERROR;
   }
 
-  if (curr->next) {
-    curr->next->prev = curr->prev;
+  if (value) {
+    *value = node->value;
   }
 
-  if (curr == l->head) {
-    l->head = curr->next;
+  if (node->prev) {
+    node->prev->next = node->next;
+  } else {
+    l->head = node->next;
   }
 
-  if (curr == l->tail) {
-    l->tail = curr->prev;
+  if (node->next) {
+    node->next->prev = node->prev;
+  } else {
+    l->tail = node->prev;
   }
 
-  free(curr);
+  _node_release(l, node);
 
   l->length--;
 
@@ -174,12 +320,7 @@ cutils_error_t linked_list_get(linked_list_t *l, size_t idx, void **value) {
     return CUTILS_INDEX_ERROR;
   }
 
-  linked_list_node_t *curr = l->head;
-  for (size_t i = 0; i < idx; i++) {
-    curr = curr->next;
-  }
-
-  *value = curr->value;
+  *value = _node_at(l, idx)->value;
 
   return CUTILS_SUCCESS;
 }
@@ -193,11 +334,7 @@ cutils_error_t linked_list_set(linked_list_t *l, size_t idx, void *value) {
     return CUTILS_INDEX_ERROR;
   }
 
-  linked_list_node_t *curr = l->head;
-  for (size_t i = 0; i < idx; i++) {
-    curr = curr->next;
-  }
-
+  linked_list_node_t *curr = _node_at(l, idx);
   linked_list_free_value(l, curr);
   curr->value = value;
 
@@ -221,3 +358,329 @@ cutils_error_t linked_list_find(linked_list_t *l, void *value,
 
   return CUTILS_SUCCESS;
 }
+
+// Nodes may only change lists when both lists release them to the same place.
+static bool _same_pool(linked_list_t *a, linked_list_t *b) {
+  return a->pool == b->pool;
+}
+
+// Rebuilds the `prev` links and tail of `l` from a NULL-terminated `next`
+// chain starting at `head`.
+static void _relink(linked_list_t *l, linked_list_node_t *head) {
+  linked_list_node_t *prev = NULL;
+  for (linked_list_node_t *curr = head; curr; curr = curr->next) {
+    curr->prev = prev;
+    prev = curr;
+  }
+  l->head = head;
+  l->tail = prev;
+}
+
+// Stable merge of two sorted runs linked through `next` only; ties take the
+// node from `a`.
+static linked_list_node_t *_merge_runs(linked_list_node_t *a,
+                                       linked_list_node_t *b,
+                                       int (*cmp)(void *, void *)) {
+  linked_list_node_t head;
+  linked_list_node_t *tail = &head;
+  while (a && b) {
+    if (cmp(b->value, a->value) < 0) {
+      tail->next = b;
+      b = b->next;
+    } else {
+      tail->next = a;
+      a = a->next;
+    }
+    tail = tail->next;
+  }
+  tail->next = a ? a : b;
+  return head.next;
+}
+
+cutils_error_t linked_list_sort(linked_list_t *l, int (*cmp)(void *, void *)) {
+  if (!l || !cmp) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  // Bottom-up: runs[i] holds a sorted run of 2^i nodes, and each new node
+  // carries up through the occupied slots like a binary counter. Lower slots
+  // always hold later nodes, which keeps the sort stable.
+  linked_list_node_t *runs[64] = {NULL};
+  size_t nruns = 0;
+  linked_list_node_t *curr = l->head;
+  while (curr) {
+    linked_list_node_t *run = curr;
+    curr = curr->next;
+    run->next = NULL;
+
+    size_t i = 0;
+    for (; runs[i]; i++) {
+      run = _merge_runs(runs[i], run, cmp);
+      runs[i] = NULL;
+    }
+    runs[i] = run;
+    nruns = i + 1 > nruns ? i + 1 : nruns;
+  }
+
+  linked_list_node_t *sorted = NULL;
+  for (size_t i = 0; i < nruns; i++) {
+    if (runs[i]) {
+      sorted = sorted ? _merge_runs(runs[i], sorted, cmp) : runs[i];
+    }
+  }
+  _relink(l, sorted);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t linked_list_splice(linked_list_t *dst, linked_list_node_t *pos,
+                                  linked_list_t *src) {
+  if (!dst || !src) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (dst == src) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (!_same_pool(dst, src)) {
+    return CUTILS_POOL_ERROR;
+  }
+
+  if (src->length == 0) {
+    return CUTILS_SUCCESS;
+  }
+
+  linked_list_node_t *before = pos ? pos->prev : dst->tail;
+  src->head->prev = before;
+  if (before) {
+    before->next = src->head;
+  } else {
+    dst->head = src->head;
+  }
+
+  src->tail->next = pos;
+  if (pos) {
+    pos->prev = src->tail;
+  } else {
+    dst->tail = src->tail;
+  }
+
+  dst->length += src->length;
+  src->length = 0;
+  src->head = NULL;
+  src->tail = NULL;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t linked_list_concat(linked_list_t *dst, linked_list_t *src) {
+  return linked_list_splice(dst, NULL, src);
+}
+
+// Orders heap slots by the head value of their list, then by list index.
+static bool _heap_less(linked_list_t **srcs, size_t a, size_t b,
+                       int (*cmp)(void *, void *)) {
+  int c = cmp(srcs[a]->head->value, srcs[b]->head->value);
+  return c < 0 || (c == 0 && a < b);
+}
+
+static void _heap_sift_down(size_t *heap, size_t n, size_t i,
+                            linked_list_t **srcs, int (*cmp)(void *, void *)) {
+  for (;;) {
+    size_t min = i;
+    size_t left = 2 * i + 1;
+    size_t right = left + 1;
+    if (left < n && _heap_less(srcs, heap[left], heap[min], cmp)) {
+      min = left;
+    }
+    if (right < n && _heap_less(srcs, heap[right], heap[min], cmp)) {
+      min = right;
+    }
+    if (min == i) {
+      return;
+    }
+
+    size_t tmp = heap[i];
+    heap[i] = heap[min];
+    heap[min] = tmp;
+    i = min;
+  }
+}
+
+cutils_error_t linked_list_merge(linked_list_t *dst, linked_list_t **srcs,
+                                 size_t k, int (*cmp)(void *, void *)) {
+  if (!dst || (!srcs && k > 0) || !cmp) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  for (size_t i = 0; i < k; i++) {
+    if (!srcs[i]) {
+      return CUTILS_NULL_ERROR;
+    }
+    if (srcs[i] == dst) {
+      return CUTILS_INDEX_ERROR;
+    }
+    if (!_same_pool(dst, srcs[i])) {
+      return CUTILS_POOL_ERROR;
+    }
+  }
+
+  size_t *heap = malloc(sizeof(size_t) * (k > 0 ? k : 1));
+  if (!heap) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  size_t n = 0;
+  for (size_t i = 0; i < k; i++) {
+    if (srcs[i]->head) {
+      heap[n++] = i;
+    }
+  }
+  for (size_t i = n / 2; i > 0; i--) {
+    _heap_sift_down(heap, n, i - 1, srcs, cmp);
+  }
+
+  // Sources are only detached from their heads here; their prev links and
+  // counts are reset once everything has moved
+  while (n > 0) {
+    linked_list_t *src = srcs[heap[0]];
+    linked_list_node_t *node = src->head;
+    src->head = node->next;
+
+    node->prev = dst->tail;
+    node->next = NULL;
+    if (dst->tail) {
+      dst->tail->next = node;
+    } else {
+      dst->head = node;
+    }
+    dst->tail = node;
+
+    if (!src->head) {
+      heap[0] = heap[--n];
+    }
+    _heap_sift_down(heap, n, 0, srcs, cmp);
+  }
+
+  for (size_t i = 0; i < k; i++) {
+    dst->length += srcs[i]->length;
+    srcs[i]->length = 0;
+    srcs[i]->tail = NULL;
+  }
+  free(heap);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t linked_list_cursor_init(linked_list_cursor_t *c,
+                                       linked_list_t *l) {
+  if (!c || !l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  c->list = l;
+  c->node = l->head;
+  c->idx = 0;
+
+  return CUTILS_SUCCESS;
+}
+
+bool linked_list_cursor_valid(linked_list_cursor_t *c) {
+  return c && c->node;
+}
+
+cutils_error_t linked_list_cursor_next(linked_list_cursor_t *c) {
+  if (!c) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!c->node) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  c->node = c->node->next;
+  c->idx++;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t linked_list_cursor_prev(linked_list_cursor_t *c) {
+  if (!c) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  linked_list_node_t *prev = c->node ? c->node->prev : c->list->tail;
+  if (!prev) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  c->node = prev;
+  c->idx--;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t linked_list_cursor_get(linked_list_cursor_t *c, void **value) {
+  if (!c || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!c->node) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  *value = c->node->value;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t linked_list_cursor_set(linked_list_cursor_t *c, void *value) {
+  if (!c) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!c->node) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  linked_list_free_value(c->list, c->node);
+  c->node->value = value;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t linked_list_cursor_insert(linked_list_cursor_t *c,
+                                         void *value) {
+  if (!c) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  cutils_error_t err = linked_list_insert_before(c->list, c->node, value);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+  c->idx++;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t linked_list_cursor_remove(linked_list_cursor_t *c,
+                                         void **value) {
+  if (!c) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!c->node) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  linked_list_node_t *next = c->node->next;
+  cutils_error_t err = linked_list_remove_node(c->list, c->node, value);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+  c->node = next;
+
+  return CUTILS_SUCCESS;
+}
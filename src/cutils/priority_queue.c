@@ -0,0 +1,305 @@
+#include "cutils/priority_queue.h"
+#include "cutils/array_list.h"
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static void _place(priority_queue_t *q, size_t idx, void *value) {
+  q->items->backing[idx] = value;
+  if (q->set_index) {
+    q->set_index(value, idx);
+  }
+}
+
+// Both sifts carry the moving value in a hole and write it once at the end.
+static size_t _sift_up(priority_queue_t *q, size_t idx) {
+  void **a = q->items->backing;
+  void *value = a[idx];
+  while (idx > 0) {
+    size_t parent = (idx - 1) / q->arity;
+    if (q->cmp(value, a[parent]) >= 0) {
+      break;
+    }
+    _place(q, idx, a[parent]);
+    idx = parent;
+  }
+  _place(q, idx, value);
+  return idx;
+}
+
+static void _sift_down(priority_queue_t *q, size_t idx) {
+  void **a = q->items->backing;
+  size_t n = q->items->length;
+  void *value = a[idx];
+  for (;;) {
+    size_t first = idx * q->arity + 1;
+    if (first >= n) {
+      break;
+    }
+
+    size_t last = first + q->arity < n ? first + q->arity : n;
+    size_t best = first;
+    for (size_t c = first + 1; c < last; c++) {
+      best = q->cmp(a[c], a[best]) < 0 ? c : best;
+    }
+    if (q->cmp(a[best], value) >= 0) {
+      break;
+    }
+    _place(q, idx, a[best]);
+    idx = best;
+  }
+  _place(q, idx, value);
+}
+
+static void _heapify(priority_queue_t *q) {
+  size_t n = q->items->length;
+  for (size_t i = 0; q->set_index && i < n; i++) {
+    q->set_index(q->items->backing[i], i);
+  }
+  for (size_t i = n > 1 ? (n - 2) / q->arity + 1 : 0; i > 0; i--) {
+    _sift_down(q, i - 1);
+  }
+}
+
+cutils_error_t priority_queue_init(priority_queue_t *q, size_t arity,
+                                   int (*cmp)(void *, void *),
+                                   void (*set_index)(void *, size_t),
+                                   void (*inner_free)(void *),
+                                   void (*outer_free)(void (*)(void *),
+                                                      void *)) {
+  if (!q || !cmp) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  array_list_t *items = malloc(sizeof(array_list_t));
+  if (!items) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  cutils_error_t err = array_list_init(items, 16, inner_free, outer_free);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  return priority_queue_init_from(q, items, arity, cmp, set_index);
+}
+
+cutils_error_t priority_queue_init_from(priority_queue_t *q, array_list_t *l,
+                                        size_t arity,
+                                        int (*cmp)(void *, void *),
+                                        void (*set_index)(void *, size_t)) {
+  if (!q || !l || !cmp) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  q->arity = arity > 1 ? arity : PRIORITY_QUEUE_DEFAULT_ARITY;
+  q->items = l;
+  q->cmp = cmp;
+  q->set_index = set_index;
+  _heapify(q);
+
+  return CUTILS_SUCCESS;
+}
+
+void priority_queue_free(void *ptr) {
+  if (ptr) {
+    priority_queue_t *q = ptr;
+    array_list_free(q->items);
+    free(q);
+  }
+}
+
+cutils_error_t priority_queue_push(priority_queue_t *q, void *value) {
+  if (!q) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  cutils_error_t err = array_list_push(q->items, value);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+  _sift_up(q, q->items->length - 1);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t priority_queue_pop(priority_queue_t *q, void **value) {
+  return priority_queue_remove(q, 0, value);
+}
+
+cutils_error_t priority_queue_peek(priority_queue_t *q, void **value) {
+  if (!q || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (q->items->length == 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+  *value = q->items->backing[0];
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t priority_queue_update(priority_queue_t *q, size_t idx) {
+  if (!q) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (idx >= q->items->length) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (_sift_up(q, idx) == idx) {
+    _sift_down(q, idx);
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t priority_queue_remove(priority_queue_t *q, size_t idx,
+                                     void **value) {
+  if (!q) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  array_list_t *l = q->items;
+  if (idx >= l->length) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (value) {
+    *value = l->backing[idx];
+  } else {
+    array_list_free_value(l, idx);
+  }
+
+  // The last value fills the hole and is sifted whichever way it belongs
+  void *last = l->backing[--l->length];
+  l->backing[l->length] = NULL;
+  if (idx < l->length) {
+    l->backing[idx] = last;
+    priority_queue_update(q, idx);
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+static cutils_error_t _u64_reserve(priority_queue_u64_t *q, size_t capacity) {
+  priority_queue_entry_t *entries =
+      realloc(q->entries, sizeof(priority_queue_entry_t) * capacity);
+  if (!entries) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  q->entries = entries;
+  q->capacity = capacity;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t priority_queue_u64_init(priority_queue_u64_t *q, size_t arity,
+                                       size_t capacity) {
+  if (!q) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  q->length = 0;
+  q->capacity = 0;
+  q->arity = arity > 1 ? arity : PRIORITY_QUEUE_DEFAULT_ARITY;
+  q->entries = NULL;
+
+  return _u64_reserve(q, capacity > 0 ? capacity : 16);
+}
+
+void priority_queue_u64_free(void *ptr) {
+  if (ptr) {
+    priority_queue_u64_t *q = ptr;
+    free(q->entries);
+    free(q);
+  }
+}
+
+cutils_error_t priority_queue_u64_push(priority_queue_u64_t *q,
+                                       uint64_t priority, void *payload) {
+  if (!q) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (q->length == q->capacity) {
+    cutils_error_t err = _u64_reserve(q, q->capacity * 2);
+    if (err != CUTILS_SUCCESS) {
+      return err;
+    }
+  }
+
+  priority_queue_entry_t *e = q->entries;
+  size_t idx = q->length++;
+  while (idx > 0) {
+    size_t parent = (idx - 1) / q->arity;
+    if (priority >= e[parent].priority) {
+      break;
+    }
+    e[idx] = e[parent];
+    idx = parent;
+  }
+  e[idx] = (priority_queue_entry_t){priority, payload};
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t priority_queue_u64_pop(priority_queue_u64_t *q,
+                                      uint64_t *priority, void **payload) {
+  cutils_error_t err = priority_queue_u64_peek(q, priority, payload);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  priority_queue_entry_t *e = q->entries;
+  size_t n = --q->length;
+  if (n == 0) {
+    return CUTILS_SUCCESS;
+  }
+
+  priority_queue_entry_t last = e[n];
+  size_t idx = 0;
+  for (;;) {
+    size_t first = idx * q->arity + 1;
+    if (first >= n) {
+      break;
+    }
+
+    size_t end = first + q->arity < n ? first + q->arity : n;
+    size_t best = first;
+    for (size_t c = first + 1; c < end; c++) {
+      best = e[c].priority < e[best].priority ? c : best;
+    }
+    if (e[best].priority >= last.priority) {
+      break;
+    }
+    e[idx] = e[best];
+    idx = best;
+  }
+  e[idx] = last;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t priority_queue_u64_peek(priority_queue_u64_t *q,
+                                       uint64_t *priority, void **payload) {
+  if (!q) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (q->length == 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (priority) {
+    *priority = q->entries[0].priority;
+  }
+  if (payload) {
+    *payload = q->entries[0].payload;
+  }
+
+  return CUTILS_SUCCESS;
+}
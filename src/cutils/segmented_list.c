@@ -0,0 +1,194 @@
+#include "cutils/segmented_list.h"
+#include "cutils/errors.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static size_t _segment_of(size_t idx, size_t *offset) {
+  uint64_t j = (uint64_t)idx + ((uint64_t)1 << SEGMENTED_LIST_FIRST_SHIFT);
+  size_t msb = 63 - __builtin_clzll(j);
+  *offset = j - ((uint64_t)1 << msb);
+  return msb - SEGMENTED_LIST_FIRST_SHIFT;
+}
+
+static size_t _segment_size(size_t segment) {
+  return (size_t)1 << (segment + SEGMENTED_LIST_FIRST_SHIFT);
+}
+
+// The slot at `idx`, or NULL when its segment was never allocated.
+static segmented_list_slot_t *_slot(segmented_list_t *l, size_t idx) {
+  size_t offset = 0;
+  size_t segment = _segment_of(idx, &offset);
+  if (segment >= SEGMENTED_LIST_MAX_SEGMENTS) {
+    return NULL;
+  }
+  segmented_list_slot_t *slots =
+      atomic_load_explicit(&l->segments[segment], memory_order_acquire);
+  return slots ? &slots[offset] : NULL;
+}
+
+// The slot at `idx` if its push has published it, otherwise NULL.
+static segmented_list_slot_t *_published(segmented_list_t *l, size_t idx) {
+  if (idx >= atomic_load_explicit(&l->reserved, memory_order_acquire)) {
+    return NULL;
+  }
+  segmented_list_slot_t *slot = _slot(l, idx);
+  if (!slot || !atomic_load_explicit(&slot->written, memory_order_acquire)) {
+    return NULL;
+  }
+  return slot;
+}
+
+cutils_error_t segmented_list_init(segmented_list_t *l,
+                                   void (*inner_free)(void *),
+                                   void (*outer_free)(void (*)(void *),
+                                                      void *)) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  atomic_init(&l->length, 0);
+  atomic_init(&l->reserved, 0);
+  for (size_t i = 0; i < SEGMENTED_LIST_MAX_SEGMENTS; i++) {
+    atomic_init(&l->segments[i], NULL);
+  }
+  l->inner_free = inner_free;
+  l->outer_free = outer_free;
+
+  return CUTILS_SUCCESS;
+}
+
+void segmented_list_free(void *ptr) {
+  if (ptr) {
+    segmented_list_t *l = ptr;
+    size_t reserved = atomic_load(&l->reserved);
+    for (size_t i = 0; i < reserved; i++) {
+      segmented_list_slot_t *slot = _published(l, i);
+      if (!slot) {
+        continue;
+      }
+      void *value = slot->value;
+      if (l->outer_free && l->inner_free) {
+        l->outer_free(l->inner_free, value);
+      } else if (l->inner_free) {
+        l->inner_free(value);
+      }
+    }
+
+    for (size_t i = 0; i < SEGMENTED_LIST_MAX_SEGMENTS; i++) {
+      free(atomic_load(&l->segments[i]));
+    }
+    free(l);
+  }
+}
+
+static cutils_error_t _ensure_segment(segmented_list_t *l, size_t segment) {
+  if (atomic_load_explicit(&l->segments[segment], memory_order_acquire)) {
+    return CUTILS_SUCCESS;
+  }
+
+  // Zeroed, so that no slot reads as written before its push publishes it
+  segmented_list_slot_t *slots =
+      calloc(_segment_size(segment), sizeof(segmented_list_slot_t));
+  if (!slots) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  segmented_list_slot_t *expected = NULL;
+  if (!atomic_compare_exchange_strong_explicit(&l->segments[segment],
+                                               &expected, slots,
+                                               memory_order_acq_rel,
+                                               memory_order_acquire)) {
+    // Another pusher installed the segment first
+    free(slots);
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t segmented_list_push(segmented_list_t *l, void *value,
+                                   size_t *idx) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t pos = atomic_fetch_add_explicit(&l->reserved, 1,
+                                         memory_order_relaxed);
+  size_t offset = 0;
+  size_t segment = _segment_of(pos, &offset);
+  if (segment >= SEGMENTED_LIST_MAX_SEGMENTS) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  cutils_error_t err = _ensure_segment(l, segment);
+  if (err != CUTILS_SUCCESS) {
+    return err;
+  }
+
+  // Publish this slot alone; pushes before it may still be in progress
+  segmented_list_slot_t *slot = _slot(l, pos);
+  slot->value = value;
+  atomic_store_explicit(&slot->written, true, memory_order_release);
+  atomic_fetch_add_explicit(&l->length, 1, memory_order_relaxed);
+
+  if (idx) {
+    *idx = pos;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t segmented_list_get(segmented_list_t *l, size_t idx,
+                                  void **value) {
+  if (!l || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  segmented_list_slot_t *slot = _published(l, idx);
+  if (!slot) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  *value = slot->value;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t segmented_list_set(segmented_list_t *l, size_t idx,
+                                  void *value) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  segmented_list_slot_t *slot = _published(l, idx);
+  if (!slot) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (l->outer_free && l->inner_free) {
+    l->outer_free(l->inner_free, slot->value);
+  } else if (l->inner_free) {
+    l->inner_free(slot->value);
+  }
+  slot->value = value;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t segmented_list_ref(segmented_list_t *l, size_t idx,
+                                  void ***ref) {
+  if (!l || !ref) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  segmented_list_slot_t *slot = _published(l, idx);
+  if (!slot) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  *ref = &slot->value;
+
+  return CUTILS_SUCCESS;
+}
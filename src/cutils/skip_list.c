@@ -0,0 +1,271 @@
+#include "cutils/skip_list.h"
+#include "cutils/errors.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static skip_list_node_t *_node_new(void *key, void *value, size_t level) {
+  skip_list_node_t *n =
+      malloc(sizeof(skip_list_node_t) + sizeof(skip_list_node_t *) * level);
+  if (!n) {
+    return NULL;
+  }
+
+  n->key = key;
+  n->value = value;
+  n->level = level;
+  for (size_t i = 0; i < level; i++) {
+    n->next[i] = NULL;
+  }
+
+  return n;
+}
+
+// Geometric level distribution with p = 1/4.
+static size_t _random_level(skip_list_t *s) {
+  s->seed ^= s->seed << 13;
+  s->seed ^= s->seed >> 7;
+  s->seed ^= s->seed << 17;
+
+  size_t level = 1 + __builtin_ctzll(s->seed | (1ull << 63)) / 2;
+  return level < SKIP_LIST_MAX_LEVEL ? level : SKIP_LIST_MAX_LEVEL;
+}
+
+// Fills `preds` with the last node before `key` on every level and returns
+// the first node with a key >= `key`.
+static skip_list_node_t *_find(skip_list_t *s, void *key,
+                               skip_list_node_t **preds) {
+  skip_list_node_t *curr = s->head;
+  for (size_t i = s->level; i > 0; i--) {
+    while (curr->next[i - 1] && s->cmp(curr->next[i - 1]->key, key) < 0) {
+      curr = curr->next[i - 1];
+    }
+    if (preds) {
+      preds[i - 1] = curr;
+    }
+  }
+  return curr->next[0];
+}
+
+cutils_error_t skip_list_init(skip_list_t *s, int (*cmp)(void *, void *),
+                              void (*key_free)(void *),
+                              void (*inner_free)(void *)) {
+  if (!s || !cmp) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  s->length = 0;
+  s->level = 1;
+  s->seed = 0x9e3779b97f4a7c15ull;
+  s->cmp = cmp;
+  s->key_free = key_free;
+  s->inner_free = inner_free;
+  s->head = _node_new(NULL, NULL, SKIP_LIST_MAX_LEVEL);
+  if (!s->head) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void skip_list_free(void *ptr) {
+  if (ptr) {
+    skip_list_t *s = ptr;
+    skip_list_node_t *curr = s->head->next[0];
+    while (curr) {
+      skip_list_node_t *next = curr->next[0];
+      if (s->key_free) {
+        s->key_free(curr->key);
+      }
+      if (s->inner_free) {
+        s->inner_free(curr->value);
+      }
+      free(curr);
+      curr = next;
+    }
+    free(s->head);
+    free(s);
+  }
+}
+
+cutils_error_t skip_list_insert(skip_list_t *s, void *key, void *value) {
+  if (!s || !key) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  skip_list_node_t *preds[SKIP_LIST_MAX_LEVEL];
+  skip_list_node_t *curr = _find(s, key, preds);
+  if (curr && s->cmp(curr->key, key) == 0) {
+    if (s->key_free) {
+      s->key_free(curr->key);
+    }
+    if (s->inner_free) {
+      s->inner_free(curr->value);
+    }
+    curr->key = key;
+    curr->value = value;
+    return CUTILS_SUCCESS;
+  }
+
+  size_t level = _random_level(s);
+  for (size_t i = s->level; i < level; i++) {
+    preds[i] = s->head;
+  }
+
+  skip_list_node_t *node = _node_new(key, value, level);
+  if (!node) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  for (size_t i = 0; i < level; i++) {
+    node->next[i] = preds[i]->next[i];
+    preds[i]->next[i] = node;
+  }
+
+  s->level = level > s->level ? level : s->level;
+  s->length++;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t skip_list_remove(skip_list_t *s, void *key, void **value) {
+  if (!s || !key) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  skip_list_node_t *preds[SKIP_LIST_MAX_LEVEL];
+  skip_list_node_t *curr = _find(s, key, preds);
+  if (!curr || s->cmp(curr->key, key) != 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  for (size_t i = 0; i < curr->level; i++) {
+    preds[i]->next[i] = curr->next[i];
+  }
+  while (s->level > 1 && !s->head->next[s->level - 1]) {
+    s->level--;
+  }
+
+  if (value) {
+    *value = curr->value;
+  } else if (s->inner_free) {
+    s->inner_free(curr->value);
+  }
+
+  if (s->key_free) {
+    s->key_free(curr->key);
+  }
+  free(curr);
+  s->length--;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t skip_list_get(skip_list_t *s, void *key, void **value) {
+  if (!s || !key || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  skip_list_node_t *curr = _find(s, key, NULL);
+  if (!curr || s->cmp(curr->key, key) != 0) {
+    return CUTILS_INDEX_ERROR;
+  }
+  *value = curr->value;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t skip_list_floor(skip_list_t *s, void *key, void **found,
+                               void **value) {
+  if (!s || !key) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  skip_list_node_t *curr = s->head;
+  for (size_t i = s->level; i > 0; i--) {
+    while (curr->next[i - 1] && s->cmp(curr->next[i - 1]->key, key) <= 0) {
+      curr = curr->next[i - 1];
+    }
+  }
+
+  if (curr == s->head) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (found) {
+    *found = curr->key;
+  }
+  if (value) {
+    *value = curr->value;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t skip_list_ceiling(skip_list_t *s, void *key, void **found,
+                                 void **value) {
+  if (!s || !key) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  skip_list_node_t *curr = _find(s, key, NULL);
+  if (!curr) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (found) {
+    *found = curr->key;
+  }
+  if (value) {
+    *value = curr->value;
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t skip_list_seek(skip_list_t *s, void *key,
+                              skip_list_iter_t *it) {
+  if (!s || !it) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  it->node = key ? _find(s, key, NULL) : s->head->next[0];
+
+  return CUTILS_SUCCESS;
+}
+
+bool skip_list_iter_valid(skip_list_iter_t *it) { return it && it->node; }
+
+cutils_error_t skip_list_iter_next(skip_list_iter_t *it) {
+  if (!it) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!it->node) {
+    return CUTILS_INDEX_ERROR;
+  }
+  it->node = it->node->next[0];
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t skip_list_iter_get(skip_list_iter_t *it, void **key,
+                                  void **value) {
+  if (!it) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!it->node) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  if (key) {
+    *key = it->node->key;
+  }
+  if (value) {
+    *value = it->node->value;
+  }
+
+  return CUTILS_SUCCESS;
+}
@@ -0,0 +1,152 @@
+#include "cutils/thread_pool.h"
+#include "cutils/errors.h"
+#include "cutils/linked_list.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+  void (*fn)(void *);
+  void *arg;
+} thread_pool_task_t;
+
+static void *_worker(void *arg) {
+  thread_pool_t *p = arg;
+
+  pthread_mutex_lock(&p->lock);
+  for (;;) {
+    while (p->tasks->length == 0 && !p->stopping) {
+      pthread_cond_wait(&p->task_ready, &p->lock);
+    }
+
+    if (p->tasks->length == 0 && p->stopping) {
+      break;
+    }
+
+    thread_pool_task_t *task = NULL;
+    linked_list_pop_front(p->tasks, (void **)&task);
+    pthread_mutex_unlock(&p->lock);
+
+    task->fn(task->arg);
+    free(task);
+
+    pthread_mutex_lock(&p->lock);
+    p->pending--;
+    if (p->pending == 0) {
+      pthread_cond_broadcast(&p->task_done);
+    }
+  }
+  pthread_mutex_unlock(&p->lock);
+
+  return NULL;
+}
+
+static void _shutdown(thread_pool_t *p, size_t nstarted) {
+  pthread_mutex_lock(&p->lock);
+  p->stopping = true;
+  pthread_cond_broadcast(&p->task_ready);
+  pthread_mutex_unlock(&p->lock);
+
+  for (size_t i = 0; i < nstarted; i++) {
+    pthread_join(p->threads[i], NULL);
+  }
+}
+
+cutils_error_t thread_pool_init(thread_pool_t *p, size_t nthreads) {
+  if (!p) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (nthreads == 0) {
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = ncpus > 0 ? (size_t)ncpus : 1;
+  }
+
+  p->nthreads = nthreads;
+  p->pending = 0;
+  p->stopping = false;
+  p->threads = malloc(sizeof(pthread_t) * nthreads);
+  if (!p->threads) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+
+  p->tasks = malloc(sizeof(linked_list_t));
+  if (!p->tasks) {
+    free(p->threads);
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  linked_list_init(p->tasks, free, NULL);
+
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->task_ready, NULL);
+  pthread_cond_init(&p->task_done, NULL);
+
+  for (size_t i = 0; i < nthreads; i++) {
+    if (pthread_create(&p->threads[i], NULL, _worker, p) != 0) {
+      _shutdown(p, i);
+      linked_list_free(p->tasks);
+      free(p->threads);
+      pthread_mutex_destroy(&p->lock);
+      pthread_cond_destroy(&p->task_ready);
+      pthread_cond_destroy(&p->task_done);
+      return CUTILS_THREAD_ERROR;
+    }
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void thread_pool_free(void *ptr) {
+  if (ptr) {
+    thread_pool_t *p = ptr;
+    _shutdown(p, p->nthreads);
+    linked_list_free(p->tasks);
+    free(p->threads);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->task_ready);
+    pthread_cond_destroy(&p->task_done);
+    free(p);
+  }
+}
+
+cutils_error_t thread_pool_submit(thread_pool_t *p, void (*fn)(void *),
+                                  void *arg) {
+  if (!p || !fn) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  thread_pool_task_t *task = malloc(sizeof(thread_pool_task_t));
+  if (!task) {
+    return CUTILS_ALLOCATION_ERROR;
+  }
+  task->fn = fn;
+  task->arg = arg;
+
+  pthread_mutex_lock(&p->lock);
+  cutils_error_t err = linked_list_push_back(p->tasks, task);
+  if (err != CUTILS_SUCCESS) {
+    pthread_mutex_unlock(&p->lock);
+    free(task);
+    return err;
+  }
+  p->pending++;
+  pthread_cond_signal(&p->task_ready);
+  pthread_mutex_unlock(&p->lock);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t thread_pool_wait(thread_pool_t *p) {
+  if (!p) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  pthread_mutex_lock(&p->lock);
+  while (p->pending > 0) {
+    pthread_cond_wait(&p->task_done, &p->lock);
+  }
+  pthread_mutex_unlock(&p->lock);
+
+  return CUTILS_SUCCESS;
+}
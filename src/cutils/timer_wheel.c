@@ -0,0 +1,188 @@
+#include "cutils/timer_wheel.h"
+#include "cutils/errors.h"
+#include "cutils/intrusive_list.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define SLOT_MASK ((uint64_t)TIMER_WHEEL_SLOTS - 1)
+
+// Picks the slot for `deadline`, measured from the next tick to be run.
+static intrusive_list_t *_slot_for(timer_wheel_t *w, uint64_t deadline) {
+  uint64_t next = w->now + 1;
+  uint64_t expires = deadline > next ? deadline : next;
+  uint64_t delta = expires - next;
+
+  for (size_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    uint64_t span = (uint64_t)1 << (TIMER_WHEEL_BITS * (level + 1));
+    if (delta < span) {
+      size_t shift = TIMER_WHEEL_BITS * level;
+      return &w->slots[level][(expires >> shift) & SLOT_MASK];
+    }
+  }
+
+  // Beyond the top level: park as far out as it reaches
+  size_t shift = TIMER_WHEEL_BITS * (TIMER_WHEEL_LEVELS - 1);
+  uint64_t last = next + ((uint64_t)1 << (shift + TIMER_WHEEL_BITS)) - 1;
+  return &w->slots[TIMER_WHEEL_LEVELS - 1][(last >> shift) & SLOT_MASK];
+}
+
+static size_t _level_of(timer_wheel_t *w, intrusive_list_t *slot) {
+  return (size_t)(slot - &w->slots[0][0]) / TIMER_WHEEL_SLOTS;
+}
+
+static void _place(timer_wheel_t *w, timer_wheel_timer_t *t) {
+  t->slot = _slot_for(w, t->deadline);
+  intrusive_list_push_back(t->slot, &t->link);
+  w->counts[_level_of(w, t->slot)]++;
+}
+
+static void _unlink(timer_wheel_t *w, timer_wheel_timer_t *t) {
+  w->counts[_level_of(w, t->slot)]--;
+  intrusive_list_unlink(t->slot, &t->link);
+  t->slot = NULL;
+}
+
+cutils_error_t timer_wheel_init(timer_wheel_t *w, uint64_t now) {
+  if (!w) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  w->now = now;
+  w->length = 0;
+  for (size_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    w->counts[level] = 0;
+    for (size_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+      intrusive_list_init(&w->slots[level][i]);
+    }
+  }
+
+  return CUTILS_SUCCESS;
+}
+
+void timer_wheel_free(void *ptr) {
+  if (ptr) {
+    free(ptr);
+  }
+}
+
+cutils_error_t timer_wheel_timer_init(timer_wheel_timer_t *t) {
+  if (!t) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  t->link.prev = NULL;
+  t->link.next = NULL;
+  t->slot = NULL;
+  t->deadline = 0;
+
+  return CUTILS_SUCCESS;
+}
+
+bool timer_wheel_timer_armed(timer_wheel_timer_t *t) { return t && t->slot; }
+
+cutils_error_t timer_wheel_add(timer_wheel_t *w, timer_wheel_timer_t *t,
+                               uint64_t deadline) {
+  if (!w || !t) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (t->slot) {
+    _unlink(w, t);
+    w->length--;
+  } else if (intrusive_list_is_linked(&t->link)) {
+    // Still sitting in an expired batch
+    return CUTILS_INDEX_ERROR;
+  }
+
+  t->deadline = deadline;
+  _place(w, t);
+  w->length++;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t timer_wheel_cancel(timer_wheel_t *w, timer_wheel_timer_t *t) {
+  if (!w || !t) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (!t->slot) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  _unlink(w, t);
+  w->length--;
+
+  return CUTILS_SUCCESS;
+}
+
+// Redistributes one higher-level slot over the levels below it.
+static void _cascade(timer_wheel_t *w, intrusive_list_t *slot) {
+  intrusive_list_t pending;
+  intrusive_list_init(&pending);
+  w->counts[_level_of(w, slot)] -= slot->length;
+  intrusive_list_splice(&pending, &pending.root, slot);
+
+  intrusive_list_link_t *link = NULL;
+  while (intrusive_list_pop_front(&pending, &link) == CUTILS_SUCCESS) {
+    _place(w, INTRUSIVE_LIST_ENTRY(link, timer_wheel_timer_t, link));
+  }
+}
+
+cutils_error_t timer_wheel_advance(timer_wheel_t *w, uint64_t now,
+                                   intrusive_list_t *expired) {
+  if (!w || !expired) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  while (w->now < now) {
+    // Nothing armed: jump straight to the end
+    if (w->length == 0) {
+      w->now = now;
+      break;
+    }
+
+    // With the lowest levels empty, nothing happens until the first
+    // non-empty level next cascades, so skip to just before that tick
+    size_t empty = 0;
+    while (w->counts[empty] == 0) {
+      empty++;
+    }
+    if (empty > 0) {
+      size_t shift = TIMER_WHEEL_BITS * empty;
+      uint64_t quiet = (((w->now >> shift) + 1) << shift) - 1;
+      if (quiet >= now) {
+        w->now = now;
+        break;
+      }
+      w->now = quiet;
+    }
+
+    uint64_t tick = w->now + 1;
+
+    // Whenever a level wraps, the next slot up is due to be split
+    for (size_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+      size_t shift = TIMER_WHEEL_BITS * level;
+      if ((tick & (((uint64_t)1 << shift) - 1)) != 0) {
+        break;
+      }
+      _cascade(w, &w->slots[level][(tick >> shift) & SLOT_MASK]);
+    }
+
+    w->now = tick;
+
+    intrusive_list_t *slot = &w->slots[0][tick & SLOT_MASK];
+    if (slot->length > 0) {
+      INTRUSIVE_LIST_FOR_EACH(slot, link) {
+        INTRUSIVE_LIST_ENTRY(link, timer_wheel_timer_t, link)->slot = NULL;
+      }
+      w->length -= slot->length;
+      w->counts[0] -= slot->length;
+      intrusive_list_splice(expired, &expired->root, slot);
+    }
+  }
+
+  return CUTILS_SUCCESS;
+}
@@ -0,0 +1,324 @@
+#include "cutils/unrolled_list.h"
+#include "cutils/errors.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NODE_CAPACITY UNROLLED_LIST_NODE_CAPACITY
+#define NODE_MIN (NODE_CAPACITY / 2)
+
+static void _free_value(unrolled_list_t *l, void *value) {
+  if (l->outer_free && l->inner_free) {
+    l->outer_free(l->inner_free, value);
+  } else if (l->inner_free) {
+    l->inner_free(value);
+  } else if (l->outer_free) {
+    // Special case: composite type with stack-allocated value
+    free(value);
+  }
+}
+
+static unrolled_list_node_t *_node_new(void) {
+  unrolled_list_node_t *n = malloc(sizeof(unrolled_list_node_t));
+  if (!n) {
+    return NULL;
+  }
+
+  n->prev = NULL;
+  n->next = NULL;
+  n->count = 0;
+
+  return n;
+}
+
+static void _link_after(unrolled_list_t *l, unrolled_list_node_t *pos,
+                        unrolled_list_node_t *node) {
+  node->prev = pos;
+  node->next = pos ? pos->next : l->head;
+  if (node->next) {
+    node->next->prev = node;
+  } else {
+    l->tail = node;
+  }
+  if (pos) {
+    pos->next = node;
+  } else {
+    l->head = node;
+  }
+  l->nnodes++;
+}
+
+static void _unlink(unrolled_list_t *l, unrolled_list_node_t *node) {
+  if (node->prev) {
+    node->prev->next = node->next;
+  } else {
+    l->head = node->next;
+  }
+  if (node->next) {
+    node->next->prev = node->prev;
+  } else {
+    l->tail = node->prev;
+  }
+  l->nnodes--;
+  free(node);
+}
+
+// Finds the node holding `idx`, skipping whole nodes from the closer end.
+static unrolled_list_node_t *_locate(unrolled_list_t *l, size_t idx,
+                                     size_t *offset) {
+  if (idx < l->length / 2) {
+    unrolled_list_node_t *curr = l->head;
+    while (idx >= curr->count) {
+      idx -= curr->count;
+      curr = curr->next;
+    }
+    *offset = idx;
+    return curr;
+  }
+
+  size_t remaining = l->length - idx;
+  unrolled_list_node_t *curr = l->tail;
+  while (remaining > curr->count) {
+    remaining -= curr->count;
+    curr = curr->prev;
+  }
+  *offset = curr->count - remaining;
+  return curr;
+}
+
+cutils_error_t unrolled_list_init(unrolled_list_t *l,
+                                  void (*inner_free)(void *),
+                                  void (*outer_free)(void (*)(void *),
+                                                     void *)) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  l->length = 0;
+  l->nnodes = 0;
+  l->head = NULL;
+  l->tail = NULL;
+  l->inner_free = inner_free;
+  l->outer_free = outer_free;
+
+  return CUTILS_SUCCESS;
+}
+
+void unrolled_list_free(void *ptr) {
+  if (ptr) {
+    unrolled_list_t *l = ptr;
+
+    unrolled_list_node_t *curr = l->head;
+    while (curr) {
+      unrolled_list_node_t *next = curr->next;
+      for (size_t i = 0; i < curr->count; i++) {
+        _free_value(l, curr->values[i]);
+      }
+      free(curr);
+      curr = next;
+    }
+
+    free(l);
+  }
+}
+
+cutils_error_t unrolled_list_insert_at(unrolled_list_t *l, size_t idx,
+                                       void *value) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (idx > l->length) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  unrolled_list_node_t *node = NULL;
+  size_t offset = 0;
+  if (idx == l->length) {
+    node = l->tail;
+    offset = node ? node->count : 0;
+  } else {
+    node = _locate(l, idx, &offset);
+  }
+
+  if (!node) {
+    node = _node_new();
+    if (!node) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+    _link_after(l, NULL, node);
+  }
+
+  if (node->count == NODE_CAPACITY) {
+    unrolled_list_node_t *next = _node_new();
+    if (!next) {
+      return CUTILS_ALLOCATION_ERROR;
+    }
+    _link_after(l, node, next);
+
+    if (offset == NODE_CAPACITY) {
+      // Appending past a full tail starts a fresh node instead of splitting,
+      // so sequential pushes leave every node full
+      node = next;
+      offset = 0;
+    } else {
+      size_t keep = NODE_CAPACITY / 2;
+      memcpy(next->values, &node->values[keep],
+             sizeof(void *) * (NODE_CAPACITY - keep));
+      next->count = NODE_CAPACITY - keep;
+      node->count = keep;
+
+      if (offset > keep) {
+        offset -= keep;
+        node = next;
+      }
+    }
+  }
+
+  memmove(&node->values[offset + 1], &node->values[offset],
+          sizeof(void *) * (node->count - offset));
+  node->values[offset] = value;
+  node->count++;
+  l->length++;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t unrolled_list_push_front(unrolled_list_t *l, void *value) {
+  return unrolled_list_insert_at(l, 0, value);
+}
+
+cutils_error_t unrolled_list_push_back(unrolled_list_t *l, void *value) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  return unrolled_list_insert_at(l, l->length, value);
+}
+
+// Keeps every node except the last at least half full by borrowing from or
+// merging with its successor.
+static void _rebalance(unrolled_list_t *l, unrolled_list_node_t *node) {
+  if (node->count == 0) {
+    _unlink(l, node);
+    return;
+  }
+
+  if (node->count >= NODE_MIN) {
+    return;
+  }
+
+  unrolled_list_node_t *next = node->next;
+  if (!next) {
+    next = node;
+    node = node->prev;
+    if (!node) {
+      return;
+    }
+  }
+
+  if (node->count + next->count <= NODE_CAPACITY) {
+    memcpy(&node->values[node->count], next->values,
+           sizeof(void *) * next->count);
+    node->count += next->count;
+    _unlink(l, next);
+  } else if (node->count < NODE_MIN) {
+    size_t moved = NODE_MIN - node->count;
+    memcpy(&node->values[node->count], next->values, sizeof(void *) * moved);
+    memmove(next->values, &next->values[moved],
+            sizeof(void *) * (next->count - moved));
+    node->count += moved;
+    next->count -= moved;
+  }
+}
+
+cutils_error_t unrolled_list_remove_at(unrolled_list_t *l, size_t idx,
+                                       void **value) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (idx >= l->length) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  size_t offset = 0;
+  unrolled_list_node_t *node = _locate(l, idx, &offset);
+  if (value) {
+    *value = node->values[offset];
+  }
+
+  memmove(&node->values[offset], &node->values[offset + 1],
+          sizeof(void *) * (node->count - offset - 1));
+  node->count--;
+  l->length--;
+  _rebalance(l, node);
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t unrolled_list_pop_front(unrolled_list_t *l, void **value) {
+  return unrolled_list_remove_at(l, 0, value);
+}
+
+cutils_error_t unrolled_list_pop_back(unrolled_list_t *l, void **value) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  return unrolled_list_remove_at(l, l->length - 1, value);
+}
+
+cutils_error_t unrolled_list_get(unrolled_list_t *l, size_t idx,
+                                 void **value) {
+  if (!l || !value) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (idx >= l->length) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  size_t offset = 0;
+  unrolled_list_node_t *node = _locate(l, idx, &offset);
+  *value = node->values[offset];
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t unrolled_list_set(unrolled_list_t *l, size_t idx, void *value) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  if (idx >= l->length) {
+    return CUTILS_INDEX_ERROR;
+  }
+
+  size_t offset = 0;
+  unrolled_list_node_t *node = _locate(l, idx, &offset);
+  _free_value(l, node->values[offset]);
+  node->values[offset] = value;
+
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t unrolled_list_find(unrolled_list_t *l, void *value,
+                                  bool (*cmp)(void *, void *), size_t *idx) {
+  if (!l) {
+    return CUTILS_NULL_ERROR;
+  }
+
+  size_t base = 0;
+  for (unrolled_list_node_t *curr = l->head; curr; curr = curr->next) {
+    for (size_t i = 0; i < curr->count; i++) {
+      if (cmp(curr->values[i], value)) {
+        *idx = base + i;
+        return CUTILS_SUCCESS;
+      }
+    }
+    base += curr->count;
+  }
+
+  return CUTILS_SUCCESS;
+}
@@ -1,5 +1,6 @@
 #include "cutils/array_list.h"
 #include "cutils/errors.h"
+#include "cutils/thread_pool.h"
 #include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -74,6 +75,49 @@ bool verify_value(void *lhs) {
   return false;
 }
 
+int cmp_int(void *lhs, void *rhs) {
+  uintptr_t l = (uintptr_t)lhs;
+  uintptr_t r = (uintptr_t)rhs;
+  return (l > r) - (l < r);
+}
+
+typedef struct {
+  size_t key;
+  size_t order;
+} test_pair_t;
+
+int cmp_pair_key(void *lhs, void *rhs) {
+  test_pair_t *l = lhs;
+  test_pair_t *r = rhs;
+  return (l->key > r->key) - (l->key < r->key);
+}
+
+array_list_t *_new_random(size_t n, size_t modulus) {
+  array_list_t *l = malloc(sizeof(array_list_t));
+  cutils_error_t err = array_list_init(l, n > 0 ? n : 1, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  uint64_t state = 88172645463325252ull;
+  for (size_t i = 0; i < n; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    err = array_list_push(l, (void *)(uintptr_t)(state % modulus));
+    assert(err == CUTILS_SUCCESS);
+  }
+
+  return l;
+}
+
+bool is_sorted(array_list_t *l) {
+  for (size_t i = 1; i < l->length; i++) {
+    if (cmp_int(l->backing[i - 1], l->backing[i]) > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void test_array_list_init_and_free(void) {
   printf("testing array_list_init_and_free ... ");
 
@@ -369,6 +413,402 @@ void test_array_list_find(void) {
   printf("success\n");
 }
 
+void test_array_list_sort(void) {
+  printf("testing array_list_sort ... ");
+
+  size_t sizes[] = {0, 1, 2, 15, 16, 17, 100, 1000, 20000};
+  size_t moduli[] = {2, 7, 1000000};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    for (size_t j = 0; j < sizeof(moduli) / sizeof(moduli[0]); j++) {
+      array_list_t *l = _new_random(sizes[i], moduli[j]);
+      cutils_error_t err = array_list_sort(l, cmp_int);
+      assert(err == CUTILS_SUCCESS);
+      assert(l->length == sizes[i]);
+      assert(is_sorted(l));
+      array_list_free(l);
+    }
+  }
+
+  // Already sorted and reversed inputs
+  array_list_t *l = malloc(sizeof(array_list_t));
+  cutils_error_t err = array_list_init(l, 8, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+  for (size_t i = 0; i < 5000; i++) {
+    array_list_push(l, (void *)(uintptr_t)(5000 - i));
+  }
+  err = array_list_sort(l, cmp_int);
+  assert(err == CUTILS_SUCCESS);
+  assert(is_sorted(l));
+  err = array_list_sort(l, cmp_int);
+  assert(err == CUTILS_SUCCESS);
+  assert(is_sorted(l));
+  array_list_free(l);
+
+  err = array_list_sort(NULL, cmp_int);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_array_list_stable_sort(void) {
+  printf("testing array_list_stable_sort ... ");
+
+  size_t n = 3000;
+  test_pair_t *pairs = malloc(sizeof(test_pair_t) * n);
+  assert(pairs != NULL);
+
+  array_list_t *l = malloc(sizeof(array_list_t));
+  cutils_error_t err = array_list_init(l, 8, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+  for (size_t i = 0; i < n; i++) {
+    pairs[i].key = (i * 7919) % 13;
+    pairs[i].order = i;
+    array_list_push(l, &pairs[i]);
+  }
+
+  err = array_list_stable_sort(l, cmp_pair_key);
+  assert(err == CUTILS_SUCCESS);
+  for (size_t i = 1; i < n; i++) {
+    test_pair_t *prev = l->backing[i - 1];
+    test_pair_t *curr = l->backing[i];
+    assert(prev->key <= curr->key);
+    if (prev->key == curr->key) {
+      assert(prev->order < curr->order);
+    }
+  }
+
+  array_list_free(l);
+  free(pairs);
+
+  printf("success\n");
+}
+
+void test_array_list_parallel_sort(void) {
+  printf("testing array_list_parallel_sort ... ");
+
+  thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+  cutils_error_t err = thread_pool_init(pool, 3);
+  assert(err == CUTILS_SUCCESS);
+
+  size_t sizes[] = {10, ARRAY_LIST_PARALLEL_SORT_THRESHOLD + 7, 300000};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    array_list_t *l = _new_random(sizes[i], 1000000);
+    err = array_list_parallel_sort(l, cmp_int, pool);
+    assert(err == CUTILS_SUCCESS);
+    assert(l->length == sizes[i]);
+    assert(is_sorted(l));
+    array_list_free(l);
+  }
+
+  array_list_t *l = _new_random(1000, 10);
+  err = array_list_parallel_sort(l, cmp_int, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(is_sorted(l));
+  array_list_free(l);
+
+  thread_pool_free(pool);
+
+  printf("success\n");
+}
+
+void test_array_list_binary_search(void) {
+  printf("testing array_list_binary_search ... ");
+
+  array_list_t *l = malloc(sizeof(array_list_t));
+  cutils_error_t err = array_list_init(l, 8, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  size_t idx = SIZE_MAX;
+  err = array_list_lower_bound(l, (void *)(uintptr_t)3, cmp_int, &idx);
+  assert(err == CUTILS_SUCCESS);
+  assert(idx == 0);
+
+  // 0 2 2 2 4 6 8
+  array_list_push(l, (void *)(uintptr_t)0);
+  array_list_push(l, (void *)(uintptr_t)2);
+  array_list_push(l, (void *)(uintptr_t)2);
+  array_list_push(l, (void *)(uintptr_t)2);
+  array_list_push(l, (void *)(uintptr_t)4);
+  array_list_push(l, (void *)(uintptr_t)6);
+  array_list_push(l, (void *)(uintptr_t)8);
+
+  err = array_list_lower_bound(l, (void *)(uintptr_t)2, cmp_int, &idx);
+  assert(err == CUTILS_SUCCESS);
+  assert(idx == 1);
+
+  err = array_list_upper_bound(l, (void *)(uintptr_t)2, cmp_int, &idx);
+  assert(err == CUTILS_SUCCESS);
+  assert(idx == 4);
+
+  err = array_list_lower_bound(l, (void *)(uintptr_t)9, cmp_int, &idx);
+  assert(err == CUTILS_SUCCESS);
+  assert(idx == 7);
+
+  err = array_list_upper_bound(l, (void *)(uintptr_t)0, cmp_int, &idx);
+  assert(err == CUTILS_SUCCESS);
+  assert(idx == 1);
+
+  idx = SIZE_MAX;
+  err = array_list_binary_search(l, (void *)(uintptr_t)6, cmp_int, &idx);
+  assert(err == CUTILS_SUCCESS);
+  assert(idx == 5);
+
+  idx = SIZE_MAX;
+  err = array_list_binary_search(l, (void *)(uintptr_t)5, cmp_int, &idx);
+  assert(err == CUTILS_INDEX_ERROR);
+  assert(idx == SIZE_MAX);
+
+  err = array_list_binary_search(l, (void *)(uintptr_t)5, cmp_int, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  array_list_free(l);
+
+  printf("success\n");
+}
+
+void test_array_list_find_ptr(void) {
+  printf("testing array_list_find_ptr ... ");
+
+  for (size_t n = 0; n < 40; n++) {
+    array_list_t *l = _new_random(n, 1000);
+    for (size_t i = 0; i < n; i++) {
+      size_t idx = SIZE_MAX;
+      cutils_error_t err = array_list_find_ptr(l, l->backing[i], &idx);
+      assert(err == CUTILS_SUCCESS);
+      assert(idx <= i);
+      assert(l->backing[idx] == l->backing[i]);
+    }
+
+    size_t idx = SIZE_MAX;
+    cutils_error_t err = array_list_find_ptr(l, (void *)(uintptr_t)5000, &idx);
+    assert(err == CUTILS_INDEX_ERROR);
+    assert(idx == SIZE_MAX);
+    array_list_free(l);
+  }
+
+  printf("success\n");
+}
+
+void test_array_list_count_ptr(void) {
+  printf("testing array_list_count_ptr ... ");
+
+  for (size_t n = 0; n < 40; n++) {
+    array_list_t *l = _new_random(n, 3);
+    for (uintptr_t v = 0; v < 4; v++) {
+      size_t expected = 0;
+      for (size_t i = 0; i < n; i++) {
+        expected += l->backing[i] == (void *)v;
+      }
+
+      size_t count = SIZE_MAX;
+      cutils_error_t err = array_list_count_ptr(l, (void *)v, &count);
+      assert(err == CUTILS_SUCCESS);
+      assert(count == expected);
+    }
+    array_list_free(l);
+  }
+
+  printf("success\n");
+}
+
+void test_array_list_min_max_int(void) {
+  printf("testing array_list_min_max_int ... ");
+
+  intptr_t value = 0;
+  array_list_t *l = _new_random(0, 1);
+  cutils_error_t err = array_list_min_int(l, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+  array_list_free(l);
+
+  for (size_t n = 1; n < 40; n++) {
+    l = _new_random(n, 1000);
+    // Mix in negative values to exercise signed comparison
+    for (size_t i = 0; i < n; i += 3) {
+      l->backing[i] = (void *)(-(intptr_t)l->backing[i]);
+    }
+
+    intptr_t min = (intptr_t)l->backing[0];
+    intptr_t max = (intptr_t)l->backing[0];
+    for (size_t i = 1; i < n; i++) {
+      intptr_t x = (intptr_t)l->backing[i];
+      min = x < min ? x : min;
+      max = x > max ? x : max;
+    }
+
+    err = array_list_min_int(l, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == min);
+
+    err = array_list_max_int(l, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == max);
+    array_list_free(l);
+  }
+
+  printf("success\n");
+}
+
+void test_array_list_mapped_growth(void) {
+  printf("testing array_list_mapped_growth ... ");
+
+  size_t n = 2 * ARRAY_LIST_MMAP_THRESHOLD / sizeof(void *);
+  array_list_t *l = malloc(sizeof(array_list_t));
+  cutils_error_t err = array_list_init(l, 8, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(!l->mapped);
+  l->huge_pages = true;
+
+  for (size_t i = 0; i < n; i++) {
+    err = array_list_push(l, (void *)(uintptr_t)i);
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(l->mapped);
+  assert(l->capacity >= n);
+  for (size_t i = 0; i < n; i++) {
+    assert(l->backing[i] == (void *)(uintptr_t)i);
+  }
+
+  for (size_t i = 0; i < n / 2; i++) {
+    array_list_pop(l, NULL);
+  }
+  err = array_list_shrink(l);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->length == n / 2);
+  for (size_t i = 0; i < n / 2; i++) {
+    assert(l->backing[i] == (void *)(uintptr_t)i);
+  }
+
+  // Regrow into the released range
+  for (size_t i = n / 2; i < n; i++) {
+    err = array_list_push(l, (void *)(uintptr_t)i);
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(l->backing[n - 1] == (void *)(uintptr_t)(n - 1));
+  array_list_free(l);
+
+  // Mapped directly at init
+  l = malloc(sizeof(array_list_t));
+  err = array_list_init(l, n, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->mapped);
+  array_list_free(l);
+
+  // Small lists shrink with realloc
+  l = malloc(sizeof(array_list_t));
+  err = array_list_init(l, 64, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+  array_list_push(l, (void *)(uintptr_t)7);
+  err = array_list_shrink(l);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->capacity == 1);
+  assert(l->backing[0] == (void *)(uintptr_t)7);
+  array_list_free(l);
+
+  printf("success\n");
+}
+
+void parallel_for_fn(void *value, size_t idx, void *ctx) {
+  uintptr_t *out = ctx;
+  out[idx] = (uintptr_t)value * 2;
+}
+
+void *parallel_map_fn(void *value, void *ctx) {
+  (void)ctx;
+  return (void *)((uintptr_t)value + 1);
+}
+
+void *parallel_sum_fn(void *acc, void *value, void *ctx) {
+  (void)ctx;
+  return (void *)((uintptr_t)acc + (uintptr_t)value);
+}
+
+// Non-commutative fold and combine to check ordered reductions
+void *parallel_hash_fn(void *acc, void *value, void *ctx) {
+  (void)ctx;
+  return (void *)((uintptr_t)acc * 31 + (uintptr_t)value);
+}
+
+void *parallel_hash_combine(void *lhs, void *rhs, void *ctx) {
+  (void)ctx;
+  return (void *)((uintptr_t)lhs * 7 + (uintptr_t)rhs);
+}
+
+void test_array_list_parallel_for_map_reduce(void) {
+  printf("testing array_list_parallel_for_map_reduce ... ");
+
+  thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+  cutils_error_t err = thread_pool_init(pool, 4);
+  assert(err == CUTILS_SUCCESS);
+
+  size_t sizes[] = {0, 1, ARRAY_LIST_PARALLEL_CHUNK,
+                    10 * ARRAY_LIST_PARALLEL_CHUNK + 3};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    size_t n = sizes[s];
+    array_list_t *l = malloc(sizeof(array_list_t));
+    err = array_list_init(l, 8, NULL, NULL);
+    assert(err == CUTILS_SUCCESS);
+    for (size_t i = 0; i < n; i++) {
+      array_list_push(l, (void *)(uintptr_t)i);
+    }
+
+    for (size_t p = 0; p < 2; p++) {
+      thread_pool_t *pl = p == 0 ? pool : NULL;
+
+      uintptr_t *doubled = calloc(n + 1, sizeof(uintptr_t));
+      err = array_list_parallel_for(l, parallel_for_fn, doubled, pl);
+      assert(err == CUTILS_SUCCESS);
+      for (size_t i = 0; i < n; i++) {
+        assert(doubled[i] == 2 * i);
+      }
+      free(doubled);
+
+      array_list_t *out = malloc(sizeof(array_list_t));
+      err = array_list_init(out, 1, NULL, NULL);
+      assert(err == CUTILS_SUCCESS);
+      array_list_push(out, (void *)(uintptr_t)42);
+      err = array_list_parallel_map(l, out, parallel_map_fn, NULL, pl);
+      assert(err == CUTILS_SUCCESS);
+      assert(out->length == n + 1);
+      assert(out->backing[0] == (void *)(uintptr_t)42);
+      for (size_t i = 0; i < n; i++) {
+        assert(out->backing[i + 1] == (void *)(uintptr_t)(i + 1));
+      }
+      array_list_free(out);
+
+      for (size_t ordered = 0; ordered < 2; ordered++) {
+        void *result = NULL;
+        err = array_list_parallel_reduce(l, NULL, parallel_sum_fn,
+                                         parallel_sum_fn, NULL, ordered, pl,
+                                         &result);
+        assert(err == CUTILS_SUCCESS);
+        assert((uintptr_t)result == n * (n > 0 ? n - 1 : 0) / 2);
+      }
+    }
+
+    // Ordered reductions must not depend on the number of workers
+    void *serial = NULL;
+    void *parallel = NULL;
+    err = array_list_parallel_reduce(l, NULL, parallel_hash_fn,
+                                     parallel_hash_combine, NULL, true,
+                                     NULL, &serial);
+    assert(err == CUTILS_SUCCESS);
+    err = array_list_parallel_reduce(l, NULL, parallel_hash_fn,
+                                     parallel_hash_combine, NULL, true,
+                                     pool, &parallel);
+    assert(err == CUTILS_SUCCESS);
+    assert(serial == parallel);
+
+    array_list_free(l);
+  }
+
+  err = array_list_parallel_for(NULL, parallel_for_fn, NULL, pool);
+  assert(err == CUTILS_NULL_ERROR);
+
+  thread_pool_free(pool);
+
+  printf("success\n");
+}
+
 int main(void) {
   test_array_list_init_and_free();
   test_array_list_insert_at();
@@ -378,5 +818,14 @@ int main(void) {
   test_array_list_get();
   test_array_list_set();
   test_array_list_find();
+  test_array_list_sort();
+  test_array_list_stable_sort();
+  test_array_list_parallel_sort();
+  test_array_list_binary_search();
+  test_array_list_find_ptr();
+  test_array_list_count_ptr();
+  test_array_list_min_max_int();
+  test_array_list_mapped_growth();
+  test_array_list_parallel_for_map_reduce();
   return EXIT_SUCCESS;
 }
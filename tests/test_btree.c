@@ -0,0 +1,247 @@
+#include "cutils/array_list.h"
+#include "cutils/btree.h"
+#include "cutils/errors.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+uint64_t key_of(void *value) { return (uint64_t)(uintptr_t)value / 10; }
+
+// Walks the leaves in order, checking that keys ascend and match `length`.
+void verify_order(btree_t *t) {
+  btree_iter_t it;
+  cutils_error_t err = btree_seek(t, 0, &it);
+  assert(err == CUTILS_SUCCESS);
+
+  size_t count = 0;
+  uint64_t prev = 0;
+  for (; btree_iter_valid(&it); btree_iter_next(&it)) {
+    uint64_t key = 0;
+    void *value = NULL;
+    err = btree_iter_get(&it, &key, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(count == 0 || key > prev);
+    assert(value == (void *)(uintptr_t)(key * 10));
+    prev = key;
+    count++;
+  }
+  assert(count == t->length);
+}
+
+void test_btree_init_and_free(void) {
+  printf("testing btree_init_and_free ... ");
+
+  btree_t *t = malloc(sizeof(btree_t));
+  cutils_error_t err = btree_init(t, free);
+  assert(err == CUTILS_SUCCESS);
+  assert(t->length == 0);
+
+  for (uint64_t i = 0; i < 1000; i++) {
+    err = btree_insert(t, i, malloc(8));
+    assert(err == CUTILS_SUCCESS);
+  }
+  // Replacing frees the previous value
+  err = btree_insert(t, 500, malloc(8));
+  assert(err == CUTILS_SUCCESS);
+  assert(t->length == 1000);
+
+  btree_free(t);
+
+  err = btree_init(NULL, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_btree_insert_get_remove(void) {
+  printf("testing btree_insert_get_remove ... ");
+
+  btree_t *t = malloc(sizeof(btree_t));
+  cutils_error_t err = btree_init(t, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  // A permutation of 1..n, enough for three levels
+  uint64_t n = 100003;
+  for (uint64_t i = 0; i < n; i++) {
+    uint64_t k = (i * 7919) % n + 1;
+    err = btree_insert(t, k, (void *)(uintptr_t)(k * 10));
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(t->length == n);
+  assert(!t->root->leaf);
+  verify_order(t);
+
+  void *value = NULL;
+  for (uint64_t k = 1; k <= n; k++) {
+    err = btree_get(t, k, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)(uintptr_t)(k * 10));
+  }
+  err = btree_get(t, n + 1, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = btree_get(t, 0, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  for (uint64_t k = 1; k <= n; k += 2) {
+    err = btree_remove(t, k, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)(uintptr_t)(k * 10));
+  }
+  assert(t->length == n / 2);
+  err = btree_remove(t, 1, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+  verify_order(t);
+
+  for (uint64_t k = 1; k <= n; k++) {
+    err = btree_get(t, k, &value);
+    assert(err == (k % 2 ? CUTILS_INDEX_ERROR : CUTILS_SUCCESS));
+  }
+
+  // Emptying the tree collapses it back to a single leaf
+  for (uint64_t k = 2; k <= n; k += 2) {
+    err = btree_remove(t, k, NULL);
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(t->length == 0);
+  assert(t->root->leaf);
+
+  err = btree_insert(t, 7, (void *)70);
+  assert(err == CUTILS_SUCCESS);
+  err = btree_get(t, 7, &value);
+  assert(err == CUTILS_SUCCESS);
+  assert(value == (void *)70);
+
+  err = btree_get(NULL, 7, &value);
+  assert(err == CUTILS_NULL_ERROR);
+  err = btree_get(t, 7, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  btree_free(t);
+
+  printf("success\n");
+}
+
+void test_btree_floor_and_ceiling(void) {
+  printf("testing btree_floor_and_ceiling ... ");
+
+  btree_t *t = malloc(sizeof(btree_t));
+  cutils_error_t err = btree_init(t, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  uint64_t found = 0;
+  err = btree_floor(t, 10, &found, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = btree_ceiling(t, 10, &found, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  // Multiples of 10 from 10 to 10000, spanning many leaves
+  for (uint64_t k = 10; k <= 10000; k += 10) {
+    err = btree_insert(t, k, (void *)(uintptr_t)(k * 10));
+    assert(err == CUTILS_SUCCESS);
+  }
+
+  for (uint64_t k = 10; k <= 10000; k += 10) {
+    void *value = NULL;
+    err = btree_floor(t, k + 5, &found, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(found == k);
+    assert(value == (void *)(uintptr_t)(k * 10));
+
+    err = btree_ceiling(t, k - 5, &found, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(found == k);
+
+    err = btree_floor(t, k, &found, NULL);
+    assert(err == CUTILS_SUCCESS);
+    assert(found == k);
+  }
+
+  err = btree_floor(t, 9, &found, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = btree_ceiling(t, 10001, &found, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = btree_floor(t, UINT64_MAX, &found, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(found == 10000);
+
+  btree_free(t);
+
+  printf("success\n");
+}
+
+void test_btree_bulk_load(void) {
+  printf("testing btree_bulk_load ... ");
+
+  array_list_t *l = malloc(sizeof(array_list_t));
+  cutils_error_t err = array_list_init(l, 16, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  // Keys 1, 3, 5, ... stored as key * 10
+  size_t n = 50000;
+  for (uintptr_t i = 0; i < n; i++) {
+    err = array_list_push(l, (void *)((2 * i + 1) * 10));
+    assert(err == CUTILS_SUCCESS);
+  }
+
+  btree_t *t = malloc(sizeof(btree_t));
+  err = btree_init(t, NULL);
+  assert(err == CUTILS_SUCCESS);
+  err = btree_bulk_load(t, l, key_of);
+  assert(err == CUTILS_SUCCESS);
+  assert(t->length == n);
+  verify_order(t);
+
+  // A bulk-loaded tree still takes updates
+  for (uint64_t k = 0; k < 2 * n; k += 2) {
+    err = btree_insert(t, k, (void *)(uintptr_t)(k * 10));
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(t->length == 2 * n);
+  verify_order(t);
+
+  // Range scan over [1000, 1100)
+  btree_iter_t it;
+  err = btree_seek(t, 1000, &it);
+  assert(err == CUTILS_SUCCESS);
+  uint64_t expected = 1000;
+  for (; btree_iter_valid(&it); btree_iter_next(&it)) {
+    uint64_t key = 0;
+    btree_iter_get(&it, &key, NULL);
+    if (key >= 1100) {
+      break;
+    }
+    assert(key == expected++);
+  }
+  assert(expected == 1100);
+
+  // Only empty trees can be loaded, and only from strictly ascending keys
+  err = btree_bulk_load(t, l, key_of);
+  assert(err == CUTILS_INDEX_ERROR);
+  btree_free(t);
+
+  t = malloc(sizeof(btree_t));
+  err = btree_init(t, NULL);
+  assert(err == CUTILS_SUCCESS);
+  array_list_set(l, 10, (void *)10);
+  err = btree_bulk_load(t, l, key_of);
+  assert(err == CUTILS_INDEX_ERROR);
+  assert(t->length == 0);
+
+  err = btree_bulk_load(NULL, l, key_of);
+  assert(err == CUTILS_NULL_ERROR);
+
+  btree_free(t);
+  array_list_free(l);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_btree_init_and_free();
+  test_btree_insert_get_remove();
+  test_btree_floor_and_ceiling();
+  test_btree_bulk_load();
+  return EXIT_SUCCESS;
+}
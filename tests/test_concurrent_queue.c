@@ -0,0 +1,207 @@
+#include "cutils/concurrent_queue.h"
+#include "cutils/concurrent_stack.h"
+#include "cutils/errors.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NPRODUCERS 2
+#define NCONSUMERS 2
+#define PER_PRODUCER 40000
+
+void test_concurrent_queue_init_and_free(void) {
+  printf("testing concurrent_queue_init_and_free ... ");
+
+  concurrent_queue_t *q = malloc(sizeof(concurrent_queue_t));
+  cutils_error_t err = concurrent_queue_init(q, NULL, free);
+  assert(err == CUTILS_SUCCESS);
+  assert(q->length == 0);
+
+  for (size_t i = 0; i < 100; i++) {
+    err = concurrent_queue_enqueue(q, malloc(sizeof(size_t)));
+    assert(err == CUTILS_SUCCESS);
+  }
+  // Dequeuing without an out-parameter frees the value
+  err = concurrent_queue_dequeue(q, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(q->length == 99);
+  concurrent_queue_free(q);
+
+  err = concurrent_queue_init(NULL, NULL, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_concurrent_queue_fifo(void) {
+  printf("testing concurrent_queue_fifo ... ");
+
+  concurrent_queue_t *q = malloc(sizeof(concurrent_queue_t));
+  cutils_error_t err = concurrent_queue_init(q, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  void *value = NULL;
+  err = concurrent_queue_dequeue(q, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  for (uintptr_t round = 0; round < 3; round++) {
+    for (uintptr_t i = 0; i < 1000; i++) {
+      err = concurrent_queue_enqueue(q, (void *)i);
+      assert(err == CUTILS_SUCCESS);
+    }
+    for (uintptr_t i = 0; i < 1000; i++) {
+      err = concurrent_queue_dequeue(q, &value);
+      assert(err == CUTILS_SUCCESS);
+      assert(value == (void *)i);
+    }
+    err = concurrent_queue_dequeue(q, &value);
+    assert(err == CUTILS_INDEX_ERROR);
+  }
+  assert(q->length == 0);
+
+  // Later rounds ran entirely on recycled nodes
+  assert(atomic_load(&q->pool->reserved) <= 1002);
+
+  concurrent_queue_free(q);
+
+  printf("success\n");
+}
+
+void test_concurrent_queue_shared_pool(void) {
+  printf("testing concurrent_queue_shared_pool ... ");
+
+  concurrent_pool_t *pool = malloc(sizeof(concurrent_pool_t));
+  cutils_error_t err = concurrent_pool_init(pool);
+  assert(err == CUTILS_SUCCESS);
+
+  concurrent_queue_t *q = malloc(sizeof(concurrent_queue_t));
+  concurrent_stack_t *s = malloc(sizeof(concurrent_stack_t));
+  concurrent_queue_init(q, pool, NULL);
+  concurrent_stack_init(s, pool, NULL);
+
+  // Moving values from the queue to the stack reuses the same nodes
+  for (uintptr_t i = 0; i < 500; i++) {
+    concurrent_queue_enqueue(q, (void *)i);
+  }
+  uint32_t reserved = atomic_load(&pool->reserved);
+  void *value = NULL;
+  while (concurrent_queue_dequeue(q, &value) == CUTILS_SUCCESS) {
+    concurrent_stack_push(s, value);
+  }
+  assert(atomic_load(&pool->reserved) == reserved);
+  assert(s->length == 500);
+
+  concurrent_queue_free(q);
+  concurrent_stack_free(s);
+  concurrent_pool_free(pool);
+
+  printf("success\n");
+}
+
+typedef struct {
+  concurrent_queue_t *q;
+  size_t id;
+} producer_t;
+
+void *producer(void *arg) {
+  producer_t *p = arg;
+  for (uintptr_t i = 0; i < PER_PRODUCER; i++) {
+    uintptr_t value = (p->id << 32) | i;
+    cutils_error_t err = concurrent_queue_enqueue(p->q, (void *)value);
+    assert(err == CUTILS_SUCCESS);
+  }
+  return NULL;
+}
+
+typedef struct {
+  concurrent_queue_t *q;
+  atomic_size_t *remaining;
+  bool *seen;
+} consumer_t;
+
+void *consumer(void *arg) {
+  consumer_t *c = arg;
+  uintptr_t last[NPRODUCERS];
+  for (size_t i = 0; i < NPRODUCERS; i++) {
+    last[i] = UINTPTR_MAX;
+  }
+
+  while (atomic_load(c->remaining) > 0) {
+    void *out = NULL;
+    if (concurrent_queue_dequeue(c->q, &out) != CUTILS_SUCCESS) {
+      continue;
+    }
+    atomic_fetch_sub(c->remaining, 1);
+
+    // Each producer's values arrive in the order it enqueued them
+    uintptr_t id = (uintptr_t)out >> 32;
+    uintptr_t seq = (uintptr_t)out & 0xffffffff;
+    assert(id < NPRODUCERS);
+    assert(last[id] == UINTPTR_MAX || seq > last[id]);
+    last[id] = seq;
+    c->seen[id * PER_PRODUCER + seq] = true;
+  }
+  return NULL;
+}
+
+void test_concurrent_queue_contention(void) {
+  printf("testing concurrent_queue_contention ... ");
+
+  concurrent_queue_t *q = malloc(sizeof(concurrent_queue_t));
+  cutils_error_t err = concurrent_queue_init(q, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  atomic_size_t remaining = NPRODUCERS * PER_PRODUCER;
+  bool *seen[NCONSUMERS];
+  pthread_t consumers[NCONSUMERS];
+  consumer_t cargs[NCONSUMERS];
+  for (size_t i = 0; i < NCONSUMERS; i++) {
+    seen[i] = calloc(NPRODUCERS * PER_PRODUCER, sizeof(bool));
+    assert(seen[i] != NULL);
+    cargs[i] = (consumer_t){q, &remaining, seen[i]};
+    pthread_create(&consumers[i], NULL, consumer, &cargs[i]);
+  }
+
+  pthread_t producers[NPRODUCERS];
+  producer_t pargs[NPRODUCERS];
+  for (size_t i = 0; i < NPRODUCERS; i++) {
+    pargs[i] = (producer_t){q, i};
+    pthread_create(&producers[i], NULL, producer, &pargs[i]);
+  }
+
+  for (size_t i = 0; i < NPRODUCERS; i++) {
+    pthread_join(producers[i], NULL);
+  }
+  for (size_t i = 0; i < NCONSUMERS; i++) {
+    pthread_join(consumers[i], NULL);
+  }
+  assert(q->length == 0);
+
+  // Every value was taken by exactly one consumer
+  for (size_t v = 0; v < NPRODUCERS * PER_PRODUCER; v++) {
+    size_t count = 0;
+    for (size_t i = 0; i < NCONSUMERS; i++) {
+      count += seen[i][v];
+    }
+    assert(count == 1);
+  }
+
+  for (size_t i = 0; i < NCONSUMERS; i++) {
+    free(seen[i]);
+  }
+  concurrent_queue_free(q);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_concurrent_queue_init_and_free();
+  test_concurrent_queue_fifo();
+  test_concurrent_queue_shared_pool();
+  test_concurrent_queue_contention();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+#include "cutils/concurrent_skip_list.h"
+#include "cutils/errors.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NTHREADS 4
+#define PER_THREAD 5000
+
+int cmp_key(void *lhs, void *rhs) {
+  uintptr_t l = (uintptr_t)lhs;
+  uintptr_t r = (uintptr_t)rhs;
+  return (l > r) - (l < r);
+}
+
+void test_concurrent_skip_list_basic(void) {
+  printf("testing concurrent_skip_list_basic ... ");
+
+  concurrent_skip_list_t *s = malloc(sizeof(concurrent_skip_list_t));
+  cutils_error_t err = concurrent_skip_list_init(s, cmp_key, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  for (uintptr_t k = 10; k <= 100; k += 10) {
+    err = concurrent_skip_list_insert(s, (void *)k, (void *)(k + 1));
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(s->length == 10);
+
+  err = concurrent_skip_list_insert(s, (void *)(uintptr_t)50, NULL);
+  assert(err == CUTILS_DUPLICATE_ERROR);
+  assert(s->length == 10);
+
+  void *value = NULL;
+  err = concurrent_skip_list_get(s, (void *)(uintptr_t)70, &value);
+  assert(err == CUTILS_SUCCESS);
+  assert(value == (void *)(uintptr_t)71);
+  err = concurrent_skip_list_get(s, (void *)(uintptr_t)75, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  void *found = NULL;
+  err = concurrent_skip_list_floor(s, (void *)(uintptr_t)75, &found, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(found == (void *)(uintptr_t)70);
+  err = concurrent_skip_list_floor(s, (void *)(uintptr_t)9, &found, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  err = concurrent_skip_list_ceiling(s, (void *)(uintptr_t)75, &found, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(found == (void *)(uintptr_t)80);
+  err = concurrent_skip_list_ceiling(s, (void *)(uintptr_t)101, &found, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  concurrent_skip_list_iter_t it;
+  uintptr_t expected = 30;
+  for (concurrent_skip_list_seek(s, (void *)(uintptr_t)25, &it);
+       concurrent_skip_list_iter_valid(&it);
+       concurrent_skip_list_iter_next(&it)) {
+    void *key = NULL;
+    concurrent_skip_list_iter_get(&it, &key, NULL);
+    assert(key == (void *)expected);
+    expected += 10;
+  }
+  assert(expected == 110);
+
+  concurrent_skip_list_free(s);
+
+  printf("success\n");
+}
+
+typedef struct {
+  concurrent_skip_list_t *s;
+  size_t id;
+} inserter_t;
+
+void *inserter(void *arg) {
+  inserter_t *in = arg;
+  // Interleave key ranges so threads contend on the same neighbourhoods,
+  // and have every thread race on a shared set of keys
+  for (size_t i = 0; i < PER_THREAD; i++) {
+    uintptr_t k = 1 + i * NTHREADS + in->id;
+    cutils_error_t err =
+        concurrent_skip_list_insert(in->s, (void *)k, (void *)k);
+    assert(err == CUTILS_SUCCESS);
+
+    uintptr_t shared = NTHREADS * PER_THREAD + 1 + i % 100;
+    err = concurrent_skip_list_insert(in->s, (void *)shared, (void *)shared);
+    assert(err == CUTILS_SUCCESS || err == CUTILS_DUPLICATE_ERROR);
+  }
+  return NULL;
+}
+
+void *reader(void *arg) {
+  concurrent_skip_list_t *s = arg;
+  for (size_t round = 0; round < 20; round++) {
+    concurrent_skip_list_iter_t it;
+    uintptr_t prev = 0;
+    for (concurrent_skip_list_seek(s, NULL, &it);
+         concurrent_skip_list_iter_valid(&it);
+         concurrent_skip_list_iter_next(&it)) {
+      void *key = NULL;
+      concurrent_skip_list_iter_get(&it, &key, NULL);
+      assert((uintptr_t)key > prev);
+      prev = (uintptr_t)key;
+    }
+  }
+  return NULL;
+}
+
+void test_concurrent_skip_list_parallel_insert(void) {
+  printf("testing concurrent_skip_list_parallel_insert ... ");
+
+  concurrent_skip_list_t *s = malloc(sizeof(concurrent_skip_list_t));
+  cutils_error_t err = concurrent_skip_list_init(s, cmp_key, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  pthread_t threads[NTHREADS + 1];
+  inserter_t args[NTHREADS];
+  for (size_t i = 0; i < NTHREADS; i++) {
+    args[i] = (inserter_t){s, i};
+    pthread_create(&threads[i], NULL, inserter, &args[i]);
+  }
+  pthread_create(&threads[NTHREADS], NULL, reader, s);
+  for (size_t i = 0; i <= NTHREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  size_t total = NTHREADS * PER_THREAD + 100;
+  assert(s->length == total);
+
+  concurrent_skip_list_iter_t it;
+  uintptr_t expected = 1;
+  for (concurrent_skip_list_seek(s, NULL, &it);
+       concurrent_skip_list_iter_valid(&it);
+       concurrent_skip_list_iter_next(&it)) {
+    void *key = NULL;
+    void *value = NULL;
+    concurrent_skip_list_iter_get(&it, &key, &value);
+    assert(key == (void *)expected);
+    assert(value == key);
+    expected++;
+  }
+  assert(expected == total + 1);
+
+  for (uintptr_t k = 1; k <= total; k++) {
+    void *value = NULL;
+    err = concurrent_skip_list_get(s, (void *)k, &value);
+    assert(err == CUTILS_SUCCESS);
+  }
+
+  concurrent_skip_list_free(s);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_concurrent_skip_list_basic();
+  test_concurrent_skip_list_parallel_insert();
+  return EXIT_SUCCESS;
+}
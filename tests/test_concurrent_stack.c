@@ -0,0 +1,167 @@
+#include "cutils/concurrent_stack.h"
+#include "cutils/errors.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NTHREADS 4
+#define PER_THREAD 20000
+
+void test_concurrent_stack_init_and_free(void) {
+  printf("testing concurrent_stack_init_and_free ... ");
+
+  concurrent_stack_t *s = malloc(sizeof(concurrent_stack_t));
+  cutils_error_t err = concurrent_stack_init(s, NULL, free);
+  assert(err == CUTILS_SUCCESS);
+  assert(s->length == 0);
+
+  for (size_t i = 0; i < 100; i++) {
+    err = concurrent_stack_push(s, malloc(sizeof(size_t)));
+    assert(err == CUTILS_SUCCESS);
+  }
+  // Popping without an out-parameter frees the value
+  err = concurrent_stack_pop(s, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(s->length == 99);
+  concurrent_stack_free(s);
+
+  err = concurrent_stack_init(NULL, NULL, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_concurrent_stack_push_and_pop(void) {
+  printf("testing concurrent_stack_push_and_pop ... ");
+
+  concurrent_stack_t *s = malloc(sizeof(concurrent_stack_t));
+  cutils_error_t err = concurrent_stack_init(s, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  void *value = NULL;
+  err = concurrent_stack_pop(s, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  for (uintptr_t i = 0; i < 1000; i++) {
+    err = concurrent_stack_push(s, (void *)i);
+    assert(err == CUTILS_SUCCESS);
+  }
+  for (uintptr_t i = 1000; i > 0; i--) {
+    err = concurrent_stack_pop(s, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)(i - 1));
+  }
+  assert(s->length == 0);
+  err = concurrent_stack_pop(s, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  // Popped nodes are recycled rather than carved afresh
+  uint32_t reserved = atomic_load(&s->pool->reserved);
+  for (uintptr_t i = 0; i < 1000; i++) {
+    concurrent_stack_push(s, (void *)i);
+  }
+  assert(atomic_load(&s->pool->reserved) == reserved);
+
+  concurrent_stack_free(s);
+
+  printf("success\n");
+}
+
+void test_concurrent_stack_shared_pool(void) {
+  printf("testing concurrent_stack_shared_pool ... ");
+
+  concurrent_pool_t *pool = malloc(sizeof(concurrent_pool_t));
+  cutils_error_t err = concurrent_pool_init(pool);
+  assert(err == CUTILS_SUCCESS);
+
+  concurrent_stack_t *a = malloc(sizeof(concurrent_stack_t));
+  concurrent_stack_t *b = malloc(sizeof(concurrent_stack_t));
+  concurrent_stack_init(a, pool, NULL);
+  concurrent_stack_init(b, pool, NULL);
+
+  for (uintptr_t i = 0; i < 500; i++) {
+    concurrent_stack_push(a, (void *)i);
+  }
+  // Freeing a stack hands its nodes back to the shared pool
+  concurrent_stack_free(a);
+  uint32_t reserved = atomic_load(&pool->reserved);
+  for (uintptr_t i = 0; i < 500; i++) {
+    concurrent_stack_push(b, (void *)i);
+  }
+  assert(atomic_load(&pool->reserved) == reserved);
+
+  concurrent_stack_free(b);
+  concurrent_pool_free(pool);
+
+  printf("success\n");
+}
+
+typedef struct {
+  concurrent_stack_t *s;
+  size_t id;
+  uintptr_t *popped;
+} worker_t;
+
+// Interleaves pushes of distinct values with pops, so nodes are recycled
+// while other threads still race on them.
+void *worker(void *arg) {
+  worker_t *w = arg;
+  for (size_t i = 0; i < PER_THREAD; i++) {
+    uintptr_t value = w->id * PER_THREAD + i;
+    cutils_error_t err = concurrent_stack_push(w->s, (void *)value);
+    assert(err == CUTILS_SUCCESS);
+
+    void *out = NULL;
+    while (concurrent_stack_pop(w->s, &out) != CUTILS_SUCCESS) {
+    }
+    w->popped[i] = (uintptr_t)out;
+  }
+  return NULL;
+}
+
+void test_concurrent_stack_contention(void) {
+  printf("testing concurrent_stack_contention ... ");
+
+  concurrent_stack_t *s = malloc(sizeof(concurrent_stack_t));
+  cutils_error_t err = concurrent_stack_init(s, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  uintptr_t *popped = malloc(sizeof(uintptr_t) * NTHREADS * PER_THREAD);
+  assert(popped != NULL);
+
+  pthread_t threads[NTHREADS];
+  worker_t args[NTHREADS];
+  for (size_t i = 0; i < NTHREADS; i++) {
+    args[i] = (worker_t){s, i, &popped[i * PER_THREAD]};
+    pthread_create(&threads[i], NULL, worker, &args[i]);
+  }
+  for (size_t i = 0; i < NTHREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  assert(s->length == 0);
+
+  bool *seen = calloc(NTHREADS * PER_THREAD, sizeof(bool));
+  assert(seen != NULL);
+  for (size_t i = 0; i < NTHREADS * PER_THREAD; i++) {
+    assert(!seen[popped[i]]);
+    seen[popped[i]] = true;
+  }
+
+  free(seen);
+  free(popped);
+  concurrent_stack_free(s);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_concurrent_stack_init_and_free();
+  test_concurrent_stack_push_and_pop();
+  test_concurrent_stack_shared_pool();
+  test_concurrent_stack_contention();
+  return EXIT_SUCCESS;
+}
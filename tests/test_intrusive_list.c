@@ -0,0 +1,159 @@
+#include "cutils/errors.h"
+#include "cutils/intrusive_list.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  size_t id;
+  intrusive_list_link_t link;
+} test_item_t;
+
+bool verify_order(intrusive_list_t *l, size_t n, const size_t ids[n]) {
+  if (l->length != n) {
+    return false;
+  }
+
+  size_t i = 0;
+  INTRUSIVE_LIST_FOR_EACH(l, link) {
+    test_item_t *item = INTRUSIVE_LIST_ENTRY(link, test_item_t, link);
+    if (i >= n || item->id != ids[i]) {
+      return false;
+    }
+    i++;
+  }
+
+  // Walk backwards too so that prev pointers are checked
+  for (intrusive_list_link_t *link = l->root.prev; link != &l->root;
+       link = link->prev) {
+    test_item_t *item = INTRUSIVE_LIST_ENTRY(link, test_item_t, link);
+    if (i == 0 || item->id != ids[i - 1]) {
+      return false;
+    }
+    i--;
+  }
+
+  return i == 0;
+}
+
+void test_intrusive_list_push_and_pop(void) {
+  printf("testing intrusive_list_push_and_pop ... ");
+
+  test_item_t items[4] = {{.id = 0}, {.id = 1}, {.id = 2}, {.id = 3}};
+  intrusive_list_t l;
+  cutils_error_t err = intrusive_list_init(&l);
+  assert(err == CUTILS_SUCCESS);
+  assert(l.length == 0);
+
+  // A link left uninitialised looks linked until it is reset
+  test_item_t stray;
+  memset(&stray, 0xff, sizeof(stray));
+  assert(intrusive_list_is_linked(&stray.link));
+  err = intrusive_list_link_init(&stray.link);
+  assert(err == CUTILS_SUCCESS);
+  assert(!intrusive_list_is_linked(&stray.link));
+  err = intrusive_list_unlink(&l, &stray.link);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = intrusive_list_link_init(NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  intrusive_list_push_back(&l, &items[1].link);
+  intrusive_list_push_back(&l, &items[2].link);
+  intrusive_list_push_front(&l, &items[0].link);
+  intrusive_list_push_back(&l, &items[3].link);
+  assert(verify_order(&l, 4, (size_t[]){0, 1, 2, 3}));
+
+  intrusive_list_link_t *link = NULL;
+  err = intrusive_list_pop_front(&l, &link);
+  assert(err == CUTILS_SUCCESS);
+  assert(INTRUSIVE_LIST_ENTRY(link, test_item_t, link)->id == 0);
+  assert(!intrusive_list_is_linked(link));
+
+  err = intrusive_list_pop_back(&l, &link);
+  assert(err == CUTILS_SUCCESS);
+  assert(INTRUSIVE_LIST_ENTRY(link, test_item_t, link)->id == 3);
+  assert(verify_order(&l, 2, (size_t[]){1, 2}));
+
+  intrusive_list_pop_back(&l, &link);
+  intrusive_list_pop_back(&l, &link);
+  err = intrusive_list_pop_back(&l, &link);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  printf("success\n");
+}
+
+void test_intrusive_list_insert_and_unlink(void) {
+  printf("testing intrusive_list_insert_and_unlink ... ");
+
+  test_item_t items[5] = {
+      {.id = 0}, {.id = 1}, {.id = 2}, {.id = 3}, {.id = 4}};
+  intrusive_list_t l;
+  intrusive_list_init(&l);
+
+  intrusive_list_push_back(&l, &items[0].link);
+  intrusive_list_push_back(&l, &items[4].link);
+  intrusive_list_insert_after(&l, &items[0].link, &items[2].link);
+  intrusive_list_insert_before(&l, &items[2].link, &items[1].link);
+  intrusive_list_insert_before(&l, &items[4].link, &items[3].link);
+  assert(verify_order(&l, 5, (size_t[]){0, 1, 2, 3, 4}));
+
+  cutils_error_t err = intrusive_list_unlink(&l, &items[2].link);
+  assert(err == CUTILS_SUCCESS);
+  assert(verify_order(&l, 4, (size_t[]){0, 1, 3, 4}));
+
+  err = intrusive_list_unlink(&l, &items[2].link);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  intrusive_list_unlink(&l, &items[0].link);
+  intrusive_list_unlink(&l, &items[4].link);
+  assert(verify_order(&l, 2, (size_t[]){1, 3}));
+
+  printf("success\n");
+}
+
+void test_intrusive_list_splice(void) {
+  printf("testing intrusive_list_splice ... ");
+
+  test_item_t items[6] = {{.id = 0}, {.id = 1}, {.id = 2},
+                          {.id = 3}, {.id = 4}, {.id = 5}};
+  intrusive_list_t a;
+  intrusive_list_t b;
+  intrusive_list_init(&a);
+  intrusive_list_init(&b);
+
+  intrusive_list_push_back(&a, &items[0].link);
+  intrusive_list_push_back(&a, &items[4].link);
+  intrusive_list_push_back(&a, &items[5].link);
+  intrusive_list_push_back(&b, &items[1].link);
+  intrusive_list_push_back(&b, &items[2].link);
+  intrusive_list_push_back(&b, &items[3].link);
+
+  cutils_error_t err = intrusive_list_splice(&a, &items[4].link, &b);
+  assert(err == CUTILS_SUCCESS);
+  assert(verify_order(&a, 6, (size_t[]){0, 1, 2, 3, 4, 5}));
+  assert(b.length == 0);
+  assert(b.root.next == &b.root);
+
+  // Splicing an empty list is a no-op, and splicing at the end appends
+  err = intrusive_list_splice(&a, &a.root, &b);
+  assert(err == CUTILS_SUCCESS);
+  assert(a.length == 6);
+
+  intrusive_list_unlink(&a, &items[5].link);
+  intrusive_list_push_back(&b, &items[5].link);
+  err = intrusive_list_splice(&a, &a.root, &b);
+  assert(err == CUTILS_SUCCESS);
+  assert(verify_order(&a, 6, (size_t[]){0, 1, 2, 3, 4, 5}));
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_intrusive_list_push_and_pop();
+  test_intrusive_list_insert_and_unlink();
+  test_intrusive_list_splice();
+  return EXIT_SUCCESS;
+}
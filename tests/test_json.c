@@ -1,10 +1,14 @@
 #include "cutils/json.h"
 #include "cutils/errors.h"
+#include "cutils/thread_pool.h"
 #include <assert.h>
 #include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 void test_parse_literals(void) {
   printf("testing json_parse literals ... ");
@@ -118,17 +122,17 @@ void test_parse_object(void) {
   assert(val->value.object->length == 3);
 
   json_value_t *item = NULL;
-  hashmap_get(val->value.object, "a", (void **)&item);
+  json_object_get(val->value.object, "a", &item);
   assert(item->type == JSON_NUMBER && item->value.number == 1);
 
-  hashmap_get(val->value.object, "b", (void **)&item);
+  json_object_get(val->value.object, "b", &item);
   assert(item->type == JSON_ARRAY && item->value.array->length == 2);
 
-  hashmap_get(val->value.object, "c", (void **)&item);
+  json_object_get(val->value.object, "c", &item);
   assert(item->type == JSON_OBJECT);
 
   json_value_t *nested_item = NULL;
-  hashmap_get(item->value.object, "d", (void **)&nested_item);
+  json_object_get(item->value.object, "d", &nested_item);
   assert(nested_item->type == JSON_NULL);
 
   json_value_free(val);
@@ -136,6 +140,92 @@ void test_parse_object(void) {
   printf("success\n");
 }
 
+json_value_t *number(double n) {
+  json_value_t *v = malloc(sizeof(json_value_t));
+  assert(v != NULL);
+  *v = (json_value_t){.type = JSON_NUMBER, .value.number = n};
+  return v;
+}
+
+char *key(size_t i) {
+  char *k = malloc(16);
+  assert(k != NULL);
+  snprintf(k, 16, "key_%zu", i);
+  return k;
+}
+
+void test_object(void) {
+  printf("testing json_object ... ");
+
+  json_object_t *o = malloc(sizeof(json_object_t));
+  cutils_error_t err = json_object_init(o, 0);
+  assert(err == CUTILS_SUCCESS);
+
+  char k[16];
+  json_value_t *item = NULL;
+  err = json_object_get(o, "missing", &item);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  // Past the threshold lookups go through the index, rebuilt as it fills
+  size_t n = 1000;
+  for (size_t i = 0; i < n; i++) {
+    err = json_object_append(o, key(i), number((double)i));
+    assert(err == CUTILS_SUCCESS);
+    if (i % 7 == 0) {
+      snprintf(k, sizeof(k), "key_%zu", i / 2);
+      err = json_object_get(o, k, &item);
+      assert(err == CUTILS_SUCCESS);
+      assert(item->value.number == (double)(i / 2));
+    }
+  }
+  assert(o->length == n);
+  assert(o->slots != NULL && 2 * o->length <= o->nslots);
+  for (size_t i = 0; i < n; i++) {
+    snprintf(k, sizeof(k), "key_%zu", i);
+    assert(strcmp(o->members[i].key, k) == 0);
+    assert(o->members[i].value->value.number == (double)i);
+  }
+
+  // Setting replaces in place, appending keeps both with the last visible
+  err = json_object_set(o, key(500), number(-1));
+  assert(err == CUTILS_SUCCESS);
+  assert(o->length == n);
+  assert(o->members[500].value->value.number == -1);
+  err = json_object_append(o, key(3), number(-3));
+  assert(err == CUTILS_SUCCESS);
+  json_object_get(o, "key_3", &item);
+  assert(item->value.number == -3);
+  err = json_object_set(o, key(3), number(-4));
+  assert(err == CUTILS_SUCCESS);
+  assert(o->members[3].value->value.number == 3);
+  assert(o->members[n].value->value.number == -4);
+  err = json_object_set(o, key(n), number(1));
+  assert(err == CUTILS_SUCCESS);
+  assert(o->length == n + 2);
+  err = json_object_get(o, "key_1001", &item);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  // A small object is scanned, newest first
+  json_value_t *val = NULL;
+  json_parse("{\"k\": 1, \"j\": 2, \"k\": 3}", &val);
+  assert(val->value.object->length == 3);
+  assert(val->value.object->slots == NULL);
+  json_object_get(val->value.object, "k", &item);
+  assert(item->value.number == 3);
+  json_value_free(val);
+
+  err = json_object_get(o, NULL, &item);
+  assert(err == CUTILS_NULL_ERROR);
+  err = json_object_append(o, NULL, item);
+  assert(err == CUTILS_NULL_ERROR);
+  err = json_object_init(NULL, 0);
+  assert(err == CUTILS_NULL_ERROR);
+
+  json_object_free(o);
+
+  printf("success\n");
+}
+
 void test_parse_errors(void) {
   printf("testing json_parse errors ... ");
   json_value_t *val = NULL;
@@ -160,12 +250,1366 @@ void test_parse_errors(void) {
   printf("success\n");
 }
 
+// Stringifies `v` and checks the output matches `expected` exactly.
+void check_stringify(json_value_t *v, json_format_t format,
+                     const char *expected) {
+  json_buffer_t *b = malloc(sizeof(json_buffer_t));
+  cutils_error_t err = json_buffer_init(b, 1);
+  assert(err == CUTILS_SUCCESS);
+  err = json_stringify(v, format, b);
+  assert(err == CUTILS_SUCCESS);
+  assert(b->length == strlen(expected));
+  assert(strcmp(b->data, expected) == 0);
+  json_buffer_free(b);
+}
+
+void check_stringify_text(const char *text, json_format_t format,
+                          const char *expected) {
+  json_value_t *val = NULL;
+  cutils_error_t err = json_parse(text, &val);
+  assert(err == CUTILS_SUCCESS);
+  check_stringify(val, format, expected);
+  json_value_free(val);
+}
+
+void test_stringify_compact_and_pretty(void) {
+  printf("testing json_stringify compact and pretty ... ");
+
+  check_stringify_text(" [ 1, \"two\", true, false, null, [ ], { } ] ",
+                       JSON_FORMAT_COMPACT,
+                       "[1,\"two\",true,false,null,[],{}]");
+  check_stringify_text("{ \"a\" : { \"b\" : [ -2.5 ] } }",
+                       JSON_FORMAT_COMPACT, "{\"a\":{\"b\":[-2.5]}}");
+  check_stringify_text("{\"a\":[1,{}],\"b\":[]}", JSON_FORMAT_PRETTY,
+                       "{\n  \"a\": [\n    1,\n    {}\n  ],\n  \"b\": []\n}");
+  check_stringify_text("7", JSON_FORMAT_PRETTY, "7");
+  // Members come out in document order, repeats included
+  check_stringify_text("{\"z\":1,\"a\":2,\"z\":3}", JSON_FORMAT_COMPACT,
+                       "{\"z\":1,\"a\":2,\"z\":3}");
+
+  // Appends to what is already there
+  json_value_t *val = NULL;
+  json_parse("[null]", &val);
+  json_buffer_t *b = malloc(sizeof(json_buffer_t));
+  json_buffer_init(b, 0);
+  json_stringify(val, JSON_FORMAT_COMPACT, b);
+  json_stringify(val, JSON_FORMAT_COMPACT, b);
+  assert(strcmp(b->data, "[null][null]") == 0);
+
+  cutils_error_t err = json_stringify(NULL, JSON_FORMAT_COMPACT, b);
+  assert(err == CUTILS_NULL_ERROR);
+
+  json_buffer_free(b);
+  json_value_free(val);
+
+  printf("success\n");
+}
+
+void test_stringify_numbers(void) {
+  printf("testing json_stringify numbers ... ");
+
+  struct {
+    double number;
+    const char *expected;
+  } cases[] = {
+      {0.0, "0"},
+      {-0.0, "-0"},
+      {42.0, "42"},
+      {-1.0, "-1"},
+      {0.1, "0.1"},
+      {123.456, "123.456"},
+      {1.0 / 3.0, "0.3333333333333333"},
+      {0.000001, "0.000001"},
+      {1.5e-7, "1.5e-7"},
+      {1e20, "100000000000000000000"},
+      {1e21, "1e21"},
+      {1.25e100, "1.25e100"},
+      {9007199254740992.0, "9007199254740992"},
+      {5e-324, "5e-324"},
+      {2.2250738585072014e-308, "2.2250738585072014e-308"},
+      {1.7976931348623157e308, "1.7976931348623157e308"},
+      {NAN, "null"},
+      {-INFINITY, "null"},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    json_value_t v = {.type = JSON_NUMBER, .value.number = cases[i].number};
+    check_stringify(&v, JSON_FORMAT_COMPACT, cases[i].expected);
+  }
+
+  // Random bit patterns all parse back exactly in at most 17 digits
+  json_buffer_t *b = malloc(sizeof(json_buffer_t));
+  json_buffer_init(b, 0);
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  for (size_t i = 0; i < 100000; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    double number;
+    memcpy(&number, &state, sizeof(number));
+    if (isnan(number) || isinf(number)) {
+      continue;
+    }
+
+    json_value_t v = {.type = JSON_NUMBER, .value.number = number};
+    b->length = 0;
+    cutils_error_t err = json_stringify(&v, JSON_FORMAT_COMPACT, b);
+    assert(err == CUTILS_SUCCESS);
+    double parsed = strtod(b->data, NULL);
+    assert(memcmp(&parsed, &number, sizeof(number)) == 0);
+
+    // Significant digits, ignoring zeros padding out large integers
+    size_t digits = 0;
+    size_t significant = 0;
+    bool leading = true;
+    for (char *c = b->data; *c && *c != 'e'; c++) {
+      leading = leading && (*c == '0' || *c == '.' || *c == '-');
+      digits += !leading && *c != '.';
+      significant = *c >= '1' && *c <= '9' ? digits : significant;
+    }
+    assert(significant <= 17);
+  }
+  json_buffer_free(b);
+
+  printf("success\n");
+}
+
+void test_stringify_strings(void) {
+  printf("testing json_stringify strings ... ");
+
+  check_stringify_text("\"plain text with no escapes at all\"",
+                       JSON_FORMAT_COMPACT,
+                       "\"plain text with no escapes at all\"");
+  check_stringify_text("\"q\\\"b\\\\s\\/n\\nt\\tc\\u0001\\u001f\\u20AC\"",
+                       JSON_FORMAT_COMPACT,
+                       "\"q\\\"b\\\\s/n\\nt\\tc\\u0001\\u001f€\"");
+  check_stringify_text("{\"k\\\"ey\":\"\"}", JSON_FORMAT_COMPACT,
+                       "{\"k\\\"ey\":\"\"}");
+
+  // Escapes at every offset within a word
+  char text[32];
+  char expected[64];
+  for (size_t i = 0; i < 20; i++) {
+    memset(text, 'x', 20);
+    text[i] = '\n';
+    text[20] = '\0';
+    json_value_t v = {.type = JSON_STRING, .value.string = text};
+    snprintf(expected, sizeof(expected), "\"%.*s\\n%s\"", (int)i, text,
+             &text[i + 1]);
+    check_stringify(&v, JSON_FORMAT_COMPACT, expected);
+  }
+
+  printf("success\n");
+}
+
+cutils_error_t collect(void *ctx, const char *data, size_t length) {
+  json_buffer_t *b = ctx;
+  assert(length > 0);
+  if (b->length + length >= b->capacity) {
+    b->capacity = (b->length + length) * 2;
+    b->data = realloc(b->data, b->capacity);
+  }
+  memcpy(&b->data[b->length], data, length);
+  b->length += length;
+  b->data[b->length] = '\0';
+  return CUTILS_SUCCESS;
+}
+
+cutils_error_t refuse(void *ctx, const char *data, size_t length) {
+  (void)ctx;
+  (void)data;
+  (void)length;
+  return CUTILS_INDEX_ERROR;
+}
+
+void test_stringify_sink(void) {
+  printf("testing json_stringify_sink ... ");
+
+  // Large enough to flush the staging buffer many times
+  json_buffer_t *text = malloc(sizeof(json_buffer_t));
+  json_buffer_init(text, 0);
+  collect(text, "[", 1);
+  for (size_t i = 0; i < 5000; i++) {
+    char item[64];
+    int n = snprintf(item, sizeof(item), "%s{\"id\":%zu,\"name\":\"n%zu\"}",
+                     i > 0 ? "," : "", i, i);
+    collect(text, item, (size_t)n);
+  }
+  collect(text, "]", 1);
+
+  json_value_t *val = NULL;
+  cutils_error_t err = json_parse(text->data, &val);
+  assert(err == CUTILS_SUCCESS);
+
+  for (json_format_t f = JSON_FORMAT_COMPACT; f <= JSON_FORMAT_PRETTY; f++) {
+    json_buffer_t *streamed = malloc(sizeof(json_buffer_t));
+    json_buffer_init(streamed, 0);
+    err = json_stringify_sink(val, f, collect, streamed);
+    assert(err == CUTILS_SUCCESS);
+    assert(streamed->length > 4096);
+
+    json_buffer_t *direct = malloc(sizeof(json_buffer_t));
+    json_buffer_init(direct, 0);
+    json_stringify(val, f, direct);
+    assert(streamed->length == direct->length);
+    assert(memcmp(streamed->data, direct->data, direct->length) == 0);
+
+    json_buffer_free(streamed);
+    json_buffer_free(direct);
+  }
+
+  // A failing sink aborts the write
+  err = json_stringify_sink(val, JSON_FORMAT_COMPACT, refuse, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  json_value_free(val);
+  json_buffer_free(text);
+
+  printf("success\n");
+}
+
+// Byte-at-a-time statement of what the index should hold.
+size_t reference_index(const char *text, size_t length, uint32_t *out,
+                       bool *open) {
+  size_t count = 0;
+  bool escaped = false;
+  bool in_string = false;
+  bool scalar = false;
+  for (size_t i = 0; i < length; i++) {
+    char c = text[i];
+    bool quote = c == '"' && !escaped;
+    escaped = c == '\\' && !escaped;
+    bool op = c && strchr("{}[]:,", c);
+    bool space = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    bool is_scalar = !op && !space;
+
+    in_string ^= quote;
+    bool tail = in_string ^ quote;
+    if (!tail && (op || (is_scalar && !scalar))) {
+      out[count++] = (uint32_t)i;
+    }
+    scalar = is_scalar && !quote;
+  }
+  out[count++] = (uint32_t)length;
+  *open = in_string;
+  return count;
+}
+
+typedef struct {
+  char log[512];
+  size_t length;
+  size_t depth;     // Expected depth of the next event
+  const char *skip; // Key, or "[" or "{", to answer with JSON_SKIP
+  size_t stop;      // Events to allow before JSON_STOP, 0 for all
+  size_t events;
+} recorder_t;
+
+// Logs each event as a short token, checking depths as it goes.
+json_action_t record(void *ctx, json_event_t *e) {
+  recorder_t *r = ctx;
+  r->events++;
+  if (r->stop > 0 && r->events > r->stop) {
+    return JSON_STOP;
+  }
+
+  if (e->type == JSON_EVENT_END_ARRAY || e->type == JSON_EVENT_END_OBJECT) {
+    r->depth--;
+  }
+  assert(e->depth == r->depth);
+
+  char *out = &r->log[r->length];
+  size_t room = sizeof(r->log) - r->length;
+  json_action_t action = JSON_CONTINUE;
+  switch (e->type) {
+  case JSON_EVENT_NULL:
+    r->length += snprintf(out, room, "n ");
+    break;
+  case JSON_EVENT_BOOLEAN:
+    r->length += snprintf(out, room, "%c ", e->boolean ? 't' : 'f');
+    break;
+  case JSON_EVENT_NUMBER:
+    r->length += snprintf(out, room, "%g ", e->number);
+    break;
+  case JSON_EVENT_STRING:
+    assert(strlen(e->string) == e->length);
+    r->length += snprintf(out, room, "s:%s ", e->string);
+    break;
+  case JSON_EVENT_KEY:
+    r->length += snprintf(out, room, "k:%s ", e->string);
+    if (r->skip && strcmp(r->skip, e->string) == 0) {
+      action = JSON_SKIP;
+    }
+    break;
+  case JSON_EVENT_START_ARRAY:
+  case JSON_EVENT_START_OBJECT: {
+    const char *token = e->type == JSON_EVENT_START_ARRAY ? "[" : "{";
+    r->length += snprintf(out, room, "%s ", token);
+    if (r->skip && strcmp(r->skip, token) == 0) {
+      r->skip = NULL; // Only the first
+      return JSON_SKIP;
+    }
+    r->depth++;
+  } break;
+  case JSON_EVENT_END_ARRAY:
+    r->length += snprintf(out, room, "] ");
+    break;
+  case JSON_EVENT_END_OBJECT:
+    r->length += snprintf(out, room, "} ");
+    break;
+  }
+  return action;
+}
+
+void check_events(const char *text, const char *skip, size_t stop,
+                  const char *expected) {
+  recorder_t r = {.skip = skip, .stop = stop};
+  cutils_error_t err = json_parse_events(text, record, &r);
+  assert(err == CUTILS_SUCCESS);
+  assert(strcmp(r.log, expected) == 0);
+}
+
+void test_parse_events(void) {
+  printf("testing json_parse_events ... ");
+
+  const char *text = "{\"a\": [1, true, null, \"x\\ty\"], \"b\": {\"c\": "
+                     "-2.5, \"e\": [{}]}, \"d\": []}";
+  check_events(text, NULL, 0,
+               "{ k:a [ 1 t n s:x\ty ] k:b { k:c -2.5 k:e [ { } ] } "
+               "k:d [ ] } ");
+  check_events(" 7 ", NULL, 0, "7 ");
+
+  // Skipping from a key passes over its value, from a start the container
+  check_events(text, "b", 0, "{ k:a [ 1 t n s:x\ty ] k:b k:d [ ] } ");
+  check_events(text, "a", 0, "{ k:a k:b { k:c -2.5 k:e [ { } ] } k:d [ ] } ");
+  check_events(text, "[", 0, "{ k:a [ k:b { k:c -2.5 k:e [ { } ] } k:d [ ] } ");
+  check_events("{\"a\": \"]}\", \"b\": [\"\\\"]\", [[]], 2]}", "a", 0,
+               "{ k:a k:b [ s:\"] [ [ ] ] 2 ] } ");
+  check_events("{\"a\": [\"\\\"]\", {\"x\": [[]]}], \"b\": 2}", "[", 0,
+               "{ k:a [ k:b 2 } ");
+
+  // Stopping succeeds, and what follows is never looked at
+  check_events("[1, 2, oops", NULL, 2, "[ 1 ");
+
+  // Strings longer than the initial scratch buffer
+  char long_text[300];
+  memset(long_text, 'x', sizeof(long_text));
+  long_text[0] = '"';
+  long_text[sizeof(long_text) - 2] = '"';
+  long_text[sizeof(long_text) - 1] = '\0';
+  recorder_t r = {0};
+  cutils_error_t err = json_parse_events(long_text, record, &r);
+  assert(err == CUTILS_SUCCESS);
+  assert(r.events == 1);
+
+  const char *bad[] = {"[1, 2",         "{\"a\" 1}", "[1,]",  "\"open",
+                       "[] x",          "",          "{1: 2}", "[nan]",
+                       "{\"a\": [\"]}", "{\"a\": nan}"};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    r = (recorder_t){.skip = "a"};
+    err = json_parse_events(bad[i], record, &r);
+    assert(err == CUTILS_JSON_PARSE_ERROR);
+  }
+
+  err = json_parse_events(NULL, record, &r);
+  assert(err == CUTILS_NULL_ERROR);
+  err = json_parse_events("1", NULL, &r);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_index(void) {
+  printf("testing json_index ... ");
+
+  json_index_t *idx = malloc(sizeof(json_index_t));
+  cutils_error_t err = json_index_init(idx, 1);
+  assert(err == CUTILS_SUCCESS);
+
+  const char *text = "{\"a\\\"]\": [1, true,\"x\"]}";
+  err = json_index_build(idx, text, strlen(text));
+  assert(err == CUTILS_SUCCESS);
+  uint32_t expected[] = {0, 1, 7, 9, 10, 11, 13, 17, 18, 21, 22, 23};
+  assert(idx->length == sizeof(expected) / sizeof(expected[0]));
+  assert(memcmp(idx->positions, expected, sizeof(expected)) == 0);
+
+  err = json_index_build(idx, "[\"open", 6);
+  assert(err == CUTILS_JSON_PARSE_ERROR);
+
+  // Random text over an alphabet heavy in quotes and backslashes, with
+  // lengths crossing block boundaries
+  json_index_t *scalar = malloc(sizeof(json_index_t));
+  json_index_init(scalar, 0);
+  const char alphabet[] = "{}[]:,\"\"\\\\ \t\nab1-";
+  char text_buf[300];
+  uint32_t reference[301];
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  for (size_t round = 0; round < 20000; round++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    size_t length = state % sizeof(text_buf);
+    for (size_t i = 0; i < length; i++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      text_buf[i] = alphabet[state % (sizeof(alphabet) - 1)];
+    }
+
+    bool open = false;
+    size_t count = reference_index(text_buf, length, reference, &open);
+    cutils_error_t expected_err =
+        open ? CUTILS_JSON_PARSE_ERROR : CUTILS_SUCCESS;
+
+    err = json_index_build(idx, text_buf, length);
+    assert(err == expected_err);
+    assert(idx->length == count);
+    assert(memcmp(idx->positions, reference, count * sizeof(uint32_t)) == 0);
+
+    err = json_index_build_scalar(scalar, text_buf, length);
+    assert(err == expected_err);
+    assert(scalar->length == count);
+    assert(memcmp(scalar->positions, reference, count * sizeof(uint32_t)) ==
+           0);
+  }
+
+  err = json_index_build(NULL, text, 1);
+  assert(err == CUTILS_NULL_ERROR);
+
+  json_index_free(scalar);
+  json_index_free(idx);
+
+  printf("success\n");
+}
+
+void test_parse_indexed(void) {
+  printf("testing json_parse indexed ... ");
+
+  // Long enough to go through the index, whitespace-heavy
+  size_t n = 200;
+  char *text = malloc(n * 64 + 16);
+  size_t pos = (size_t)sprintf(text, "[\n");
+  for (size_t i = 0; i < n; i++) {
+    pos += (size_t)sprintf(&text[pos],
+                           "%s  {\n    \"id\" : %zu ,\n    \"s\" : \"a\\\"]\"\n"
+                           "  }",
+                           i > 0 ? ",\n" : "", i);
+  }
+  sprintf(&text[pos], "\n]\n");
+  assert(strlen(text) >= JSON_INDEX_THRESHOLD);
+
+  json_value_t *val = NULL;
+  cutils_error_t err = json_parse(text, &val);
+  assert(err == CUTILS_SUCCESS);
+  assert(val->value.array->length == n);
+  json_value_t *item = val->value.array->backing[n - 1];
+  json_value_t *field = NULL;
+  json_object_get(item->value.object, "id", &field);
+  assert(field->value.number == (double)(n - 1));
+  json_object_get(item->value.object, "s", &field);
+  assert(strcmp(field->value.string, "a\"]") == 0);
+  json_value_free(val);
+
+  // Junk glued to a scalar, and an unterminated string, on both paths
+  const char *bad[] = {"[1x, 2]", "[truex]", "[\"a\" 1]", "[\"open]"};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    err = json_parse(bad[i], &val);
+    assert(err == CUTILS_JSON_PARSE_ERROR);
+    assert(val == NULL);
+
+    // Pad with trailing whitespace until the index is used
+    memset(text, ' ', JSON_INDEX_THRESHOLD + 1);
+    memcpy(text, bad[i], strlen(bad[i]));
+    text[JSON_INDEX_THRESHOLD + 1] = '\0';
+    err = json_parse(text, &val);
+    assert(err == CUTILS_JSON_PARSE_ERROR);
+    assert(val == NULL);
+  }
+
+  free(text);
+
+  printf("success\n");
+}
+
+// Structural equality, ignoring member order.
+bool values_equal(json_value_t *a, json_value_t *b) {
+  if (a->type != b->type) {
+    return false;
+  }
+
+  switch (a->type) {
+  case JSON_NULL:
+    return true;
+  case JSON_BOOLEAN:
+    return a->value.boolean == b->value.boolean;
+  case JSON_NUMBER:
+    return a->value.number == b->value.number;
+  case JSON_STRING:
+    return strcmp(a->value.string, b->value.string) == 0;
+  case JSON_ARRAY:
+    if (a->value.array->length != b->value.array->length) {
+      return false;
+    }
+    for (size_t i = 0; i < a->value.array->length; i++) {
+      if (!values_equal(a->value.array->backing[i],
+                        b->value.array->backing[i])) {
+        return false;
+      }
+    }
+    return true;
+  case JSON_OBJECT:
+    if (a->value.object->length != b->value.object->length) {
+      return false;
+    }
+    for (size_t i = 0; i < a->value.object->length; i++) {
+      json_member_t *x = &a->value.object->members[i];
+      json_member_t *y = &b->value.object->members[i];
+      if (strcmp(x->key, y->key) != 0 || !values_equal(x->value, y->value)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+// An exactly sized copy of `length` bytes, with nothing after them.
+char *unterminated(const char *text, size_t length) {
+  char *copy = malloc(length > 0 ? length : 1);
+  assert(copy != NULL);
+  memcpy(copy, text, length);
+  return copy;
+}
+
+void test_parse_n(void) {
+  printf("testing json_parse_n ... ");
+
+  // Every prefix parses as it would with a terminator after it
+  const char *texts[] = {
+      "{\"a\": [1, true, null, \"x\\u00e9y\"], \"b\": -2.5e-3, \"c\": false}",
+      "  12345.75  ",
+      "\"\\\\\\\"\"",
+      "-1e+400"};
+  for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); t++) {
+    size_t n = strlen(texts[t]);
+    for (size_t len = 0; len <= n; len++) {
+      char *prefix = unterminated(texts[t], len);
+      char terminated[128];
+      memcpy(terminated, texts[t], len);
+      terminated[len] = '\0';
+
+      json_value_t *val = NULL;
+      json_value_t *reference = NULL;
+      cutils_error_t err = json_parse_n(prefix, len, &val);
+      cutils_error_t expected = json_parse(terminated, &reference);
+      assert(err == expected);
+      assert(err != CUTILS_SUCCESS || values_equal(val, reference));
+      json_value_free(val);
+      json_value_free(reference);
+      free(prefix);
+    }
+  }
+
+  // Long numbers at the very end
+  char digits[200];
+  memset(digits, '0', sizeof(digits));
+  digits[0] = '7';
+  char *number = unterminated(digits, sizeof(digits));
+  json_value_t *val = NULL;
+  cutils_error_t err = json_parse_n(number, sizeof(digits), &val);
+  assert(err == CUTILS_SUCCESS);
+  assert(val->value.number == 7e199);
+  json_value_free(val);
+  free(number);
+
+  // NULs inside the length are stray bytes, not the end
+  struct {
+    const char *text;
+    size_t length;
+  } nuls[] = {{"[1]\0[2]", 7}, {"\"a\0b\"", 5}, {"[1,\0 2]", 7},
+              {"1\0", 2},      {"\0", 1},       {"tru\0", 4}};
+  for (size_t i = 0; i < sizeof(nuls) / sizeof(nuls[0]); i++) {
+    err = json_parse_n(nuls[i].text, nuls[i].length, &val);
+    assert(err == CUTILS_JSON_PARSE_ERROR);
+    assert(val == NULL);
+  }
+  err = json_parse_n("[1] trailing", 4, &val);
+  assert(err == CUTILS_SUCCESS);
+  json_value_free(val);
+
+  // Long input goes through the index, into a tree and a document
+  size_t n = 500;
+  char *big = malloc(n * 48 + 16);
+  size_t pos = (size_t)sprintf(big, "[");
+  for (size_t i = 0; i < n; i++) {
+    pos += (size_t)sprintf(&big[pos], "%s{\"id\": %zu, \"v\": [%zu, \"s\"]}",
+                           i > 0 ? ", " : "", i, i * 2);
+  }
+  pos += (size_t)sprintf(&big[pos], "]");
+  char *exact = unterminated(big, pos);
+  json_value_t *reference = NULL;
+  json_parse(big, &reference);
+  err = json_parse_n(exact, pos, &val);
+  assert(err == CUTILS_SUCCESS);
+  assert(values_equal(val, reference));
+  json_value_free(val);
+
+  json_document_t *d = malloc(sizeof(json_document_t));
+  json_document_init(d, 0);
+  err = json_document_parse_n(d, exact, pos);
+  assert(err == CUTILS_SUCCESS);
+  assert(values_equal(d->root, reference));
+  err = json_document_parse_n(d, exact, pos - 1);
+  assert(err == CUTILS_JSON_PARSE_ERROR);
+  json_document_free(d);
+  json_value_free(reference);
+  free(exact);
+  free(big);
+
+  err = json_parse_n(NULL, 0, &val);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_arena(void) {
+  printf("testing json_arena ... ");
+
+  json_arena_t *a = malloc(sizeof(json_arena_t));
+  cutils_error_t err = json_arena_init(a, 256);
+  assert(err == CUTILS_SUCCESS);
+
+  // Aligned, non-overlapping, and oversized requests get their own chunk
+  char *prev = NULL;
+  for (size_t i = 1; i < 100; i++) {
+    char *ptr = json_arena_alloc(a, i % 7 + 1);
+    assert(ptr != NULL);
+    assert((uintptr_t)ptr % 8 == 0);
+    assert(ptr != prev);
+    memset(ptr, (int)i, i % 7 + 1);
+    prev = ptr;
+  }
+  char *big = json_arena_alloc(a, 1000);
+  assert(big != NULL);
+  memset(big, 0, 1000);
+  size_t reserved = a->reserved;
+  assert(a->used >= 99 * 8 + 1000);
+
+  // The same pattern after a reset needs no new chunks
+  json_arena_reset(a);
+  assert(a->used == 0);
+  for (size_t i = 1; i < 100; i++) {
+    json_arena_alloc(a, i % 7 + 1);
+  }
+  json_arena_alloc(a, 1000);
+  assert(a->reserved == reserved);
+
+  assert(json_arena_alloc(NULL, 8) == NULL);
+  err = json_arena_init(NULL, 0);
+  assert(err == CUTILS_NULL_ERROR);
+
+  json_arena_free(a);
+
+  printf("success\n");
+}
+
+void test_document(void) {
+  printf("testing json_document ... ");
+
+  json_document_t *d = malloc(sizeof(json_document_t));
+  cutils_error_t err = json_document_init(d, 1024);
+  assert(err == CUTILS_SUCCESS);
+
+  const char *text = "{\"a\": 1, \"b\": [true, false, [], {}], "
+                     "\"c\": {\"d\": null, \"e\": \"\\u20AC\"}, \"f\": -2.5}";
+  err = json_document_parse(d, text);
+  assert(err == CUTILS_SUCCESS);
+  assert(d->root->type == JSON_OBJECT);
+  assert(d->root->value.object->length == 4);
+
+  json_value_t *item = NULL;
+  json_object_get(d->root->value.object, "b", &item);
+  assert(item->type == JSON_ARRAY && item->value.array->length == 4);
+  json_object_get(d->root->value.object, "c", &item);
+  json_object_get(item->value.object, "e", &item);
+  assert(strcmp(item->value.string, "€") == 0);
+  err = json_object_get(d->root->value.object, "z", &item);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  json_value_t *reference = NULL;
+  json_parse(text, &reference);
+  assert(values_equal(d->root, reference));
+  json_value_free(reference);
+
+  // Repeated keys are all kept, and lookups see the last
+  err = json_document_parse(d, "{\"k\": 1, \"j\": 2, \"k\": 3}");
+  assert(err == CUTILS_SUCCESS);
+  assert(d->root->value.object->length == 3);
+  json_object_get(d->root->value.object, "k", &item);
+  assert(item->value.number == 3);
+
+  // Failures leave no root and the document usable
+  err = json_document_parse(d, "[1, {\"a\": [2,]}]");
+  assert(err == CUTILS_JSON_PARSE_ERROR);
+  assert(d->root == NULL);
+  assert(d->stack->length == 0);
+
+  // Many documents reuse the same chunks
+  char message[128];
+  size_t reserved = 0;
+  for (size_t i = 0; i < 1000; i++) {
+    snprintf(message, sizeof(message),
+             "{\"id\": %zu, \"tags\": [\"x\", \"y\"], \"ok\": true}", i);
+    err = json_document_parse(d, message);
+    assert(err == CUTILS_SUCCESS);
+    json_object_get(d->root->value.object, "id", &item);
+    assert(item->value.number == (double)i);
+    reserved = i == 0 ? d->arena->reserved : reserved;
+    assert(d->arena->reserved == reserved);
+  }
+
+  // Long documents go through the index
+  size_t n = 300;
+  char *big = malloc(n * 48 + 16);
+  size_t pos = (size_t)sprintf(big, "[");
+  for (size_t i = 0; i < n; i++) {
+    pos += (size_t)sprintf(&big[pos], "%s{\"id\": %zu, \"v\": [%zu, \"s\"]}",
+                           i > 0 ? ", " : "", i, i * 2);
+  }
+  sprintf(&big[pos], "]");
+  err = json_document_parse(d, big);
+  assert(err == CUTILS_SUCCESS);
+  json_parse(big, &reference);
+  assert(values_equal(d->root, reference));
+  json_value_free(reference);
+  free(big);
+
+  json_document_clear(d);
+  assert(d->root == NULL);
+  assert(d->arena->used == 0);
+
+  err = json_document_parse(d, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  json_document_free(d);
+
+  printf("success\n");
+}
+
+// Walks the tape from `pos` alongside the tree, returning where it ends.
+// The tree stops at an embedded NUL, the tape does not.
+bool same_string(const char *string, size_t length, const char *expected) {
+  return strncmp(string, expected, length) == 0 &&
+         (memchr(string, '\0', length) || expected[length] == '\0');
+}
+
+bool tape_equal(json_tape_t *t, size_t pos, json_value_t *v) {
+  if (json_tape_type(t, pos) != v->type) {
+    return false;
+  }
+
+  bool boolean;
+  double number;
+  const char *string;
+  size_t length;
+  switch (v->type) {
+  case JSON_NULL:
+    return true;
+  case JSON_BOOLEAN:
+    json_tape_get_boolean(t, pos, &boolean);
+    return boolean == v->value.boolean;
+  case JSON_NUMBER:
+    json_tape_get_number(t, pos, &number);
+    return number == v->value.number;
+  case JSON_STRING:
+    json_tape_get_string(t, pos, &string, &length);
+    return same_string(string, length, v->value.string);
+  case JSON_ARRAY: {
+    json_tape_length(t, pos, &length);
+    if (length != v->value.array->length) {
+      return false;
+    }
+    size_t i = 0;
+    for (size_t e = pos + 1; e < json_tape_end(t, pos);
+         e = json_tape_next(t, e)) {
+      if (!tape_equal(t, e, v->value.array->backing[i++])) {
+        return false;
+      }
+    }
+    return i == length;
+  }
+  case JSON_OBJECT: {
+    json_tape_length(t, pos, &length);
+    if (length != v->value.object->length) {
+      return false;
+    }
+    size_t i = 0;
+    for (size_t m = pos + 1; m < json_tape_end(t, pos);
+         m = json_tape_next(t, json_tape_next(t, m))) {
+      json_member_t *member = &v->value.object->members[i++];
+      size_t key_length;
+      json_tape_get_string(t, m, &string, &key_length);
+      if (!same_string(string, key_length, member->key) ||
+          !tape_equal(t, json_tape_next(t, m), member->value)) {
+        return false;
+      }
+    }
+    return i == length;
+  }
+  }
+  return false;
+}
+
+void test_tape(void) {
+  printf("testing json_tape ... ");
+
+  json_tape_t *t = malloc(sizeof(json_tape_t));
+  cutils_error_t err = json_tape_init(t, 0);
+  assert(err == CUTILS_SUCCESS);
+
+  const char *text = "{\"a\": 1.5, \"b\": [true, false, null, [], {}], "
+                     "\"c\": {\"d\": \"x\\u0000y\", \"e\": \"\\u20AC\"}, "
+                     "\"a\": -2}";
+  err = json_tape_parse(t, text);
+  assert(err == CUTILS_SUCCESS);
+
+  // Root object spans the whole tape, containers point at their close
+  assert(json_tape_type(t, 0) == JSON_OBJECT);
+  assert(json_tape_end(t, 0) == t->length - 1);
+  assert(json_tape_next(t, 0) == t->length);
+  assert(JSON_TAPE_TAG(t->words[t->length - 1]) == '}');
+  assert(JSON_TAPE_PAYLOAD(t->words[t->length - 1]) == 0);
+
+  size_t length = 0;
+  json_tape_length(t, 0, &length);
+  assert(length == 4);
+
+  // Repeated keys resolve to the last
+  size_t pos = 0;
+  double number = 0;
+  err = json_tape_find(t, 0, "a", &pos);
+  assert(err == CUTILS_SUCCESS);
+  json_tape_get_number(t, pos, &number);
+  assert(number == -2);
+
+  json_tape_find(t, 0, "b", &pos);
+  json_tape_length(t, pos, &length);
+  assert(length == 5);
+  size_t e = pos + 1;
+  bool boolean = false;
+  json_tape_get_boolean(t, e, &boolean);
+  assert(boolean);
+  e = json_tape_next(t, e);
+  json_tape_get_boolean(t, e, &boolean);
+  assert(!boolean);
+  e = json_tape_next(t, e);
+  assert(json_tape_type(t, e) == JSON_NULL);
+  e = json_tape_next(t, e);
+  json_tape_length(t, e, &length);
+  assert(length == 0 && json_tape_end(t, e) == e + 1);
+  e = json_tape_next(t, json_tape_next(t, e));
+  assert(e == json_tape_end(t, pos));
+
+  // Strings keep their length, NULs included
+  size_t c = 0;
+  json_tape_find(t, 0, "c", &c);
+  const char *string = NULL;
+  json_tape_find(t, c, "d", &pos);
+  json_tape_get_string(t, pos, &string, &length);
+  assert(length == 3 && memcmp(string, "x\0y", 4) == 0);
+  json_tape_find(t, c, "e", &pos);
+  json_tape_get_string(t, pos, &string, NULL);
+  assert(strcmp(string, "€") == 0);
+
+  // Wrong types, missing keys and positions past the end
+  err = json_tape_find(t, 0, "z", &pos);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = json_tape_find(t, c + 1, "d", &pos);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = json_tape_get_number(t, c, &number);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = json_tape_get_string(t, 0, &string, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = json_tape_get_boolean(t, t->length, &boolean);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  json_value_t *reference = NULL;
+  json_parse(text, &reference);
+  assert(tape_equal(t, 0, reference));
+  json_value_free(reference);
+
+  // Scalars at the root, and failures leave an empty tape
+  err = json_tape_parse(t, " 42 ");
+  assert(err == CUTILS_SUCCESS);
+  assert(t->length == 2);
+  json_tape_get_number(t, 0, &number);
+  assert(number == 42);
+  const char *bad[] = {"[1, 2", "{\"a\" 1}", "[1,]", "\"open", "[] x", ""};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    err = json_tape_parse(t, bad[i]);
+    assert(err == CUTILS_JSON_PARSE_ERROR);
+    assert(t->length == 0 && t->strings->length == 0);
+  }
+
+  // Long documents go through the index, and the tape is reused
+  size_t n = 2000;
+  char *big = malloc(n * 64 + 16);
+  pos = (size_t)sprintf(big, "[");
+  for (size_t i = 0; i < n; i++) {
+    pos += (size_t)sprintf(&big[pos],
+                           "%s{\"id\": %zu, \"v\": [%zu.25, \"s\\n\"], "
+                           "\"ok\": %s}",
+                           i > 0 ? ", " : "", i, i, i % 2 ? "true" : "false");
+  }
+  sprintf(&big[pos], "]");
+  for (size_t round = 0; round < 2; round++) {
+    err = json_tape_parse(t, big);
+    assert(err == CUTILS_SUCCESS);
+  }
+  json_parse(big, &reference);
+  assert(tape_equal(t, 0, reference));
+  json_value_free(reference);
+  free(big);
+
+  // Counts too large for the open word are found by walking
+  n = JSON_TAPE_COUNT_MAX + 10;
+  big = malloc(n * 2 + 2);
+  big[0] = '[';
+  for (size_t i = 0; i < n; i++) {
+    big[2 * i + 1] = '0';
+    big[2 * i + 2] = ',';
+  }
+  big[2 * n] = ']';
+  big[2 * n + 1] = '\0';
+  err = json_tape_parse(t, big);
+  assert(err == CUTILS_SUCCESS);
+  json_tape_length(t, 0, &length);
+  assert(length == n);
+  free(big);
+
+  err = json_tape_parse(t, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+  err = json_tape_init(NULL, 0);
+  assert(err == CUTILS_NULL_ERROR);
+
+  json_tape_free(t);
+
+  printf("success\n");
+}
+
+json_action_t count_events(void *ctx, json_event_t *e) {
+  (void)e;
+  (*(size_t *)ctx)++;
+  return JSON_CONTINUE;
+}
+
+// Feeds `text` in pieces of `step` bytes, or byte by byte when 0.
+cutils_error_t feed(json_parser_t *p, const char *text, size_t step) {
+  size_t length = strlen(text);
+  step = step > 0 ? step : 1;
+  for (size_t i = 0; i < length; i += step) {
+    size_t n = length - i < step ? length - i : step;
+    cutils_error_t err = json_parser_feed(p, &text[i], n);
+    if (err != CUTILS_SUCCESS) {
+      return err;
+    }
+  }
+  return json_parser_finish(p);
+}
+
+void test_parser(void) {
+  printf("testing json_parser ... ");
+
+  json_parser_t *p = malloc(sizeof(json_parser_t));
+  cutils_error_t err = json_parser_init(p, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  const char *texts[] = {
+      "{\"a\": [1, true, null, \"x\\ty\"], \"b\": {\"c\": -2.5e-3, "
+      "\"e\": [{}]}, \"d\": [], \"\\u20AC\\\"\": \"\\\\\", \"a\": false}",
+      " [ [ [ ] ] , 12 , \"\" , { } ] ",
+      "-0.5",
+      "\"split \\\\\\\" escapes\"",
+      "null",
+  };
+  size_t steps[] = {0, 2, 3, 7, 64};
+  for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+    json_value_t *reference = NULL;
+    json_parse(texts[i], &reference);
+    for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+      err = feed(p, texts[i], steps[s]);
+      assert(err == CUTILS_SUCCESS);
+      json_value_t *val = NULL;
+      err = json_parser_take(p, &val);
+      assert(err == CUTILS_SUCCESS);
+      assert(values_equal(val, reference));
+      json_value_free(val);
+
+      // The same events as json_parse_events, skips included
+      const char *skips[] = {NULL, "a", "b", "[", "{"};
+      for (size_t k = 0; k < sizeof(skips) / sizeof(skips[0]); k++) {
+        recorder_t expected = {.skip = skips[k]};
+        recorder_t actual = {.skip = skips[k]};
+        json_parse_events(texts[i], record, &expected);
+        json_parser_t *events = malloc(sizeof(json_parser_t));
+        json_parser_init(events, record, &actual);
+        err = feed(events, texts[i], steps[s]);
+        assert(err == CUTILS_SUCCESS);
+        assert(strcmp(actual.log, expected.log) == 0);
+        json_parser_free(events);
+      }
+    }
+    json_value_free(reference);
+  }
+
+  // A value is ready once its last byte is in, except a number at the root
+  json_value_t *val = NULL;
+  json_parser_feed(p, "[1, ", 4);
+  err = json_parser_take(p, &val);
+  assert(err == CUTILS_INDEX_ERROR);
+  json_parser_feed(p, "2]", 2);
+  err = json_parser_take(p, &val);
+  assert(err == CUTILS_SUCCESS);
+  assert(val->value.array->length == 2);
+  json_value_free(val);
+  json_parser_feed(p, "42", 2);
+  err = json_parser_take(p, &val);
+  assert(err == CUTILS_INDEX_ERROR);
+  json_parser_feed(p, "\n", 1);
+  err = json_parser_take(p, &val);
+  assert(err == CUTILS_SUCCESS);
+  assert(val->value.number == 42);
+  json_value_free(val);
+  json_parser_feed(p, "tr", 2);
+  json_parser_feed(p, "ue", 2);
+  err = json_parser_take(p, &val);
+  assert(err == CUTILS_SUCCESS);
+  assert(val->type == JSON_BOOLEAN && val->value.boolean);
+  json_value_free(val);
+
+  // Errors stick until a reset, and partial trees are freed
+  const char *bad[] = {"[1, 2",   "{\"a\" 1}", "[1,]",   "\"open", "[] x",
+                       "",        "{1: 2}",    "[nan]",  "[1 2]",  "[}",
+                       "{\"a\"}", "tru",       "[truex]", "[-]",   "[1.2.3]",
+                       "truex",   "[nulll]",   "fals e"};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    for (size_t step = 0; step < 3; step++) {
+      err = feed(p, bad[i], step);
+      assert(err == CUTILS_JSON_PARSE_ERROR);
+      err = json_parser_feed(p, "1", 1);
+      assert(err == CUTILS_JSON_PARSE_ERROR);
+      json_parser_reset(p);
+    }
+  }
+
+  // Stopping ignores the rest
+  recorder_t r = {.stop = 2};
+  json_parser_t *events = malloc(sizeof(json_parser_t));
+  json_parser_init(events, record, &r);
+  err = feed(events, "[1, 2, oops", 3);
+  assert(err == CUTILS_SUCCESS);
+  assert(strcmp(r.log, "[ 1 ") == 0);
+  err = json_parser_take(events, &val);
+  assert(err == CUTILS_INDEX_ERROR);
+  json_parser_free(events);
+
+  // Deep nesting needs no recursion to parse, though it would to free
+  size_t depth = 100000;
+  char *deep = malloc(2 * depth + 1);
+  memset(deep, '[', depth);
+  memset(&deep[depth], ']', depth);
+  deep[2 * depth] = '\0';
+  size_t count = 0;
+  events = malloc(sizeof(json_parser_t));
+  json_parser_init(events, count_events, &count);
+  err = feed(events, deep, 4096);
+  assert(err == CUTILS_SUCCESS);
+  assert(count == 2 * depth);
+  json_parser_free(events);
+  free(deep);
+
+  err = json_parser_feed(p, NULL, 1);
+  assert(err == CUTILS_NULL_ERROR);
+  err = json_parser_take(p, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+  err = json_parser_init(NULL, NULL, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  json_parser_free(p);
+
+  printf("success\n");
+}
+
+// Writes `length` bytes to a new temporary file, returning its path.
+char *temp_file(const char *data, size_t length) {
+  char *path = malloc(32);
+  assert(path != NULL);
+  strcpy(path, "/tmp/cutils_jsonXXXXXX");
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  size_t written = 0;
+  while (written < length) {
+    ssize_t n = write(fd, &data[written], length - written);
+    assert(n > 0);
+    written += (size_t)n;
+  }
+  close(fd);
+  return path;
+}
+
+void test_parse_file(void) {
+  printf("testing json_parse_file ... ");
+
+  const char *text = "{\"plain\": \"abc\", \"escaped\": \"a\\nb\", "
+                     "\"list\": [1, \"\", {\"k\\u00e9y\": null}]}";
+  char *path = temp_file(text, strlen(text));
+  json_value_t *reference = NULL;
+  json_parse(text, &reference);
+
+  json_tape_t *t = malloc(sizeof(json_tape_t));
+  json_tape_init(t, 0);
+  int modes[] = {0, JSON_FILE_VIEWS, JSON_FILE_VIEWS | JSON_FILE_BOUNDED};
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+    json_file_t *f = malloc(sizeof(json_file_t));
+    cutils_error_t err = json_parse_file(t, f, path, modes[m]);
+    assert(err == CUTILS_SUCCESS);
+    assert(f->length == strlen(text));
+    assert(tape_equal(t, 0, reference));
+
+    // Only strings with nothing to decode are left in the mapping
+    size_t pos = 0;
+    size_t length = 0;
+    const char *string = NULL;
+    json_tape_find(t, 0, "plain", &pos);
+    json_tape_get_string(t, pos, &string, &length);
+    bool mapped = string >= f->data && string < f->data + f->length;
+    assert(mapped == ((modes[m] & JSON_FILE_VIEWS) != 0));
+    assert(length == 3 && memcmp(string, "abc", 3) == 0);
+    err = json_tape_get_string(t, pos, &string, NULL);
+    assert(err == (mapped ? CUTILS_NULL_ERROR : CUTILS_SUCCESS));
+    json_tape_find(t, 0, "escaped", &pos);
+    json_tape_get_string(t, pos, &string, NULL);
+    assert(strcmp(string, "a\nb") == 0);
+
+    json_file_free(f);
+  }
+
+  // Mixed escapes can decode to as many bytes as they take up, and must still
+  // be decoded and checked rather than left in the mapping
+  const char *mixed[] = {"[\"\\n\\n\\u0041\"]", "[\"\\q\\q\\u00zz\"]"};
+  for (size_t m = 0; m < 2; m++) {
+    char *escapes = temp_file(mixed[m], strlen(mixed[m]));
+    json_file_t *f = malloc(sizeof(json_file_t));
+    cutils_error_t err = json_parse_file(t, f, escapes, JSON_FILE_VIEWS);
+    if (m == 0) {
+      size_t length = 0;
+      const char *string = NULL;
+      assert(err == CUTILS_SUCCESS);
+      json_tape_get_string(t, 1, &string, &length);
+      assert(length == 3 && memcmp(string, "\n\nA", 3) == 0);
+    } else {
+      assert(err == CUTILS_JSON_PARSE_ERROR);
+    }
+    json_file_free(f);
+    unlink(escapes);
+    free(escapes);
+  }
+
+  // Events straight from the file
+  recorder_t expected = {0};
+  recorder_t actual = {0};
+  json_parse_events(text, record, &expected);
+  cutils_error_t err = json_parse_file_events(path, record, &actual);
+  assert(err == CUTILS_SUCCESS);
+  assert(strcmp(actual.log, expected.log) == 0);
+  unlink(path);
+  free(path);
+  json_value_free(reference);
+
+  // Past the window, bounded mode hands pages back and views still read
+  size_t n = JSON_FILE_WINDOW / 16;
+  char *big = malloc(n * 40 + 16);
+  size_t pos = (size_t)sprintf(big, "[");
+  for (size_t i = 0; i < n; i++) {
+    pos += (size_t)sprintf(&big[pos], "%s{\"id\": %zu, \"s\": \"v%zu\"}",
+                           i > 0 ? "," : "", i, i % 10);
+  }
+  pos += (size_t)sprintf(&big[pos], "]");
+  path = temp_file(big, pos);
+  json_file_t *f = malloc(sizeof(json_file_t));
+  err = json_parse_file(t, f, path, JSON_FILE_VIEWS | JSON_FILE_BOUNDED);
+  assert(err == CUTILS_SUCCESS);
+  assert(f->released >= JSON_FILE_WINDOW);
+  json_parse(big, &reference);
+  assert(tape_equal(t, 0, reference));
+  json_value_free(reference);
+  json_file_free(f);
+
+  size_t count = 0;
+  err = json_parse_file_events(path, count_events, &count);
+  assert(err == CUTILS_SUCCESS);
+  assert(count == 2 + n * 6);
+  unlink(path);
+  free(path);
+  free(big);
+
+  // Missing and empty files
+  f = malloc(sizeof(json_file_t));
+  err = json_parse_file(t, f, "/nonexistent/cutils.json", 0);
+  assert(err == CUTILS_IO_ERROR);
+  assert(strcmp(cutils_error_message(err), "Unknown error") != 0);
+  path = temp_file("", 0);
+  err = json_parse_file(t, f, path, 0);
+  assert(err == CUTILS_JSON_PARSE_ERROR);
+  json_file_free(f);
+  err = json_parse_file_events(path, count_events, &count);
+  assert(err == CUTILS_JSON_PARSE_ERROR);
+  unlink(path);
+  free(path);
+
+  err = json_parse_file(t, NULL, "x", 0);
+  assert(err == CUTILS_NULL_ERROR);
+  err = json_file_open(NULL, "x");
+  assert(err == CUTILS_NULL_ERROR);
+
+  json_tape_free(t);
+
+  printf("success\n");
+}
+
+typedef struct {
+  size_t count;
+  size_t errors;
+  size_t stop;
+  size_t numbers[8];
+  size_t offsets[8];
+  cutils_error_t errs[8];
+  bool ordered; // Each line is the one after the last, holding its number
+} line_log_t;
+
+json_action_t log_line(void *ctx, json_line_t *line) {
+  line_log_t *log = ctx;
+  if (log->count < 8) {
+    log->numbers[log->count] = line->number;
+    log->offsets[log->count] = line->offset;
+    log->errs[log->count] = line->err;
+  }
+  if (line->err != CUTILS_SUCCESS) {
+    log->errors++;
+  } else if (line->value->type == JSON_NUMBER &&
+             line->value->value.number != (double)line->number) {
+    log->ordered = false;
+  }
+  json_value_free(line->value);
+  log->count++;
+  return log->count == log->stop ? JSON_STOP : JSON_CONTINUE;
+}
+
+void test_parse_lines(void) {
+  printf("testing json_parse_lines ... ");
+
+  // Blank lines count towards numbering but are not delivered
+  const char *text = "{\"id\": 1}\n\n  \r\n[2]\r\n{bad\n3";
+  line_log_t log = {0};
+  cutils_error_t err =
+      json_parse_lines(text, strlen(text), log_line, &log, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(log.count == 4);
+  size_t numbers[] = {1, 4, 5, 6};
+  size_t offsets[] = {0, 15, 20, 25};
+  for (size_t i = 0; i < 4; i++) {
+    assert(log.numbers[i] == numbers[i]);
+    assert(log.offsets[i] == offsets[i]);
+  }
+  assert(log.errs[2] == CUTILS_JSON_PARSE_ERROR);
+  assert(log.errors == 1);
+
+  // Enough for a 4 thread pool, taking 8 chunks a batch, to overlap parsing
+  // one batch with delivering another several times over
+  size_t target = 3 * 8 * JSON_LINES_CHUNK;
+  char *big = malloc(target + 32);
+  size_t length = 0;
+  size_t n = 0;
+  while (length < target) {
+    size_t i = ++n;
+    if (i % 1000 == 0) {
+      length += (size_t)sprintf(&big[length], "[%zu\n", i);
+    } else {
+      length += (size_t)sprintf(&big[length], "%zu\n", i);
+    }
+  }
+
+  thread_pool_t *single = malloc(sizeof(thread_pool_t));
+  err = thread_pool_init(single, 1);
+  assert(err == CUTILS_SUCCESS);
+  thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+  err = thread_pool_init(pool, 4);
+  assert(err == CUTILS_SUCCESS);
+  thread_pool_t *pools[] = {NULL, single, pool};
+  for (size_t k = 0; k < 3; k++) {
+    log = (line_log_t){.ordered = true};
+    err = json_parse_lines(big, length, log_line, &log, pools[k]);
+    assert(err == CUTILS_SUCCESS);
+    assert(log.count == n);
+    assert(log.errors == n / 1000);
+    assert(log.ordered);
+  }
+
+  // Stopping part way frees what was parsed but not delivered
+  log = (line_log_t){.ordered = true, .stop = 10};
+  err = json_parse_lines(big, length, log_line, &log, pool);
+  assert(err == CUTILS_SUCCESS);
+  assert(log.count == 10);
+
+  char *path = temp_file(big, length);
+  log = (line_log_t){.ordered = true};
+  err = json_parse_lines_file(path, log_line, &log, pool);
+  assert(err == CUTILS_SUCCESS);
+  assert(log.count == n && log.ordered);
+  unlink(path);
+  free(path);
+  free(big);
+
+  path = temp_file("", 0);
+  log = (line_log_t){0};
+  err = json_parse_lines_file(path, log_line, &log, pool);
+  assert(err == CUTILS_SUCCESS && log.count == 0);
+  unlink(path);
+  free(path);
+
+  err = json_parse_lines_file("/nonexistent/cutils.ndjson", log_line, &log,
+                              pool);
+  assert(err == CUTILS_IO_ERROR);
+  err = json_parse_lines(NULL, 0, log_line, &log, pool);
+  assert(err == CUTILS_NULL_ERROR);
+  err = json_parse_lines(text, 0, NULL, &log, pool);
+  assert(err == CUTILS_NULL_ERROR);
+
+  thread_pool_free(single);
+  thread_pool_free(pool);
+
+  printf("success\n");
+}
+
 int main(void) {
   test_parse_literals();
   test_parse_numbers();
   test_parse_strings();
   test_parse_array();
   test_parse_object();
+  test_object();
   test_parse_errors();
+  test_stringify_compact_and_pretty();
+  test_stringify_numbers();
+  test_stringify_strings();
+  test_stringify_sink();
+  test_parse_events();
+  test_index();
+  test_parse_indexed();
+  test_arena();
+  test_document();
+  test_parse_n();
+  test_tape();
+  test_parser();
+  test_parse_file();
+  test_parse_lines();
   return EXIT_SUCCESS;
 }
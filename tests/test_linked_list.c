@@ -452,6 +452,383 @@ void test_linked_list_find(void) {
   printf("success\n");
 }
 
+void test_linked_list_pooled(void) {
+  printf("testing linked_list_pooled ... ");
+
+  linked_list_t *l = malloc(sizeof(linked_list_t));
+  cutils_error_t err = linked_list_init_pooled(l, NULL, inner_free, outer_free);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->pool != NULL);
+  assert(l->owns_pool);
+
+  for (size_t i = 0; i < 3 * LINKED_LIST_POOL_SLAB_NODES; i++) {
+    err = linked_list_push_back(l, _new(i % 8));
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(l->length == 3 * LINKED_LIST_POOL_SLAB_NODES);
+
+  // Released nodes are handed out again before a new slab is carved
+  linked_list_node_t *head = l->head;
+  test_data_t *item = NULL;
+  err = linked_list_pop_front(l, (void **)&item);
+  assert(err == CUTILS_SUCCESS);
+  assert(verify_value(item, 0));
+  err = linked_list_push_back(l, item);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->tail == head);
+
+  for (size_t i = 1; i < 3 * LINKED_LIST_POOL_SLAB_NODES; i++) {
+    err = linked_list_get(l, i - 1, (void **)&item);
+    assert(err == CUTILS_SUCCESS);
+    assert(verify_value(item, i % 8));
+  }
+
+  linked_list_free(l);
+
+  printf("success\n");
+}
+
+void test_linked_list_shared_pool(void) {
+  printf("testing linked_list_shared_pool ... ");
+
+  linked_list_pool_t *pool = malloc(sizeof(linked_list_pool_t));
+  cutils_error_t err = linked_list_pool_init(pool, 4);
+  assert(err == CUTILS_SUCCESS);
+
+  linked_list_t *a = malloc(sizeof(linked_list_t));
+  err = linked_list_init_pooled(a, pool, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(!a->owns_pool);
+
+  linked_list_t *b = malloc(sizeof(linked_list_t));
+  err = linked_list_init_pooled(b, pool, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  for (uintptr_t i = 0; i < 10; i++) {
+    linked_list_push_back(a, (void *)i);
+    linked_list_push_front(b, (void *)i);
+  }
+
+  void *value = NULL;
+  for (uintptr_t i = 0; i < 10; i++) {
+    linked_list_get(a, i, &value);
+    assert(value == (void *)i);
+    linked_list_get(b, i, &value);
+    assert(value == (void *)(9 - i));
+  }
+
+  // Nodes freed with one list are reused by the other
+  linked_list_free(a);
+  assert(pool->free_nodes != NULL);
+  for (uintptr_t i = 0; i < 10; i++) {
+    linked_list_push_back(b, (void *)i);
+  }
+  assert(b->length == 20);
+  assert(pool->free_nodes == NULL);
+
+  linked_list_free(b);
+  linked_list_pool_free(pool);
+
+  printf("success\n");
+}
+
+bool verify_ints(linked_list_t *l, size_t n, const uintptr_t values[n]) {
+  if (l->length != n) {
+    return false;
+  }
+
+  linked_list_node_t *curr = l->head;
+  for (size_t i = 0; i < n; i++) {
+    if (!curr || curr->value != (void *)values[i]) {
+      return false;
+    }
+    if (curr->next ? curr->next->prev != curr : l->tail != curr) {
+      return false;
+    }
+    curr = curr->next;
+  }
+  return curr == NULL;
+}
+
+void test_linked_list_node_ops(void) {
+  printf("testing linked_list_node_ops ... ");
+
+  linked_list_t *l = malloc(sizeof(linked_list_t));
+  cutils_error_t err = linked_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  err = linked_list_insert_before(l, NULL, (void *)(uintptr_t)3);
+  assert(err == CUTILS_SUCCESS);
+  err = linked_list_insert_after(l, NULL, (void *)(uintptr_t)1);
+  assert(err == CUTILS_SUCCESS);
+  err = linked_list_insert_after(l, l->head, (void *)(uintptr_t)2);
+  assert(err == CUTILS_SUCCESS);
+  err = linked_list_insert_before(l, l->head, (void *)(uintptr_t)0);
+  assert(err == CUTILS_SUCCESS);
+  assert(verify_ints(l, 4, (uintptr_t[]){0, 1, 2, 3}));
+
+  void *value = NULL;
+  err = linked_list_remove_node(l, l->head->next, &value);
+  assert(err == CUTILS_SUCCESS);
+  assert(value == (void *)(uintptr_t)1);
+  assert(verify_ints(l, 3, (uintptr_t[]){0, 2, 3}));
+
+  err = linked_list_remove_node(l, l->tail, &value);
+  assert(err == CUTILS_SUCCESS);
+  assert(value == (void *)(uintptr_t)3);
+  err = linked_list_remove_node(l, l->head, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(verify_ints(l, 1, (uintptr_t[]){2}));
+
+  err = linked_list_remove_node(l, NULL, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  // Indexed access from the back half walks from the tail
+  for (uintptr_t i = 3; i < 10; i++) {
+    linked_list_push_back(l, (void *)i);
+  }
+  err = linked_list_get(l, 6, &value);
+  assert(err == CUTILS_SUCCESS);
+  assert(value == (void *)(uintptr_t)8);
+  err = linked_list_insert_at(l, 7, (void *)(uintptr_t)42);
+  assert(err == CUTILS_SUCCESS);
+  assert(verify_ints(l, 9, (uintptr_t[]){2, 3, 4, 5, 6, 7, 8, 42, 9}));
+
+  linked_list_free(l);
+
+  printf("success\n");
+}
+
+void test_linked_list_cursor(void) {
+  printf("testing linked_list_cursor ... ");
+
+  linked_list_t *l = malloc(sizeof(linked_list_t));
+  cutils_error_t err = linked_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  linked_list_cursor_t c;
+  err = linked_list_cursor_init(&c, l);
+  assert(err == CUTILS_SUCCESS);
+  assert(!linked_list_cursor_valid(&c));
+  err = linked_list_cursor_prev(&c);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  // Inserting at the end cursor appends
+  for (uintptr_t i = 0; i < 6; i++) {
+    err = linked_list_cursor_insert(&c, (void *)i);
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(c.idx == 6);
+  assert(verify_ints(l, 6, (uintptr_t[]){0, 1, 2, 3, 4, 5}));
+
+  // Drop the odd values while walking forward
+  linked_list_cursor_init(&c, l);
+  while (linked_list_cursor_valid(&c)) {
+    void *value = NULL;
+    linked_list_cursor_get(&c, &value);
+    if ((uintptr_t)value % 2) {
+      err = linked_list_cursor_remove(&c, NULL);
+      assert(err == CUTILS_SUCCESS);
+    } else {
+      linked_list_cursor_next(&c);
+    }
+  }
+  assert(c.idx == 3);
+  assert(verify_ints(l, 3, (uintptr_t[]){0, 2, 4}));
+
+  err = linked_list_cursor_next(&c);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  // Walk back and insert in front of each element
+  while (linked_list_cursor_prev(&c) == CUTILS_SUCCESS) {
+    void *value = NULL;
+    linked_list_cursor_get(&c, &value);
+    size_t idx = c.idx;
+    err = linked_list_cursor_insert(&c, (void *)((uintptr_t)value + 100));
+    assert(err == CUTILS_SUCCESS);
+    assert(c.idx == idx + 1);
+    linked_list_cursor_prev(&c);
+  }
+  assert(c.idx == 0);
+  assert(verify_ints(l, 6, (uintptr_t[]){100, 0, 102, 2, 104, 4}));
+
+  err = linked_list_cursor_set(&c, (void *)(uintptr_t)7);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->head->value == (void *)(uintptr_t)7);
+
+  linked_list_free(l);
+
+  printf("success\n");
+}
+
+// Orders by the key in the upper bits, ignoring the sequence number below.
+int cmp_high(void *lhs, void *rhs) {
+  uintptr_t l = (uintptr_t)lhs >> 16;
+  uintptr_t r = (uintptr_t)rhs >> 16;
+  return (l > r) - (l < r);
+}
+
+void test_linked_list_sort(void) {
+  printf("testing linked_list_sort ... ");
+
+  linked_list_t *l = malloc(sizeof(linked_list_t));
+  cutils_error_t err = linked_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  err = linked_list_sort(l, cmp_high);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->head == NULL && l->tail == NULL);
+
+  // Few distinct keys so that stability is exercised
+  size_t n = 10007;
+  for (uintptr_t i = 0; i < n; i++) {
+    uintptr_t key = (i * 7919) % 97;
+    linked_list_push_back(l, (void *)((key << 16) | i));
+  }
+  linked_list_node_t *first = l->head;
+
+  err = linked_list_sort(l, cmp_high);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->length == n);
+  assert(l->head->prev == NULL);
+
+  size_t count = 0;
+  for (linked_list_node_t *curr = l->head; curr; curr = curr->next) {
+    if (curr->next) {
+      assert(curr->next->prev == curr);
+      uintptr_t a = (uintptr_t)curr->value;
+      uintptr_t b = (uintptr_t)curr->next->value;
+      assert((a >> 16) < (b >> 16) ||
+             ((a >> 16) == (b >> 16) && (a & 0xffff) < (b & 0xffff)));
+    } else {
+      assert(l->tail == curr);
+    }
+    // The original nodes were relinked, not reallocated
+    count += curr == first;
+  }
+  assert(count == 1);
+
+  err = linked_list_sort(NULL, cmp_high);
+  assert(err == CUTILS_NULL_ERROR);
+
+  linked_list_free(l);
+
+  printf("success\n");
+}
+
+void test_linked_list_splice(void) {
+  printf("testing linked_list_splice ... ");
+
+  linked_list_t *a = malloc(sizeof(linked_list_t));
+  linked_list_t *b = malloc(sizeof(linked_list_t));
+  linked_list_init(a, NULL, NULL);
+  linked_list_init(b, NULL, NULL);
+  for (uintptr_t i = 0; i < 3; i++) {
+    linked_list_push_back(a, (void *)i);
+    linked_list_push_back(b, (void *)(i + 10));
+  }
+
+  // Into the middle
+  cutils_error_t err = linked_list_splice(a, a->head->next, b);
+  assert(err == CUTILS_SUCCESS);
+  assert(verify_ints(a, 6, (uintptr_t[]){0, 10, 11, 12, 1, 2}));
+  assert(verify_ints(b, 0, NULL));
+
+  // At the front, then concatenated onto the end
+  linked_list_push_back(b, (void *)(uintptr_t)20);
+  err = linked_list_splice(a, a->head, b);
+  assert(err == CUTILS_SUCCESS);
+  linked_list_push_back(b, (void *)(uintptr_t)30);
+  linked_list_push_back(b, (void *)(uintptr_t)31);
+  err = linked_list_concat(a, b);
+  assert(err == CUTILS_SUCCESS);
+  assert(verify_ints(a, 9, (uintptr_t[]){20, 0, 10, 11, 12, 1, 2, 30, 31}));
+  assert(a->head->prev == NULL);
+
+  // Into an empty list, and from an empty list
+  err = linked_list_concat(b, a);
+  assert(err == CUTILS_SUCCESS);
+  assert(b->length == 9 && a->length == 0);
+  err = linked_list_concat(b, a);
+  assert(err == CUTILS_SUCCESS);
+  assert(b->length == 9);
+
+  err = linked_list_concat(b, b);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  // Nodes cannot leave a private pool
+  linked_list_t *pooled = malloc(sizeof(linked_list_t));
+  linked_list_init_pooled(pooled, NULL, NULL, NULL);
+  linked_list_push_back(pooled, (void *)(uintptr_t)1);
+  err = linked_list_concat(b, pooled);
+  assert(err == CUTILS_POOL_ERROR);
+  assert(pooled->length == 1);
+
+  linked_list_free(pooled);
+  linked_list_free(a);
+  linked_list_free(b);
+
+  printf("success\n");
+}
+
+void test_linked_list_merge(void) {
+  printf("testing linked_list_merge ... ");
+
+  linked_list_pool_t *pool = malloc(sizeof(linked_list_pool_t));
+  linked_list_pool_init(pool, 0);
+
+  // Key i % 5 goes to list i % 4, so every key is spread over lists
+  size_t k = 4;
+  size_t n = 400;
+  linked_list_t *srcs[4];
+  for (size_t i = 0; i < k; i++) {
+    srcs[i] = malloc(sizeof(linked_list_t));
+    linked_list_init_pooled(srcs[i], pool, NULL, NULL);
+  }
+  for (uintptr_t i = 0; i < n; i++) {
+    linked_list_push_back(srcs[i % k], (void *)(((i % 5) << 16) | i));
+  }
+  for (size_t i = 0; i < k; i++) {
+    linked_list_sort(srcs[i], cmp_high);
+  }
+
+  linked_list_t *dst = malloc(sizeof(linked_list_t));
+  linked_list_init_pooled(dst, pool, NULL, NULL);
+  linked_list_push_back(dst, (void *)(uintptr_t)0);
+  cutils_error_t err = linked_list_merge(dst, srcs, k, cmp_high);
+  assert(err == CUTILS_SUCCESS);
+  assert(dst->length == n + 1);
+
+  // Equal keys come out grouped by source list, i.e. by i % 4
+  linked_list_node_t *curr = dst->head->next;
+  for (; curr->next; curr = curr->next) {
+    assert(curr->next->prev == curr);
+    uintptr_t a = (uintptr_t)curr->value;
+    uintptr_t b = (uintptr_t)curr->next->value;
+    assert((a >> 16) < (b >> 16) ||
+           ((a >> 16) == (b >> 16) && (a & 0xffff) % k <= (b & 0xffff) % k));
+  }
+  assert(dst->tail == curr);
+
+  for (size_t i = 0; i < k; i++) {
+    assert(verify_ints(srcs[i], 0, NULL));
+    assert(srcs[i]->head == NULL);
+  }
+
+  err = linked_list_merge(dst, NULL, 0, cmp_high);
+  assert(err == CUTILS_SUCCESS);
+  err = linked_list_merge(dst, &dst, 1, cmp_high);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  linked_list_free(dst);
+  for (size_t i = 0; i < k; i++) {
+    linked_list_free(srcs[i]);
+  }
+  linked_list_pool_free(pool);
+
+  printf("success\n");
+}
+
 int main(void) {
   test_linked_list_init_and_free();
   test_linked_list_insert_at();
@@ -463,5 +840,12 @@ int main(void) {
   test_linked_list_get();
   test_linked_list_set();
   test_linked_list_find();
+  test_linked_list_pooled();
+  test_linked_list_shared_pool();
+  test_linked_list_node_ops();
+  test_linked_list_cursor();
+  test_linked_list_sort();
+  test_linked_list_splice();
+  test_linked_list_merge();
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,237 @@
+#include "cutils/array_list.h"
+#include "cutils/errors.h"
+#include "cutils/priority_queue.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int cmp_int(void *lhs, void *rhs) {
+  intptr_t l = (intptr_t)lhs;
+  intptr_t r = (intptr_t)rhs;
+  return (l > r) - (l < r);
+}
+
+typedef struct {
+  int priority;
+  size_t idx;
+} task_t;
+
+int cmp_task(void *lhs, void *rhs) {
+  task_t *l = lhs;
+  task_t *r = rhs;
+  return (l->priority > r->priority) - (l->priority < r->priority);
+}
+
+void set_task_index(void *value, size_t idx) { ((task_t *)value)->idx = idx; }
+
+// Pops everything, checking the values come out in non-decreasing order.
+void drain_sorted(priority_queue_t *q, size_t n) {
+  intptr_t prev = INTPTR_MIN;
+  for (size_t i = 0; i < n; i++) {
+    void *value = NULL;
+    cutils_error_t err = priority_queue_pop(q, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert((intptr_t)value >= prev);
+    prev = (intptr_t)value;
+  }
+  assert(q->items->length == 0);
+}
+
+void test_priority_queue_init_and_free(void) {
+  printf("testing priority_queue_init_and_free ... ");
+
+  priority_queue_t *q = malloc(sizeof(priority_queue_t));
+  cutils_error_t err =
+      priority_queue_init(q, 0, cmp_task, set_task_index, free, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(q->arity == PRIORITY_QUEUE_DEFAULT_ARITY);
+
+  for (int i = 0; i < 100; i++) {
+    task_t *t = malloc(sizeof(task_t));
+    t->priority = 100 - i;
+    err = priority_queue_push(q, t);
+    assert(err == CUTILS_SUCCESS);
+  }
+  // Popping without an out-parameter frees the value
+  err = priority_queue_pop(q, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(q->items->length == 99);
+
+  priority_queue_free(q);
+
+  err = priority_queue_init(NULL, 0, cmp_int, NULL, NULL, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_priority_queue_push_pop(void) {
+  printf("testing priority_queue_push_pop ... ");
+
+  size_t arities[] = {2, 3, 4, 8};
+  for (size_t a = 0; a < sizeof(arities) / sizeof(arities[0]); a++) {
+    priority_queue_t *q = malloc(sizeof(priority_queue_t));
+    cutils_error_t err =
+        priority_queue_init(q, arities[a], cmp_int, NULL, NULL, NULL);
+    assert(err == CUTILS_SUCCESS);
+
+    void *value = NULL;
+    err = priority_queue_pop(q, &value);
+    assert(err == CUTILS_INDEX_ERROR);
+    err = priority_queue_peek(q, &value);
+    assert(err == CUTILS_INDEX_ERROR);
+
+    // Duplicates included
+    size_t n = 5003;
+    for (size_t i = 0; i < n; i++) {
+      err = priority_queue_push(q, (void *)(intptr_t)((i * 7919) % 1000));
+      assert(err == CUTILS_SUCCESS);
+    }
+    err = priority_queue_peek(q, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)0);
+
+    drain_sorted(q, n);
+    priority_queue_free(q);
+  }
+
+  printf("success\n");
+}
+
+void test_priority_queue_init_from(void) {
+  printf("testing priority_queue_init_from ... ");
+
+  array_list_t *l = malloc(sizeof(array_list_t));
+  cutils_error_t err = array_list_init(l, 16, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+  size_t n = 10007;
+  for (size_t i = 0; i < n; i++) {
+    array_list_push(l, (void *)((intptr_t)((i * 7919) % n) - 500));
+  }
+
+  priority_queue_t *q = malloc(sizeof(priority_queue_t));
+  err = priority_queue_init_from(q, l, 4, cmp_int, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(q->items == l);
+
+  // Heap property: no child is smaller than its parent
+  for (size_t i = 1; i < n; i++) {
+    assert(cmp_int(l->backing[(i - 1) / 4], l->backing[i]) <= 0);
+  }
+  drain_sorted(q, n);
+
+  err = priority_queue_init_from(q, NULL, 4, cmp_int, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  priority_queue_free(q);
+
+  printf("success\n");
+}
+
+void test_priority_queue_handles(void) {
+  printf("testing priority_queue_handles ... ");
+
+  priority_queue_t *q = malloc(sizeof(priority_queue_t));
+  cutils_error_t err =
+      priority_queue_init(q, 4, cmp_task, set_task_index, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  size_t n = 1000;
+  task_t *tasks = malloc(sizeof(task_t) * n);
+  assert(tasks != NULL);
+  for (size_t i = 0; i < n; i++) {
+    tasks[i].priority = (int)(1000 + (i * 7919) % n);
+    priority_queue_push(q, &tasks[i]);
+  }
+  for (size_t i = 0; i < n; i++) {
+    assert(q->items->backing[tasks[i].idx] == &tasks[i]);
+  }
+
+  // Decrease-key moves a task to the front
+  tasks[501].priority = 0;
+  err = priority_queue_update(q, tasks[501].idx);
+  assert(err == CUTILS_SUCCESS);
+  void *value = NULL;
+  priority_queue_peek(q, &value);
+  assert(value == &tasks[501]);
+
+  // Increase-key sinks it again
+  tasks[501].priority = 5000;
+  err = priority_queue_update(q, tasks[501].idx);
+  assert(err == CUTILS_SUCCESS);
+  priority_queue_peek(q, &value);
+  assert(value != &tasks[501]);
+
+  // Remove a handful by handle
+  for (size_t i = 0; i < n; i += 10) {
+    err = priority_queue_remove(q, tasks[i].idx, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == &tasks[i]);
+  }
+  assert(q->items->length == n - n / 10);
+
+  int prev = -1;
+  while (priority_queue_pop(q, &value) == CUTILS_SUCCESS) {
+    task_t *t = value;
+    assert(t->priority >= prev);
+    prev = t->priority;
+  }
+  assert(prev == 5000);
+
+  err = priority_queue_update(q, 0);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = priority_queue_remove(q, 0, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  free(tasks);
+  priority_queue_free(q);
+
+  printf("success\n");
+}
+
+void test_priority_queue_u64(void) {
+  printf("testing priority_queue_u64 ... ");
+
+  priority_queue_u64_t *q = malloc(sizeof(priority_queue_u64_t));
+  cutils_error_t err = priority_queue_u64_init(q, 0, 1);
+  assert(err == CUTILS_SUCCESS);
+
+  uint64_t priority = 0;
+  void *payload = NULL;
+  err = priority_queue_u64_pop(q, &priority, &payload);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  size_t n = 10007;
+  for (uintptr_t i = 0; i < n; i++) {
+    uint64_t p = (i * 7919) % n;
+    err = priority_queue_u64_push(q, p, (void *)(p + 1));
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(q->length == n);
+
+  for (uint64_t i = 0; i < n; i++) {
+    err = priority_queue_u64_pop(q, &priority, &payload);
+    assert(err == CUTILS_SUCCESS);
+    assert(priority == i);
+    assert(payload == (void *)(uintptr_t)(i + 1));
+  }
+  assert(q->length == 0);
+
+  err = priority_queue_u64_push(NULL, 0, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  priority_queue_u64_free(q);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_priority_queue_init_and_free();
+  test_priority_queue_push_pop();
+  test_priority_queue_init_from();
+  test_priority_queue_handles();
+  test_priority_queue_u64();
+  return EXIT_SUCCESS;
+}
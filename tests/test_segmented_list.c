@@ -0,0 +1,202 @@
+#include "cutils/errors.h"
+#include "cutils/segmented_list.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NTHREADS 4
+#define PER_THREAD 20000
+
+void test_segmented_list_init_and_free(void) {
+  printf("testing segmented_list_init_and_free ... ");
+
+  segmented_list_t *l = malloc(sizeof(segmented_list_t));
+  cutils_error_t err = segmented_list_init(l, free, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->length == 0);
+
+  for (size_t i = 0; i < 100; i++) {
+    err = segmented_list_push(l, malloc(sizeof(size_t)), NULL);
+    assert(err == CUTILS_SUCCESS);
+  }
+  segmented_list_free(l);
+
+  err = segmented_list_init(NULL, NULL, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_segmented_list_push_and_get(void) {
+  printf("testing segmented_list_push_and_get ... ");
+
+  segmented_list_t *l = malloc(sizeof(segmented_list_t));
+  cutils_error_t err = segmented_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  for (size_t i = 0; i < 5000; i++) {
+    size_t idx = SIZE_MAX;
+    err = segmented_list_push(l, (void *)(uintptr_t)i, &idx);
+    assert(err == CUTILS_SUCCESS);
+    assert(idx == i);
+  }
+  assert(l->length == 5000);
+
+  for (size_t i = 0; i < 5000; i++) {
+    void *value = NULL;
+    err = segmented_list_get(l, i, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)(uintptr_t)i);
+  }
+
+  void *value = NULL;
+  err = segmented_list_get(l, 5000, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  err = segmented_list_set(l, 10, (void *)(uintptr_t)99);
+  assert(err == CUTILS_SUCCESS);
+  segmented_list_get(l, 10, &value);
+  assert(value == (void *)(uintptr_t)99);
+
+  segmented_list_free(l);
+
+  printf("success\n");
+}
+
+void test_segmented_list_stable_ref(void) {
+  printf("testing segmented_list_stable_ref ... ");
+
+  segmented_list_t *l = malloc(sizeof(segmented_list_t));
+  cutils_error_t err = segmented_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  segmented_list_push(l, (void *)(uintptr_t)1, NULL);
+  void **ref = NULL;
+  err = segmented_list_ref(l, 0, &ref);
+  assert(err == CUTILS_SUCCESS);
+
+  for (size_t i = 0; i < 100000; i++) {
+    segmented_list_push(l, (void *)(uintptr_t)i, NULL);
+  }
+
+  void **again = NULL;
+  segmented_list_ref(l, 0, &again);
+  assert(ref == again);
+  assert(*ref == (void *)(uintptr_t)1);
+
+  err = segmented_list_ref(l, 100001, &again);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  segmented_list_free(l);
+
+  printf("success\n");
+}
+
+typedef struct {
+  segmented_list_t *l;
+  size_t id;
+} pusher_t;
+
+void *pusher(void *arg) {
+  pusher_t *p = arg;
+  for (size_t i = 0; i < PER_THREAD; i++) {
+    uintptr_t value = p->id * PER_THREAD + i;
+    cutils_error_t err = segmented_list_push(p->l, (void *)value, NULL);
+    assert(err == CUTILS_SUCCESS);
+  }
+  return NULL;
+}
+
+void test_segmented_list_concurrent_push(void) {
+  printf("testing segmented_list_concurrent_push ... ");
+
+  segmented_list_t *l = malloc(sizeof(segmented_list_t));
+  cutils_error_t err = segmented_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  pthread_t threads[NTHREADS];
+  pusher_t args[NTHREADS];
+  for (size_t i = 0; i < NTHREADS; i++) {
+    args[i] = (pusher_t){l, i};
+    pthread_create(&threads[i], NULL, pusher, &args[i]);
+  }
+  for (size_t i = 0; i < NTHREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  assert(l->length == NTHREADS * PER_THREAD);
+
+  bool *seen = calloc(NTHREADS * PER_THREAD, sizeof(bool));
+  assert(seen != NULL);
+  for (size_t i = 0; i < NTHREADS * PER_THREAD; i++) {
+    void *value = NULL;
+    err = segmented_list_get(l, i, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(!seen[(uintptr_t)value]);
+    seen[(uintptr_t)value] = true;
+  }
+
+  free(seen);
+  segmented_list_free(l);
+
+  printf("success\n");
+}
+
+// Claims position 0 the way a push does, then stalls before publishing it
+// while the pushers run. None of them may wait on it.
+void test_segmented_list_stalled_push(void) {
+  printf("testing segmented_list_stalled_push ... ");
+
+  segmented_list_t *l = malloc(sizeof(segmented_list_t));
+  cutils_error_t err = segmented_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+  atomic_fetch_add(&l->reserved, 1);
+
+  pthread_t threads[NTHREADS];
+  pusher_t args[NTHREADS];
+  for (size_t i = 0; i < NTHREADS; i++) {
+    args[i] = (pusher_t){l, i};
+    pthread_create(&threads[i], NULL, pusher, &args[i]);
+  }
+  for (size_t i = 0; i < NTHREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  assert(l->length == NTHREADS * PER_THREAD);
+
+  // The stalled position reads as missing, everything after it is there
+  void *value = NULL;
+  err = segmented_list_get(l, 0, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+  void **ref = NULL;
+  err = segmented_list_ref(l, 0, &ref);
+  assert(err == CUTILS_INDEX_ERROR);
+  for (size_t i = 1; i <= NTHREADS * PER_THREAD; i++) {
+    err = segmented_list_get(l, i, &value);
+    assert(err == CUTILS_SUCCESS);
+  }
+
+  // Once the stalled push publishes, its value shows up in place
+  segmented_list_slot_t *slot = &l->segments[0][0];
+  slot->value = (void *)(uintptr_t)42;
+  atomic_store(&slot->written, true);
+  err = segmented_list_get(l, 0, &value);
+  assert(err == CUTILS_SUCCESS);
+  assert(value == (void *)(uintptr_t)42);
+
+  segmented_list_free(l);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_segmented_list_init_and_free();
+  test_segmented_list_push_and_get();
+  test_segmented_list_stable_ref();
+  test_segmented_list_concurrent_push();
+  test_segmented_list_stalled_push();
+  return EXIT_SUCCESS;
+}
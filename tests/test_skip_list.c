@@ -0,0 +1,190 @@
+#include "cutils/errors.h"
+#include "cutils/skip_list.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int cmp_key(void *lhs, void *rhs) {
+  uintptr_t l = (uintptr_t)lhs;
+  uintptr_t r = (uintptr_t)rhs;
+  return (l > r) - (l < r);
+}
+
+int cmp_string_key(void *lhs, void *rhs) {
+  return cmp_key((void *)*(uintptr_t *)lhs, (void *)*(uintptr_t *)rhs);
+}
+
+uintptr_t *_new_key(uintptr_t k) {
+  uintptr_t *key = malloc(sizeof(uintptr_t));
+  assert(key != NULL);
+  *key = k;
+  return key;
+}
+
+void test_skip_list_init_and_free(void) {
+  printf("testing skip_list_init_and_free ... ");
+
+  skip_list_t *s = malloc(sizeof(skip_list_t));
+  cutils_error_t err = skip_list_init(s, cmp_string_key, free, free);
+  assert(err == CUTILS_SUCCESS);
+  assert(s->length == 0);
+
+  for (uintptr_t i = 1; i <= 100; i++) {
+    err = skip_list_insert(s, _new_key(i), malloc(8));
+    assert(err == CUTILS_SUCCESS);
+  }
+  // Replacing frees the previous key and value
+  err = skip_list_insert(s, _new_key(50), malloc(8));
+  assert(err == CUTILS_SUCCESS);
+  assert(s->length == 100);
+
+  skip_list_free(s);
+
+  err = skip_list_init(NULL, cmp_key, NULL, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_skip_list_insert_get_remove(void) {
+  printf("testing skip_list_insert_get_remove ... ");
+
+  skip_list_t *s = malloc(sizeof(skip_list_t));
+  cutils_error_t err = skip_list_init(s, cmp_key, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  // Insert a permutation of 1..n
+  size_t n = 10007;
+  for (uintptr_t i = 0; i < n; i++) {
+    uintptr_t k = (i * 7919) % n + 1;
+    err = skip_list_insert(s, (void *)k, (void *)(k * 10));
+    assert(err == CUTILS_SUCCESS);
+  }
+  assert(s->length == n);
+
+  void *value = NULL;
+  for (uintptr_t k = 1; k <= n; k++) {
+    err = skip_list_get(s, (void *)k, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)(k * 10));
+  }
+  err = skip_list_get(s, (void *)(uintptr_t)(n + 1), &value);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  for (uintptr_t k = 1; k <= n; k += 2) {
+    err = skip_list_remove(s, (void *)k, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)(k * 10));
+  }
+  assert(s->length == n / 2);
+
+  err = skip_list_remove(s, (void *)(uintptr_t)1, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = skip_list_get(s, (void *)(uintptr_t)3, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = skip_list_get(s, (void *)(uintptr_t)4, &value);
+  assert(err == CUTILS_SUCCESS);
+
+  skip_list_free(s);
+
+  printf("success\n");
+}
+
+void test_skip_list_floor_and_ceiling(void) {
+  printf("testing skip_list_floor_and_ceiling ... ");
+
+  skip_list_t *s = malloc(sizeof(skip_list_t));
+  cutils_error_t err = skip_list_init(s, cmp_key, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  for (uintptr_t k = 10; k <= 100; k += 10) {
+    skip_list_insert(s, (void *)k, (void *)(k + 1));
+  }
+
+  void *found = NULL;
+  void *value = NULL;
+  err = skip_list_floor(s, (void *)(uintptr_t)55, &found, &value);
+  assert(err == CUTILS_SUCCESS);
+  assert(found == (void *)(uintptr_t)50);
+  assert(value == (void *)(uintptr_t)51);
+
+  err = skip_list_floor(s, (void *)(uintptr_t)60, &found, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(found == (void *)(uintptr_t)60);
+
+  err = skip_list_floor(s, (void *)(uintptr_t)5, &found, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  err = skip_list_ceiling(s, (void *)(uintptr_t)55, &found, &value);
+  assert(err == CUTILS_SUCCESS);
+  assert(found == (void *)(uintptr_t)60);
+
+  err = skip_list_ceiling(s, (void *)(uintptr_t)100, &found, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(found == (void *)(uintptr_t)100);
+
+  err = skip_list_ceiling(s, (void *)(uintptr_t)101, &found, NULL);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  skip_list_free(s);
+
+  printf("success\n");
+}
+
+void test_skip_list_range(void) {
+  printf("testing skip_list_range ... ");
+
+  skip_list_t *s = malloc(sizeof(skip_list_t));
+  cutils_error_t err = skip_list_init(s, cmp_key, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  for (uintptr_t i = 0; i < 1000; i++) {
+    uintptr_t k = (i * 617) % 1000 + 1;
+    skip_list_insert(s, (void *)k, NULL);
+  }
+
+  // Full scan is in order
+  skip_list_iter_t it;
+  err = skip_list_seek(s, NULL, &it);
+  assert(err == CUTILS_SUCCESS);
+  uintptr_t expected = 1;
+  while (skip_list_iter_valid(&it)) {
+    void *key = NULL;
+    skip_list_iter_get(&it, &key, NULL);
+    assert(key == (void *)expected);
+    expected++;
+    skip_list_iter_next(&it);
+  }
+  assert(expected == 1001);
+
+  // Half-open range [250, 300)
+  size_t count = 0;
+  for (skip_list_seek(s, (void *)(uintptr_t)250, &it);
+       skip_list_iter_valid(&it); skip_list_iter_next(&it)) {
+    void *key = NULL;
+    skip_list_iter_get(&it, &key, NULL);
+    if (cmp_key(key, (void *)(uintptr_t)300) >= 0) {
+      break;
+    }
+    assert(key == (void *)(uintptr_t)(250 + count));
+    count++;
+  }
+  assert(count == 50);
+
+  err = skip_list_iter_next(&(skip_list_iter_t){NULL});
+  assert(err == CUTILS_INDEX_ERROR);
+
+  skip_list_free(s);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_skip_list_init_and_free();
+  test_skip_list_insert_get_remove();
+  test_skip_list_floor_and_ceiling();
+  test_skip_list_range();
+  return EXIT_SUCCESS;
+}
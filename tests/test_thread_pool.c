@@ -0,0 +1,65 @@
+#include "cutils/errors.h"
+#include "cutils/thread_pool.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void increment(void *ptr) {
+  atomic_size_t *counter = ptr;
+  atomic_fetch_add(counter, 1);
+}
+
+void test_thread_pool_init_and_free(void) {
+  printf("testing thread_pool_init_and_free ... ");
+
+  thread_pool_t *p = malloc(sizeof(thread_pool_t));
+  cutils_error_t err = thread_pool_init(p, 4);
+  assert(err == CUTILS_SUCCESS);
+  assert(p->nthreads == 4);
+  thread_pool_free(p);
+
+  p = malloc(sizeof(thread_pool_t));
+  err = thread_pool_init(p, 0);
+  assert(err == CUTILS_SUCCESS);
+  assert(p->nthreads >= 1);
+  thread_pool_free(p);
+
+  err = thread_pool_init(NULL, 1);
+  assert(err == CUTILS_NULL_ERROR);
+
+  printf("success\n");
+}
+
+void test_thread_pool_submit_and_wait(void) {
+  printf("testing thread_pool_submit_and_wait ... ");
+
+  thread_pool_t *p = malloc(sizeof(thread_pool_t));
+  cutils_error_t err = thread_pool_init(p, 4);
+  assert(err == CUTILS_SUCCESS);
+
+  atomic_size_t counter = 0;
+  for (size_t round = 1; round <= 3; round++) {
+    for (size_t i = 0; i < 1000; i++) {
+      err = thread_pool_submit(p, increment, &counter);
+      assert(err == CUTILS_SUCCESS);
+    }
+    err = thread_pool_wait(p);
+    assert(err == CUTILS_SUCCESS);
+    assert(atomic_load(&counter) == round * 1000);
+  }
+
+  err = thread_pool_submit(p, NULL, &counter);
+  assert(err == CUTILS_NULL_ERROR);
+
+  thread_pool_free(p);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_thread_pool_init_and_free();
+  test_thread_pool_submit_and_wait();
+  return EXIT_SUCCESS;
+}
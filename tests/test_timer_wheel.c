@@ -0,0 +1,171 @@
+#include "cutils/errors.h"
+#include "cutils/intrusive_list.h"
+#include "cutils/timer_wheel.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+  size_t id;
+  bool fired;
+  timer_wheel_timer_t timer;
+} conn_t;
+
+uint64_t next_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+// Pops every expired timer, checking it fell due within (`from`, `to`].
+size_t drain(intrusive_list_t *expired, uint64_t from, uint64_t to) {
+  size_t count = 0;
+  intrusive_list_link_t *link = NULL;
+  while (intrusive_list_pop_front(expired, &link) == CUTILS_SUCCESS) {
+    timer_wheel_timer_t *t =
+        INTRUSIVE_LIST_ENTRY(link, timer_wheel_timer_t, link);
+    conn_t *c = INTRUSIVE_LIST_ENTRY(t, conn_t, timer);
+    assert(!c->fired);
+    assert(!timer_wheel_timer_armed(t));
+    assert(t->deadline <= to);
+    assert(t->deadline > from || from == 0);
+    c->fired = true;
+    count++;
+  }
+  return count;
+}
+
+void test_timer_wheel_add_and_cancel(void) {
+  printf("testing timer_wheel_add_and_cancel ... ");
+
+  timer_wheel_t *w = malloc(sizeof(timer_wheel_t));
+  cutils_error_t err = timer_wheel_init(w, 1000);
+  assert(err == CUTILS_SUCCESS);
+
+  intrusive_list_t expired;
+  intrusive_list_init(&expired);
+
+  conn_t conns[4];
+  for (size_t i = 0; i < 4; i++) {
+    conns[i] = (conn_t){.id = i};
+    timer_wheel_timer_init(&conns[i].timer);
+    assert(!timer_wheel_timer_armed(&conns[i].timer));
+  }
+
+  timer_wheel_add(w, &conns[0].timer, 1010);
+  timer_wheel_add(w, &conns[1].timer, 1005);
+  timer_wheel_add(w, &conns[2].timer, 5000);
+  // A deadline in the past fires on the next tick
+  timer_wheel_add(w, &conns[3].timer, 10);
+  assert(w->length == 4);
+  assert(timer_wheel_timer_armed(&conns[2].timer));
+
+  err = timer_wheel_cancel(w, &conns[2].timer);
+  assert(err == CUTILS_SUCCESS);
+  assert(!timer_wheel_timer_armed(&conns[2].timer));
+  err = timer_wheel_cancel(w, &conns[2].timer);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  // Re-arming moves the timer
+  err = timer_wheel_add(w, &conns[0].timer, 1002);
+  assert(err == CUTILS_SUCCESS);
+  assert(w->length == 3);
+
+  timer_wheel_advance(w, 1001, &expired);
+  assert(expired.length == 1);
+  assert(expired.root.next == &conns[3].timer.link);
+
+  // Still in the expired batch, so it cannot be added yet
+  err = timer_wheel_add(w, &conns[3].timer, 2000);
+  assert(err == CUTILS_INDEX_ERROR);
+  drain(&expired, 0, 1001);
+
+  // Expiry comes back in deadline order
+  timer_wheel_advance(w, 1010, &expired);
+  assert(expired.length == 2);
+  assert(expired.root.next == &conns[0].timer.link);
+  assert(expired.root.prev == &conns[1].timer.link);
+  drain(&expired, 1001, 1010);
+  assert(w->length == 0);
+
+  err = timer_wheel_advance(w, 2000, NULL);
+  assert(err == CUTILS_NULL_ERROR);
+  err = timer_wheel_init(NULL, 0);
+  assert(err == CUTILS_NULL_ERROR);
+
+  timer_wheel_free(w);
+
+  printf("success\n");
+}
+
+void test_timer_wheel_expiry(void) {
+  printf("testing timer_wheel_expiry ... ");
+
+  timer_wheel_t *w = malloc(sizeof(timer_wheel_t));
+  cutils_error_t err = timer_wheel_init(w, 77);
+  assert(err == CUTILS_SUCCESS);
+
+  intrusive_list_t expired;
+  intrusive_list_init(&expired);
+
+  // Deadlines on every level, plus some beyond the top level's reach
+  size_t n = 20000;
+  conn_t *conns = malloc(sizeof(conn_t) * n);
+  assert(conns != NULL);
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  uint64_t ranges[] = {300, 70000, 20000000, 1ull << 34};
+  for (size_t i = 0; i < n; i++) {
+    conns[i] = (conn_t){.id = i};
+    timer_wheel_timer_init(&conns[i].timer);
+    uint64_t deadline = 78 + next_random(&state) % ranges[i % 4];
+    err = timer_wheel_add(w, &conns[i].timer, deadline);
+    assert(err == CUTILS_SUCCESS);
+  }
+
+  // Cancel every third timer
+  size_t live = n;
+  for (size_t i = 0; i < n; i += 3) {
+    timer_wheel_cancel(w, &conns[i].timer);
+    conns[i].fired = true;
+    live--;
+  }
+  assert(w->length == live);
+
+  // Uneven steps, growing so the far deadlines are reached quickly
+  uint64_t now = 77;
+  size_t fired = 0;
+  uint64_t step = 1;
+  while (w->length > 0) {
+    uint64_t to = now + 1 + next_random(&state) % step;
+    timer_wheel_advance(w, to, &expired);
+    fired += drain(&expired, now, to);
+    now = to;
+    step = step < (1ull << 30) ? step * 2 + 1 : step;
+
+    // Nothing still armed is overdue
+    for (size_t i = 0; i < n; i += 97) {
+      if (timer_wheel_timer_armed(&conns[i].timer)) {
+        assert(conns[i].timer.deadline > now);
+      }
+    }
+  }
+  assert(fired == live);
+  for (size_t i = 0; i < n; i++) {
+    assert(conns[i].fired);
+  }
+
+  free(conns);
+  timer_wheel_free(w);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_timer_wheel_add_and_cancel();
+  test_timer_wheel_expiry();
+  return EXIT_SUCCESS;
+}
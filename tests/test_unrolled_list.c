@@ -0,0 +1,199 @@
+#include "cutils/errors.h"
+#include "cutils/unrolled_list.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+bool cmp(void *lhs, void *rhs) { return lhs == rhs; }
+
+// Checks the list against a reference array and the node invariants.
+bool verify(unrolled_list_t *l, size_t n, const uintptr_t values[n]) {
+  if (l->length != n) {
+    return false;
+  }
+
+  size_t i = 0;
+  size_t nnodes = 0;
+  unrolled_list_node_t *prev = NULL;
+  for (unrolled_list_node_t *curr = l->head; curr; curr = curr->next) {
+    if (curr->prev != prev || curr->count == 0 ||
+        curr->count > UNROLLED_LIST_NODE_CAPACITY) {
+      return false;
+    }
+    for (size_t j = 0; j < curr->count; j++) {
+      if (curr->values[j] != (void *)values[i++]) {
+        return false;
+      }
+    }
+    prev = curr;
+    nnodes++;
+  }
+
+  return i == n && l->tail == prev && l->nnodes == nnodes;
+}
+
+void test_unrolled_list_init_and_free(void) {
+  printf("testing unrolled_list_init_and_free ... ");
+
+  unrolled_list_t *l = malloc(sizeof(unrolled_list_t));
+  cutils_error_t err = unrolled_list_init(l, free, NULL);
+  assert(err == CUTILS_SUCCESS);
+  assert(l->length == 0);
+
+  for (size_t i = 0; i < 1000; i++) {
+    err = unrolled_list_push_back(l, malloc(sizeof(size_t)));
+    assert(err == CUTILS_SUCCESS);
+  }
+  unrolled_list_free(l);
+
+  printf("success\n");
+}
+
+void test_unrolled_list_push_and_pop(void) {
+  printf("testing unrolled_list_push_and_pop ... ");
+
+  size_t n = 10 * UNROLLED_LIST_NODE_CAPACITY;
+  uintptr_t *expected = malloc(sizeof(uintptr_t) * n);
+  unrolled_list_t *l = malloc(sizeof(unrolled_list_t));
+  cutils_error_t err = unrolled_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  for (size_t i = 0; i < n; i++) {
+    err = unrolled_list_push_back(l, (void *)(uintptr_t)i);
+    assert(err == CUTILS_SUCCESS);
+    expected[i] = i;
+  }
+  assert(verify(l, n, expected));
+  assert(l->nnodes == 10);
+
+  void *value = NULL;
+  for (size_t i = 0; i < n / 2; i++) {
+    err = unrolled_list_pop_front(l, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)(uintptr_t)i);
+    err = unrolled_list_pop_back(l, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)(uintptr_t)(n - 1 - i));
+  }
+  assert(l->length == 0);
+  assert(l->head == NULL && l->tail == NULL);
+
+  err = unrolled_list_pop_back(l, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  for (size_t i = 0; i < n; i++) {
+    unrolled_list_push_front(l, (void *)(uintptr_t)i);
+    expected[n - 1 - i] = i;
+  }
+  assert(verify(l, n, expected));
+
+  unrolled_list_free(l);
+  free(expected);
+
+  printf("success\n");
+}
+
+void test_unrolled_list_random_ops(void) {
+  printf("testing unrolled_list_random_ops ... ");
+
+  size_t max = 5000;
+  uintptr_t *expected = malloc(sizeof(uintptr_t) * max);
+  size_t n = 0;
+  unrolled_list_t *l = malloc(sizeof(unrolled_list_t));
+  cutils_error_t err = unrolled_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  uint64_t state = 88172645463325252ull;
+  for (size_t step = 0; step < 40000; step++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    // Bias towards inserts early and removals late
+    bool insert = n == 0 || (n < max && state % 100 < (step < 20000 ? 70 : 30));
+    size_t idx = (state >> 8) % (n + (insert ? 1 : 0));
+    if (insert) {
+      err = unrolled_list_insert_at(l, idx, (void *)(uintptr_t)step);
+      assert(err == CUTILS_SUCCESS);
+      for (size_t i = n; i > idx; i--) {
+        expected[i] = expected[i - 1];
+      }
+      expected[idx] = step;
+      n++;
+    } else {
+      void *value = NULL;
+      err = unrolled_list_remove_at(l, idx, &value);
+      assert(err == CUTILS_SUCCESS);
+      assert(value == (void *)expected[idx]);
+      for (size_t i = idx; i + 1 < n; i++) {
+        expected[i] = expected[i + 1];
+      }
+      n--;
+    }
+
+    if (step % 1000 == 0) {
+      assert(verify(l, n, expected));
+    }
+  }
+  assert(verify(l, n, expected));
+
+  for (size_t i = 0; i < n; i++) {
+    void *value = NULL;
+    err = unrolled_list_get(l, i, &value);
+    assert(err == CUTILS_SUCCESS);
+    assert(value == (void *)expected[i]);
+  }
+
+  unrolled_list_free(l);
+  free(expected);
+
+  printf("success\n");
+}
+
+void test_unrolled_list_get_set_find(void) {
+  printf("testing unrolled_list_get_set_find ... ");
+
+  unrolled_list_t *l = malloc(sizeof(unrolled_list_t));
+  cutils_error_t err = unrolled_list_init(l, NULL, NULL);
+  assert(err == CUTILS_SUCCESS);
+
+  for (uintptr_t i = 0; i < 200; i++) {
+    unrolled_list_push_back(l, (void *)i);
+  }
+
+  err = unrolled_list_set(l, 150, (void *)(uintptr_t)1000);
+  assert(err == CUTILS_SUCCESS);
+  void *value = NULL;
+  err = unrolled_list_get(l, 150, &value);
+  assert(err == CUTILS_SUCCESS);
+  assert(value == (void *)(uintptr_t)1000);
+
+  size_t idx = SIZE_MAX;
+  err = unrolled_list_find(l, (void *)(uintptr_t)1000, cmp, &idx);
+  assert(err == CUTILS_SUCCESS);
+  assert(idx == 150);
+
+  idx = SIZE_MAX;
+  err = unrolled_list_find(l, (void *)(uintptr_t)150, cmp, &idx);
+  assert(err == CUTILS_SUCCESS);
+  assert(idx == SIZE_MAX);
+
+  err = unrolled_list_get(l, 200, &value);
+  assert(err == CUTILS_INDEX_ERROR);
+  err = unrolled_list_set(l, 200, value);
+  assert(err == CUTILS_INDEX_ERROR);
+
+  unrolled_list_free(l);
+
+  printf("success\n");
+}
+
+int main(void) {
+  test_unrolled_list_init_and_free();
+  test_unrolled_list_push_and_pop();
+  test_unrolled_list_random_ops();
+  test_unrolled_list_get_set_find();
+  return EXIT_SUCCESS;
+}